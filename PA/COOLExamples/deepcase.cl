@@ -0,0 +1,129 @@
+-- Gabriel Santiago Delgado Lozano
+-- Fabio Esteban Murcia Martinez
+-- case sobre una jerarquía de 40 niveles (D0 ... D39, con una hoja S<i>
+-- cada tres niveles) declarada en desorden: cada objeto tiene que caer en
+-- la rama de su ancestro más cercano.
+class D31 inherits D30 { };
+class D29 inherits D28 { };
+class D3 inherits D2 { };
+class D19 inherits D18 { };
+class D33 inherits D32 { };
+class D17 inherits D16 { };
+class D28 inherits D27 { };
+class D22 inherits D21 { };
+class D7 inherits D6 { };
+class D10 inherits D9 { };
+class D26 inherits D25 { };
+class D13 inherits D12 { };
+class D6 inherits D5 { };
+class D11 inherits D10 { };
+class D39 inherits D38 { };
+class S39 inherits D39 { };
+class S30 inherits D30 { };
+class D24 inherits D23 { };
+class D32 inherits D31 { };
+class D1 inherits D0 { };
+class D18 inherits D17 { };
+class D5 inherits D4 { };
+class D2 inherits D1 { };
+class D21 inherits D20 { };
+class S6 inherits D6 { };
+class S27 inherits D27 { };
+class S15 inherits D15 { };
+class S18 inherits D18 { };
+class D27 inherits D26 { };
+class S12 inherits D12 { };
+class D20 inherits D19 { };
+class S9 inherits D9 { };
+class D9 inherits D8 { };
+class D25 inherits D24 { };
+class D36 inherits D35 { };
+class S33 inherits D33 { };
+class S3 inherits D3 { };
+class D12 inherits D11 { };
+class D14 inherits D13 { };
+class D35 inherits D34 { };
+class D16 inherits D15 { };
+class S21 inherits D21 { };
+class D0 inherits IO { };
+class S24 inherits D24 { };
+class D4 inherits D3 { };
+class S36 inherits D36 { };
+class S0 inherits D0 { };
+class D30 inherits D29 { };
+class D38 inherits D37 { };
+class D23 inherits D22 { };
+class D8 inherits D7 { };
+class D34 inherits D33 { };
+class D37 inherits D36 { };
+class D15 inherits D14 { };
+class Main inherits IO {
+  pick(x : Object) : String { case x of
+    v0 : D5 => "D5";
+    v1 : D17 => "D17";
+    v2 : D18 => "D18";
+    v3 : D30 => "D30";
+    v4 : S9 => "S9";
+    v5 : S3 => "S3";
+    v6 : IO => "IO";
+    v7 : Int => "Int";
+    v8 : String => "String";
+  esac };
+  main() : Object { {
+    out_string(pick(new D0)); out_string("\n");
+    out_string(pick(new D1)); out_string("\n");
+    out_string(pick(new D10)); out_string("\n");
+    out_string(pick(new D11)); out_string("\n");
+    out_string(pick(new D12)); out_string("\n");
+    out_string(pick(new D13)); out_string("\n");
+    out_string(pick(new D14)); out_string("\n");
+    out_string(pick(new D15)); out_string("\n");
+    out_string(pick(new D16)); out_string("\n");
+    out_string(pick(new D17)); out_string("\n");
+    out_string(pick(new D18)); out_string("\n");
+    out_string(pick(new D19)); out_string("\n");
+    out_string(pick(new D2)); out_string("\n");
+    out_string(pick(new D20)); out_string("\n");
+    out_string(pick(new D21)); out_string("\n");
+    out_string(pick(new D22)); out_string("\n");
+    out_string(pick(new D23)); out_string("\n");
+    out_string(pick(new D24)); out_string("\n");
+    out_string(pick(new D25)); out_string("\n");
+    out_string(pick(new D26)); out_string("\n");
+    out_string(pick(new D27)); out_string("\n");
+    out_string(pick(new D28)); out_string("\n");
+    out_string(pick(new D29)); out_string("\n");
+    out_string(pick(new D3)); out_string("\n");
+    out_string(pick(new D30)); out_string("\n");
+    out_string(pick(new D31)); out_string("\n");
+    out_string(pick(new D32)); out_string("\n");
+    out_string(pick(new D33)); out_string("\n");
+    out_string(pick(new D34)); out_string("\n");
+    out_string(pick(new D35)); out_string("\n");
+    out_string(pick(new D36)); out_string("\n");
+    out_string(pick(new D37)); out_string("\n");
+    out_string(pick(new D38)); out_string("\n");
+    out_string(pick(new D39)); out_string("\n");
+    out_string(pick(new D4)); out_string("\n");
+    out_string(pick(new D5)); out_string("\n");
+    out_string(pick(new D6)); out_string("\n");
+    out_string(pick(new D7)); out_string("\n");
+    out_string(pick(new D8)); out_string("\n");
+    out_string(pick(new D9)); out_string("\n");
+    out_string(pick(new S0)); out_string("\n");
+    out_string(pick(new S12)); out_string("\n");
+    out_string(pick(new S15)); out_string("\n");
+    out_string(pick(new S18)); out_string("\n");
+    out_string(pick(new S21)); out_string("\n");
+    out_string(pick(new S24)); out_string("\n");
+    out_string(pick(new S27)); out_string("\n");
+    out_string(pick(new S3)); out_string("\n");
+    out_string(pick(new S30)); out_string("\n");
+    out_string(pick(new S33)); out_string("\n");
+    out_string(pick(new S36)); out_string("\n");
+    out_string(pick(new S39)); out_string("\n");
+    out_string(pick(new S6)); out_string("\n");
+    out_string(pick(new S9)); out_string("\n");
+    out_string(pick(3)); out_string(pick("s")); out_string(pick(self)); out_string("\n");
+  } };
+};
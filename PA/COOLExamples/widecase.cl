@@ -0,0 +1,313 @@
+-- Gabriel Santiago Delgado Lozano
+-- Fabio Esteban Murcia Martinez
+-- case de 100 ramas sobre un árbol binario de 100 clases (K0 ... K99): cada
+-- objeto cae en la rama de su propia clase.  Se repite 20 veces.
+class K0 inherits Object { };
+class K1 inherits K0 { };
+class K2 inherits K0 { };
+class K3 inherits K1 { };
+class K4 inherits K1 { };
+class K5 inherits K2 { };
+class K6 inherits K2 { };
+class K7 inherits K3 { };
+class K8 inherits K3 { };
+class K9 inherits K4 { };
+class K10 inherits K4 { };
+class K11 inherits K5 { };
+class K12 inherits K5 { };
+class K13 inherits K6 { };
+class K14 inherits K6 { };
+class K15 inherits K7 { };
+class K16 inherits K7 { };
+class K17 inherits K8 { };
+class K18 inherits K8 { };
+class K19 inherits K9 { };
+class K20 inherits K9 { };
+class K21 inherits K10 { };
+class K22 inherits K10 { };
+class K23 inherits K11 { };
+class K24 inherits K11 { };
+class K25 inherits K12 { };
+class K26 inherits K12 { };
+class K27 inherits K13 { };
+class K28 inherits K13 { };
+class K29 inherits K14 { };
+class K30 inherits K14 { };
+class K31 inherits K15 { };
+class K32 inherits K15 { };
+class K33 inherits K16 { };
+class K34 inherits K16 { };
+class K35 inherits K17 { };
+class K36 inherits K17 { };
+class K37 inherits K18 { };
+class K38 inherits K18 { };
+class K39 inherits K19 { };
+class K40 inherits K19 { };
+class K41 inherits K20 { };
+class K42 inherits K20 { };
+class K43 inherits K21 { };
+class K44 inherits K21 { };
+class K45 inherits K22 { };
+class K46 inherits K22 { };
+class K47 inherits K23 { };
+class K48 inherits K23 { };
+class K49 inherits K24 { };
+class K50 inherits K24 { };
+class K51 inherits K25 { };
+class K52 inherits K25 { };
+class K53 inherits K26 { };
+class K54 inherits K26 { };
+class K55 inherits K27 { };
+class K56 inherits K27 { };
+class K57 inherits K28 { };
+class K58 inherits K28 { };
+class K59 inherits K29 { };
+class K60 inherits K29 { };
+class K61 inherits K30 { };
+class K62 inherits K30 { };
+class K63 inherits K31 { };
+class K64 inherits K31 { };
+class K65 inherits K32 { };
+class K66 inherits K32 { };
+class K67 inherits K33 { };
+class K68 inherits K33 { };
+class K69 inherits K34 { };
+class K70 inherits K34 { };
+class K71 inherits K35 { };
+class K72 inherits K35 { };
+class K73 inherits K36 { };
+class K74 inherits K36 { };
+class K75 inherits K37 { };
+class K76 inherits K37 { };
+class K77 inherits K38 { };
+class K78 inherits K38 { };
+class K79 inherits K39 { };
+class K80 inherits K39 { };
+class K81 inherits K40 { };
+class K82 inherits K40 { };
+class K83 inherits K41 { };
+class K84 inherits K41 { };
+class K85 inherits K42 { };
+class K86 inherits K42 { };
+class K87 inherits K43 { };
+class K88 inherits K43 { };
+class K89 inherits K44 { };
+class K90 inherits K44 { };
+class K91 inherits K45 { };
+class K92 inherits K45 { };
+class K93 inherits K46 { };
+class K94 inherits K46 { };
+class K95 inherits K47 { };
+class K96 inherits K47 { };
+class K97 inherits K48 { };
+class K98 inherits K48 { };
+class K99 inherits K49 { };
+class Main inherits IO {
+  objs : Object;
+  pick(x : Object) : Int { case x of
+    v0 : K0 => 0;
+    v1 : K1 => 1;
+    v2 : K2 => 2;
+    v3 : K3 => 3;
+    v4 : K4 => 4;
+    v5 : K5 => 5;
+    v6 : K6 => 6;
+    v7 : K7 => 7;
+    v8 : K8 => 8;
+    v9 : K9 => 9;
+    v10 : K10 => 10;
+    v11 : K11 => 11;
+    v12 : K12 => 12;
+    v13 : K13 => 13;
+    v14 : K14 => 14;
+    v15 : K15 => 15;
+    v16 : K16 => 16;
+    v17 : K17 => 17;
+    v18 : K18 => 18;
+    v19 : K19 => 19;
+    v20 : K20 => 20;
+    v21 : K21 => 21;
+    v22 : K22 => 22;
+    v23 : K23 => 23;
+    v24 : K24 => 24;
+    v25 : K25 => 25;
+    v26 : K26 => 26;
+    v27 : K27 => 27;
+    v28 : K28 => 28;
+    v29 : K29 => 29;
+    v30 : K30 => 30;
+    v31 : K31 => 31;
+    v32 : K32 => 32;
+    v33 : K33 => 33;
+    v34 : K34 => 34;
+    v35 : K35 => 35;
+    v36 : K36 => 36;
+    v37 : K37 => 37;
+    v38 : K38 => 38;
+    v39 : K39 => 39;
+    v40 : K40 => 40;
+    v41 : K41 => 41;
+    v42 : K42 => 42;
+    v43 : K43 => 43;
+    v44 : K44 => 44;
+    v45 : K45 => 45;
+    v46 : K46 => 46;
+    v47 : K47 => 47;
+    v48 : K48 => 48;
+    v49 : K49 => 49;
+    v50 : K50 => 50;
+    v51 : K51 => 51;
+    v52 : K52 => 52;
+    v53 : K53 => 53;
+    v54 : K54 => 54;
+    v55 : K55 => 55;
+    v56 : K56 => 56;
+    v57 : K57 => 57;
+    v58 : K58 => 58;
+    v59 : K59 => 59;
+    v60 : K60 => 60;
+    v61 : K61 => 61;
+    v62 : K62 => 62;
+    v63 : K63 => 63;
+    v64 : K64 => 64;
+    v65 : K65 => 65;
+    v66 : K66 => 66;
+    v67 : K67 => 67;
+    v68 : K68 => 68;
+    v69 : K69 => 69;
+    v70 : K70 => 70;
+    v71 : K71 => 71;
+    v72 : K72 => 72;
+    v73 : K73 => 73;
+    v74 : K74 => 74;
+    v75 : K75 => 75;
+    v76 : K76 => 76;
+    v77 : K77 => 77;
+    v78 : K78 => 78;
+    v79 : K79 => 79;
+    v80 : K80 => 80;
+    v81 : K81 => 81;
+    v82 : K82 => 82;
+    v83 : K83 => 83;
+    v84 : K84 => 84;
+    v85 : K85 => 85;
+    v86 : K86 => 86;
+    v87 : K87 => 87;
+    v88 : K88 => 88;
+    v89 : K89 => 89;
+    v90 : K90 => 90;
+    v91 : K91 => 91;
+    v92 : K92 => 92;
+    v93 : K93 => 93;
+    v94 : K94 => 94;
+    v95 : K95 => 95;
+    v96 : K96 => 96;
+    v97 : K97 => 97;
+    v98 : K98 => 98;
+    v99 : K99 => 99;
+  esac };
+  main() : Object { let s : Int <- 0, i : Int <- 0 in {
+    while i < 20 loop {
+      s <- s + pick(new K0);
+      s <- s + pick(new K1);
+      s <- s + pick(new K2);
+      s <- s + pick(new K3);
+      s <- s + pick(new K4);
+      s <- s + pick(new K5);
+      s <- s + pick(new K6);
+      s <- s + pick(new K7);
+      s <- s + pick(new K8);
+      s <- s + pick(new K9);
+      s <- s + pick(new K10);
+      s <- s + pick(new K11);
+      s <- s + pick(new K12);
+      s <- s + pick(new K13);
+      s <- s + pick(new K14);
+      s <- s + pick(new K15);
+      s <- s + pick(new K16);
+      s <- s + pick(new K17);
+      s <- s + pick(new K18);
+      s <- s + pick(new K19);
+      s <- s + pick(new K20);
+      s <- s + pick(new K21);
+      s <- s + pick(new K22);
+      s <- s + pick(new K23);
+      s <- s + pick(new K24);
+      s <- s + pick(new K25);
+      s <- s + pick(new K26);
+      s <- s + pick(new K27);
+      s <- s + pick(new K28);
+      s <- s + pick(new K29);
+      s <- s + pick(new K30);
+      s <- s + pick(new K31);
+      s <- s + pick(new K32);
+      s <- s + pick(new K33);
+      s <- s + pick(new K34);
+      s <- s + pick(new K35);
+      s <- s + pick(new K36);
+      s <- s + pick(new K37);
+      s <- s + pick(new K38);
+      s <- s + pick(new K39);
+      s <- s + pick(new K40);
+      s <- s + pick(new K41);
+      s <- s + pick(new K42);
+      s <- s + pick(new K43);
+      s <- s + pick(new K44);
+      s <- s + pick(new K45);
+      s <- s + pick(new K46);
+      s <- s + pick(new K47);
+      s <- s + pick(new K48);
+      s <- s + pick(new K49);
+      s <- s + pick(new K50);
+      s <- s + pick(new K51);
+      s <- s + pick(new K52);
+      s <- s + pick(new K53);
+      s <- s + pick(new K54);
+      s <- s + pick(new K55);
+      s <- s + pick(new K56);
+      s <- s + pick(new K57);
+      s <- s + pick(new K58);
+      s <- s + pick(new K59);
+      s <- s + pick(new K60);
+      s <- s + pick(new K61);
+      s <- s + pick(new K62);
+      s <- s + pick(new K63);
+      s <- s + pick(new K64);
+      s <- s + pick(new K65);
+      s <- s + pick(new K66);
+      s <- s + pick(new K67);
+      s <- s + pick(new K68);
+      s <- s + pick(new K69);
+      s <- s + pick(new K70);
+      s <- s + pick(new K71);
+      s <- s + pick(new K72);
+      s <- s + pick(new K73);
+      s <- s + pick(new K74);
+      s <- s + pick(new K75);
+      s <- s + pick(new K76);
+      s <- s + pick(new K77);
+      s <- s + pick(new K78);
+      s <- s + pick(new K79);
+      s <- s + pick(new K80);
+      s <- s + pick(new K81);
+      s <- s + pick(new K82);
+      s <- s + pick(new K83);
+      s <- s + pick(new K84);
+      s <- s + pick(new K85);
+      s <- s + pick(new K86);
+      s <- s + pick(new K87);
+      s <- s + pick(new K88);
+      s <- s + pick(new K89);
+      s <- s + pick(new K90);
+      s <- s + pick(new K91);
+      s <- s + pick(new K92);
+      s <- s + pick(new K93);
+      s <- s + pick(new K94);
+      s <- s + pick(new K95);
+      s <- s + pick(new K96);
+      s <- s + pick(new K97);
+      s <- s + pick(new K98);
+      s <- s + pick(new K99);
+      i <- i + 1; } pool;
+    out_int(s); out_string("\n"); } };
+};
@@ -0,0 +1,585 @@
+/*  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+ *  Formato binario del AST para pasarlo entre fases sin volver a parsear
+ *  el volcado de texto.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ast-binary.h"
+
+extern int node_lineno;
+
+///////////////////////////////////////////////////////////////////
+// Escritura
+///////////////////////////////////////////////////////////////////
+
+int ASTWriter::Intern(Symbol s, int table) {
+    std::pair<int, Symbol> key(table, s);
+    std::map<std::pair<int, Symbol>, int>::iterator it = symbol_index.find(key);
+    if (it != symbol_index.end()) {
+        return it->second;
+    }
+
+    ASTBinarySymbol sym;
+    sym.table = table;
+    sym.offset = strings.size();
+    sym.len = s->get_len();
+    strings.insert(strings.end(), s->get_string(), s->get_string() + sym.len);
+    strings.push_back('\0');   // add_string usa strlen al cargar
+
+    int index = symbols.size();
+    symbols.push_back(sym);
+    symbol_index.insert(std::make_pair(key, index));
+    return index;
+}
+
+int ASTWriter::AddNode(ASTKind kind, tree_node *t) {
+    ASTBinaryNode node;
+    node.kind = kind;
+    node.line = t->get_line_number();
+    node.sym[0] = node.sym[1] = node.sym[2] = -1;
+    node.first_child = children.size();
+    node.num_children = 0;
+    nodes.push_back(node);
+    return nodes.size() - 1;
+}
+
+int ASTWriter::AddNode(ASTKind kind, Expression e) {
+    int node = AddNode(kind, (tree_node *) e);
+    if (e->get_type() != NULL) {
+        SetSymbol(node, 2, e->get_type());
+    }
+    return node;
+}
+
+void ASTWriter::SetSymbol(int node, int slot, Symbol s, int table) {
+    nodes[node].sym[slot] = Intern(s, table);
+}
+
+bool ASTWriter::Write(const char *path, int root) {
+    ASTBinaryHeader header;
+    memcpy(header.magic, AST_BINARY_MAGIC, 7);
+    header.version = AST_BINARY_VERSION;
+    header.num_nodes = nodes.size();
+    header.num_children = children.size();
+    header.num_symbols = symbols.size();
+    header.string_bytes = strings.size();
+    header.root = root;
+
+    FILE *out = fopen(path, "wb");
+    if (out == NULL) {
+        return false;
+    }
+    fwrite(&header, sizeof(header), 1, out);
+    fwrite(nodes.data(), sizeof(ASTBinaryNode), nodes.size(), out);
+    fwrite(children.data(), sizeof(int), children.size(), out);
+    fwrite(symbols.data(), sizeof(ASTBinarySymbol), symbols.size(), out);
+    fwrite(strings.data(), 1, strings.size(), out);
+
+    bool ok = !ferror(out);
+    if (fclose(out) != 0 || !ok) {
+        remove(path);
+        return false;
+    }
+    return true;
+}
+
+// Cada nodo se numera al sacarlo de la pila, así que quedan en preorden y
+// los hijos (que AddChild reservó juntos) de forma contigua.  Los hijos se
+// apilan en orden, por eso se invierten para que salga primero el primero.
+int ASTWriter::Serialize(Program program) {
+    int root = program->Serialize(*this);
+    size_t mark = 0;
+    for (;;) {
+        std::reverse(pending.begin() + mark, pending.end());
+        if (pending.empty()) {
+            break;
+        }
+        Pending p = pending.back();
+        pending.pop_back();
+        mark = pending.size();
+        children[p.slot] = p.serialize(p.node, *this);
+    }
+    return root;
+}
+
+bool ast_binary_write(Program program, const char *path) {
+    ASTWriter writer;
+    int root = writer.Serialize(program);
+    return writer.Write(path, root);
+}
+
+// Cada Serialize() registra su nodo y anuncia sus hijos en el orden del
+// formato; no llama al Serialize() de los hijos (ver ASTWriter::Serialize).
+
+int program_class::Serialize(ASTWriter &w) {
+    int node = w.AddNode(AST_PROGRAM, this);
+    for (int i = classes->first(); classes->more(i); i = classes->next(i)) {
+        w.AddChild(node, classes->nth(i));
+    }
+    return node;
+}
+
+int class__class::Serialize(ASTWriter &w) {
+    int node = w.AddNode(AST_CLASS, this);
+    w.SetSymbol(node, 0, name);
+    w.SetSymbol(node, 1, parent);
+    w.SetSymbol(node, 2, filename, STR_TABLE);
+    for (int i = features->first(); features->more(i); i = features->next(i)) {
+        w.AddChild(node, features->nth(i));
+    }
+    return node;
+}
+
+int method_class::Serialize(ASTWriter &w) {
+    int node = w.AddNode(AST_METHOD, this);
+    w.SetSymbol(node, 0, name);
+    w.SetSymbol(node, 1, return_type);
+    for (int i = formals->first(); formals->more(i); i = formals->next(i)) {
+        w.AddChild(node, formals->nth(i));
+    }
+    w.AddChild(node, expr);
+    return node;
+}
+
+int attr_class::Serialize(ASTWriter &w) {
+    int node = w.AddNode(AST_ATTR, this);
+    w.SetSymbol(node, 0, name);
+    w.SetSymbol(node, 1, type_decl);
+    w.AddChild(node, init);
+    return node;
+}
+
+int formal_class::Serialize(ASTWriter &w) {
+    int node = w.AddNode(AST_FORMAL, this);
+    w.SetSymbol(node, 0, name);
+    w.SetSymbol(node, 1, type_decl);
+    return node;
+}
+
+int branch_class::Serialize(ASTWriter &w) {
+    int node = w.AddNode(AST_BRANCH, this);
+    w.SetSymbol(node, 0, name);
+    w.SetSymbol(node, 1, type_decl);
+    w.AddChild(node, expr);
+    return node;
+}
+
+int assign_class::Serialize(ASTWriter &w) {
+    int node = w.AddNode(AST_ASSIGN, this);
+    w.SetSymbol(node, 0, name);
+    w.AddChild(node, expr);
+    return node;
+}
+
+int static_dispatch_class::Serialize(ASTWriter &w) {
+    int node = w.AddNode(AST_STATIC_DISPATCH, this);
+    w.SetSymbol(node, 0, name);
+    w.SetSymbol(node, 1, type_name);
+    w.AddChild(node, expr);
+    for (int i = actual->first(); actual->more(i); i = actual->next(i)) {
+        w.AddChild(node, actual->nth(i));
+    }
+    return node;
+}
+
+int dispatch_class::Serialize(ASTWriter &w) {
+    int node = w.AddNode(AST_DISPATCH, this);
+    w.SetSymbol(node, 0, name);
+    w.AddChild(node, expr);
+    for (int i = actual->first(); actual->more(i); i = actual->next(i)) {
+        w.AddChild(node, actual->nth(i));
+    }
+    return node;
+}
+
+int cond_class::Serialize(ASTWriter &w) {
+    int node = w.AddNode(AST_COND, this);
+    w.AddChild(node, pred);
+    w.AddChild(node, then_exp);
+    w.AddChild(node, else_exp);
+    return node;
+}
+
+int loop_class::Serialize(ASTWriter &w) {
+    int node = w.AddNode(AST_LOOP, this);
+    w.AddChild(node, pred);
+    w.AddChild(node, body);
+    return node;
+}
+
+int typcase_class::Serialize(ASTWriter &w) {
+    int node = w.AddNode(AST_TYPCASE, this);
+    w.AddChild(node, expr);
+    for (int i = cases->first(); cases->more(i); i = cases->next(i)) {
+        w.AddChild(node, cases->nth(i));
+    }
+    return node;
+}
+
+int block_class::Serialize(ASTWriter &w) {
+    int node = w.AddNode(AST_BLOCK, this);
+    for (int i = body->first(); body->more(i); i = body->next(i)) {
+        w.AddChild(node, body->nth(i));
+    }
+    return node;
+}
+
+int let_class::Serialize(ASTWriter &w) {
+    int node = w.AddNode(AST_LET, this);
+    w.SetSymbol(node, 0, identifier);
+    w.SetSymbol(node, 1, type_decl);
+    w.AddChild(node, init);
+    w.AddChild(node, body);
+    return node;
+}
+
+static int SerializeBinary(ASTWriter &w, ASTKind kind, Expression e, Expression e1, Expression e2) {
+    int node = w.AddNode(kind, e);
+    w.AddChild(node, e1);
+    w.AddChild(node, e2);
+    return node;
+}
+
+static int SerializeUnary(ASTWriter &w, ASTKind kind, Expression e, Expression e1) {
+    int node = w.AddNode(kind, e);
+    w.AddChild(node, e1);
+    return node;
+}
+
+int plus_class::Serialize(ASTWriter &w) { return SerializeBinary(w, AST_PLUS, this, e1, e2); }
+int sub_class::Serialize(ASTWriter &w) { return SerializeBinary(w, AST_SUB, this, e1, e2); }
+int mul_class::Serialize(ASTWriter &w) { return SerializeBinary(w, AST_MUL, this, e1, e2); }
+int divide_class::Serialize(ASTWriter &w) { return SerializeBinary(w, AST_DIVIDE, this, e1, e2); }
+int lt_class::Serialize(ASTWriter &w) { return SerializeBinary(w, AST_LT, this, e1, e2); }
+int eq_class::Serialize(ASTWriter &w) { return SerializeBinary(w, AST_EQ, this, e1, e2); }
+int leq_class::Serialize(ASTWriter &w) { return SerializeBinary(w, AST_LEQ, this, e1, e2); }
+int neg_class::Serialize(ASTWriter &w) { return SerializeUnary(w, AST_NEG, this, e1); }
+int comp_class::Serialize(ASTWriter &w) { return SerializeUnary(w, AST_COMP, this, e1); }
+int isvoid_class::Serialize(ASTWriter &w) { return SerializeUnary(w, AST_ISVOID, this, e1); }
+
+int int_const_class::Serialize(ASTWriter &w) {
+    int node = w.AddNode(AST_INT_CONST, this);
+    w.SetSymbol(node, 0, token, INT_TABLE);
+    return node;
+}
+
+int bool_const_class::Serialize(ASTWriter &w) {
+    int node = w.AddNode(AST_BOOL_CONST, this);
+    w.SetValue(node, 0, val);
+    return node;
+}
+
+int string_const_class::Serialize(ASTWriter &w) {
+    int node = w.AddNode(AST_STRING_CONST, this);
+    w.SetSymbol(node, 0, token, STR_TABLE);
+    return node;
+}
+
+int new__class::Serialize(ASTWriter &w) {
+    int node = w.AddNode(AST_NEW, this);
+    w.SetSymbol(node, 0, type_name);
+    return node;
+}
+
+int no_expr_class::Serialize(ASTWriter &w) {
+    return w.AddNode(AST_NO_EXPR, this);
+}
+
+int object_class::Serialize(ASTWriter &w) {
+    int node = w.AddNode(AST_OBJECT, this);
+    w.SetSymbol(node, 0, name);
+    return node;
+}
+
+///////////////////////////////////////////////////////////////////
+// Lectura
+///////////////////////////////////////////////////////////////////
+
+enum { P_Program, P_Class_, P_Feature, P_Formal, P_Case, P_Expression };
+
+// Fila por ASTKind, generada de COOL_CONSTRUCTORS: fase del nodo, mínimo y
+// máximo de hijos (-1 si no hay máximo) y en qué tabla debe estar cada
+// símbolo (NO_TABLE si no lo usa).
+static const struct {
+    int phylum;
+    int min_children, max_children;
+    int sym_table[2];
+} kind_info[AST_NUM_KINDS] = {
+#define KIND_INFO(kind, phylum, min, max, table0, table1) { P_##phylum, min, max, { table0, table1 } },
+    COOL_CONSTRUCTORS(KIND_INFO)
+#undef KIND_INFO
+};
+
+// Fase que debe tener el hijo i de un nodo de tipo kind con n hijos
+static int ExpectedPhylum(int kind, int i, int n) {
+    switch (kind) {
+    case AST_PROGRAM: return P_Class_;
+    case AST_CLASS:   return P_Feature;
+    case AST_METHOD:  return i == n - 1 ? P_Expression : P_Formal;
+    case AST_TYPCASE: return i == 0 ? P_Expression : P_Case;
+    default:          return P_Expression;
+    }
+}
+
+void ASTView::Close() {
+    if (base != NULL) {
+        munmap(base, length);
+        base = NULL;
+    }
+    interned.clear();
+}
+
+bool ASTView::Open(const char *path) {
+    Close();
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(ASTBinaryHeader)) {
+        ::close(fd);
+        return false;
+    }
+    length = st.st_size;
+    void *p = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        return false;
+    }
+    base = (char *) p;
+
+    header = (const ASTBinaryHeader *) base;
+    if (memcmp(header->magic, AST_BINARY_MAGIC, 7) != 0 || header->version != AST_BINARY_VERSION
+        || header->num_nodes <= 0 || header->num_children < 0
+        || header->num_symbols < 0 || header->string_bytes < 0) {
+        Close();
+        return false;
+    }
+
+    size_t expected = sizeof(ASTBinaryHeader)
+        + (size_t) header->num_nodes * sizeof(ASTBinaryNode)
+        + (size_t) header->num_children * sizeof(int)
+        + (size_t) header->num_symbols * sizeof(ASTBinarySymbol)
+        + (size_t) header->string_bytes;
+    if (expected != length) {
+        Close();
+        return false;
+    }
+
+    nodes = (const ASTBinaryNode *) (base + sizeof(ASTBinaryHeader));
+    children = (const int *) (nodes + header->num_nodes);
+    symbols = (const ASTBinarySymbol *) (children + header->num_children);
+    strings = (const char *) (symbols + header->num_symbols);
+
+    // Se valida todo de una vez para que Build() no tenga que revisar nada
+    for (int s = 0; s < header->num_symbols; s++) {
+        const ASTBinarySymbol &sym = symbols[s];
+        if (sym.table < ID_TABLE || sym.table > STR_TABLE || sym.offset < 0 || sym.len < 0
+            || (long long) sym.offset + sym.len >= header->string_bytes || strings[sym.offset + sym.len] != '\0') {
+            Close();
+            return false;
+        }
+    }
+
+    for (int n = 0; n < header->num_nodes; n++) {
+        const ASTBinaryNode &node = nodes[n];
+        if (node.kind < 0 || node.kind >= AST_NUM_KINDS || node.first_child < 0 || node.num_children < 0
+            || (long long) node.first_child + node.num_children > header->num_children) {
+            Close();
+            return false;
+        }
+
+        bool ok = node.num_children >= kind_info[node.kind].min_children
+            && (kind_info[node.kind].max_children < 0 || node.num_children <= kind_info[node.kind].max_children);
+
+        // Los hijos van después del padre (preorden), así no hay ciclos
+        for (int i = 0; ok && i < node.num_children; i++) {
+            int c = Child(n, i);
+            ok = c > n && c < header->num_nodes
+                && nodes[c].kind >= 0 && nodes[c].kind < AST_NUM_KINDS
+                && kind_info[nodes[c].kind].phylum == ExpectedPhylum(node.kind, i, node.num_children);
+        }
+
+        for (int slot = 0; ok && slot < 2; slot++) {
+            int table = kind_info[node.kind].sym_table[slot];
+            if (table >= 0) {
+                ok = node.sym[slot] >= 0 && node.sym[slot] < header->num_symbols
+                    && symbols[node.sym[slot]].table == table;
+            }
+        }
+        if (ok && node.kind == AST_CLASS) {
+            ok = node.sym[2] >= 0 && node.sym[2] < header->num_symbols
+                && symbols[node.sym[2]].table == STR_TABLE;
+        } else if (ok && kind_info[node.kind].phylum == P_Expression) {
+            ok = node.sym[2] >= -1 && node.sym[2] < header->num_symbols;
+        }
+
+        if (!ok) {
+            Close();
+            return false;
+        }
+    }
+
+    if (header->root != 0 || nodes[0].kind != AST_PROGRAM) {
+        Close();
+        return false;
+    }
+
+    interned.assign(header->num_symbols, (Symbol) NULL);
+    return true;
+}
+
+Symbol ASTView::GetSymbol(int s) {
+    if (s < 0) {
+        return NULL;
+    }
+    if (interned[s] == NULL) {
+        int len;
+        char *text = (char *) SymbolText(s, &len);
+        switch (symbols[s].table) {
+        case INT_TABLE: interned[s] = inttable.add_string(text, len); break;
+        case STR_TABLE: interned[s] = stringtable.add_string(text, len); break;
+        default:        interned[s] = idtable.add_string(text, len); break;
+        }
+    }
+    return interned[s];
+}
+
+// Los constructores toman la línea de node_lineno, así que se fija justo
+// antes de crear cada nodo (después de sus hijos).
+
+Program ASTView::Build() {
+    return (Program) BuildTree(Root());
+}
+
+Classes ASTView::BuildClasses() {
+    const ASTBinaryNode &node = nodes[Root()];
+    Classes classes = nil_Classes();
+    for (int i = 0; i < node.num_children; i++) {
+        classes = append_Classes(classes, single_Classes((Class_) BuildTree(Child(Root(), i))));
+    }
+    return classes;
+}
+
+// Arma el subárbol de n en postorden con una pila explícita: cada nodo se
+// crea cuando ya están armados todos sus hijos, que quedan al final de
+// `built` en orden.
+tree_node *ASTView::BuildTree(int n) {
+    std::vector<tree_node *> built;
+    std::vector<std::pair<int, int> > open;   // nodo y siguiente hijo
+    open.push_back(std::make_pair(n, 0));
+
+    while (!open.empty()) {
+        int node = open.back().first;
+        int i = open.back().second++;
+        if (i < nodes[node].num_children) {
+            open.push_back(std::make_pair(Child(node, i), 0));
+            continue;
+        }
+        open.pop_back();
+        size_t first = built.size() - nodes[node].num_children;
+        tree_node *t = BuildNode(node, built.data() + first);
+        built.resize(first);
+        built.push_back(t);
+    }
+    return built[0];
+}
+
+// Las listas se arman con los hijos desde `from` hasta `to`
+static Classes ClassList(tree_node **kids, int from, int to) {
+    Classes list = nil_Classes();
+    for (int i = from; i < to; i++) {
+        list = append_Classes(list, single_Classes((Class_) kids[i]));
+    }
+    return list;
+}
+
+static Features FeatureList(tree_node **kids, int from, int to) {
+    Features list = nil_Features();
+    for (int i = from; i < to; i++) {
+        list = append_Features(list, single_Features((Feature) kids[i]));
+    }
+    return list;
+}
+
+static Formals FormalList(tree_node **kids, int from, int to) {
+    Formals list = nil_Formals();
+    for (int i = from; i < to; i++) {
+        list = append_Formals(list, single_Formals((Formal) kids[i]));
+    }
+    return list;
+}
+
+static Expressions ExpressionList(tree_node **kids, int from, int to) {
+    Expressions list = nil_Expressions();
+    for (int i = from; i < to; i++) {
+        list = append_Expressions(list, single_Expressions((Expression) kids[i]));
+    }
+    return list;
+}
+
+static Cases CaseList(tree_node **kids, int from, int to) {
+    Cases list = nil_Cases();
+    for (int i = from; i < to; i++) {
+        list = append_Cases(list, single_Cases((Case) kids[i]));
+    }
+    return list;
+}
+
+// Crea el nodo n con sus hijos ya armados
+tree_node *ASTView::BuildNode(int n, tree_node **kids) {
+    const ASTBinaryNode &node = nodes[n];
+    int count = node.num_children;
+    // En bool_const sym[0] es el valor, no un símbolo
+    Symbol s0 = kind_info[node.kind].sym_table[0] != NO_TABLE ? GetSymbol(node.sym[0]) : NULL;
+    Symbol s1 = kind_info[node.kind].sym_table[1] != NO_TABLE ? GetSymbol(node.sym[1]) : NULL;
+    Expression e1 = count > 0 ? (Expression) kids[0] : NULL;
+    Expression e2 = count > 1 ? (Expression) kids[1] : NULL;
+    Expression e3 = count > 2 ? (Expression) kids[2] : NULL;
+
+    node_lineno = node.line;
+    Expression e = NULL;
+    switch (node.kind) {
+    case AST_PROGRAM:         return program(ClassList(kids, 0, count));
+    case AST_CLASS:           return class_(s0, s1, FeatureList(kids, 0, count), GetSymbol(node.sym[2]));
+    case AST_METHOD:          return method(s0, FormalList(kids, 0, count - 1), s1, (Expression) kids[count - 1]);
+    case AST_ATTR:            return attr(s0, s1, e1);
+    case AST_FORMAL:          return formal(s0, s1);
+    case AST_BRANCH:          return branch(s0, s1, e1);
+    case AST_ASSIGN:          e = assign(s0, e1); break;
+    case AST_STATIC_DISPATCH: e = static_dispatch(e1, s1, s0, ExpressionList(kids, 1, count)); break;
+    case AST_DISPATCH:        e = dispatch(e1, s0, ExpressionList(kids, 1, count)); break;
+    case AST_COND:            e = cond(e1, e2, e3); break;
+    case AST_LOOP:            e = loop(e1, e2); break;
+    case AST_TYPCASE:         e = typcase(e1, CaseList(kids, 1, count)); break;
+    case AST_BLOCK:           e = block(ExpressionList(kids, 0, count)); break;
+    case AST_LET:             e = let(s0, s1, e1, e2); break;
+    case AST_PLUS:            e = plus(e1, e2); break;
+    case AST_SUB:             e = sub(e1, e2); break;
+    case AST_MUL:             e = mul(e1, e2); break;
+    case AST_DIVIDE:          e = divide(e1, e2); break;
+    case AST_NEG:             e = neg(e1); break;
+    case AST_LT:              e = lt(e1, e2); break;
+    case AST_EQ:              e = eq(e1, e2); break;
+    case AST_LEQ:             e = leq(e1, e2); break;
+    case AST_COMP:            e = comp(e1); break;
+    case AST_INT_CONST:       e = int_const(s0); break;
+    case AST_BOOL_CONST:      e = bool_const(node.sym[0] != 0); break;
+    case AST_STRING_CONST:    e = string_const(s0); break;
+    case AST_NEW:             e = new_(s0); break;
+    case AST_ISVOID:          e = isvoid(e1); break;
+    case AST_NO_EXPR:         e = no_expr(); break;
+    case AST_OBJECT:          e = object(s0); break;
+    }
+
+    if (node.sym[2] >= 0) {
+        e->set_type(GetSymbol(node.sym[2]));
+    }
+    return e;
+}
@@ -0,0 +1,174 @@
+/*  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+ *  Formato binario del AST para pasarlo entre fases sin volver a parsear
+ *  el volcado de texto.
+ *
+ *  Código compartido (PA/common): lo escriben el parser (lab02C++) y el
+ *  analizador semántico (lab03C++), y lo leen el parseo en paralelo y
+ *  semant (semant-main.cc).  Se compila con -I../common y el cool-tree.h
+ *  de lab03C++, que declara Serialize en cada nodo.
+ */
+#ifndef AST_BINARY_H
+#define AST_BINARY_H
+
+#include <stddef.h>
+#include <map>
+#include <vector>
+#include "cool-tree.h"
+
+/*
+ *  Formato del archivo (enteros de 32 bits en el orden de la máquina):
+ *
+ *    ASTBinaryHeader                   magic, versión, tamaños y raíz
+ *    ASTBinaryNode   [num_nodes]       nodos en preorden
+ *    int             [num_children]    hijos de cada nodo, contiguos
+ *    ASTBinarySymbol [num_symbols]     tabla de símbolos internados
+ *    char            [string_bytes]    texto de los símbolos
+ *
+ *  No hay punteros: los hijos y los símbolos son índices, así que el
+ *  archivo se mapea con mmap y se valida sin convertirlo (ver ASTView).
+ *  Cada símbolo se guarda una sola vez sin importar cuántos nodos lo usen.
+ *
+ *  Las listas no son nodos: sus elementos van directamente entre los hijos
+ *  del nodo que las contiene, después de los hijos fijos, salvo en method
+ *  donde el cuerpo va al final:
+ *
+ *    program          [clases...]
+ *    class_           [features...]          sym = name, parent, filename
+ *    method           [formals..., cuerpo]   sym = name, return_type
+ *    attr             [init]                 sym = name, type_decl
+ *    formal           []                     sym = name, type_decl
+ *    branch           [expr]                 sym = name, type_decl
+ *    static_dispatch  [expr, actuals...]     sym = name, type_name
+ *    dispatch         [expr, actuals...]     sym = name
+ *    typcase          [expr, ramas...]
+ *    block            [exprs...]
+ *    let              [init, body]           sym = identifier, type_decl
+ *
+ *  Las demás expresiones guardan sus subexpresiones en el orden de
+ *  cool-tree.h.  En las expresiones sym[2] es el tipo calculado por semant
+ *  (-1 si aún no se ha chequeado) y en bool_const sym[0] es el valor.
+ */
+#define AST_BINARY_MAGIC   "COOLAST"
+#define AST_BINARY_VERSION 1
+
+/* Variables de entorno con la ruta en la que el parser y semant escriben
+ * el AST binario (sin tipos y con tipos, respectivamente), y la ruta del
+ * que lee semant en lugar del volcado de texto (ver semant-main.cc). */
+#define AST_BINARY_ENV       "COOL_AST_OUT"
+#define AST_BINARY_TYPED_ENV "COOL_TYPED_AST_OUT"
+#define AST_BINARY_IN_ENV    "COOL_AST_IN"
+
+struct ASTBinaryHeader {
+    char magic[7];
+    unsigned char version;
+    int num_nodes;
+    int num_children;
+    int num_symbols;
+    int string_bytes;
+    int root;
+};
+
+struct ASTBinaryNode {
+    int kind;           /* ASTKind (COOL_CONSTRUCTORS en cool-tree.h) */
+    int line;
+    int sym[3];         /* índices en la tabla de símbolos, o -1 */
+    int first_child;    /* posición en el arreglo de hijos */
+    int num_children;
+};
+
+struct ASTBinarySymbol {
+    int table;          /* ID_TABLE, INT_TABLE o STR_TABLE */
+    int offset;         /* posición del texto en la sección de cadenas */
+    int len;
+};
+
+enum { NO_TABLE = -1, ID_TABLE, INT_TABLE, STR_TABLE };
+
+/* Arma el archivo recorriendo el AST con Serialize().  Cada Serialize()
+ * registra sólo su propio nodo y anuncia sus hijos con AddChild(); el
+ * recorrido lo lleva Serialize(program) con una pila explícita, así que
+ * sirve para árboles de cualquier profundidad. */
+class ASTWriter {
+public:
+    int AddNode(ASTKind kind, tree_node *t);
+    int AddNode(ASTKind kind, Expression e);   /* guarda también el tipo */
+    void SetSymbol(int node, int slot, Symbol s, int table = ID_TABLE);
+    void SetValue(int node, int slot, int value) { nodes[node].sym[slot] = value; }
+
+    /* Agrega child como siguiente hijo de node, el último nodo agregado.
+     * Se numera después, al sacarlo de la pila. */
+    template <class T> void AddChild(int node, T child) {
+        Pending p = { (int) children.size(), child, &SerializeAs<T> };
+        children.push_back(-1);
+        nodes[node].num_children++;
+        pending.push_back(p);
+    }
+
+    int Serialize(Program program);   /* devuelve la raíz */
+    bool Write(const char *path, int root);
+
+private:
+    struct Pending {
+        int slot;                                   /* lugar en children */
+        tree_node *node;
+        int (*serialize)(tree_node *, ASTWriter &);
+    };
+    template <class T> static int SerializeAs(tree_node *t, ASTWriter &w) {
+        return ((T) t)->Serialize(w);
+    }
+
+    std::vector<ASTBinaryNode> nodes;
+    std::vector<int> children;
+    std::vector<ASTBinarySymbol> symbols;
+    std::vector<char> strings;
+    std::map<std::pair<int, Symbol>, int> symbol_index;
+    std::vector<Pending> pending;
+
+    int Intern(Symbol s, int table);
+};
+
+/* Escribe el AST de program en path.  Devuelve false si no se pudo. */
+bool ast_binary_write(Program program, const char *path);
+
+/* Vista de sólo lectura sobre un archivo mapeado en memoria.  Node(),
+ * Child() y SymbolText() leen el archivo directamente, pero las fases
+ * trabajan sobre el AST de punteros: Build() copia el árbol completo, con
+ * una pila explícita, e interna cada símbolo una sola vez. */
+class ASTView {
+public:
+    ASTView() : base(NULL), length(0) { }
+    ~ASTView() { Close(); }
+
+    /* Mapea path y valida toda su estructura.  Devuelve false si el
+     * archivo no existe o no es un AST binario válido. */
+    bool Open(const char *path);
+    void Close();
+
+    int Root() { return header->root; }
+    int Size() { return header->num_nodes; }
+    const ASTBinaryNode &Node(int n) { return nodes[n]; }
+    int Child(int n, int i) { return children[nodes[n].first_child + i]; }
+    const char *SymbolText(int s, int *len) {
+        *len = symbols[s].len;
+        return strings + symbols[s].offset;
+    }
+
+    Program Build();
+    Classes BuildClasses();   /* sólo la lista de clases de la raíz */
+
+private:
+    char *base;
+    size_t length;
+    const ASTBinaryHeader *header;
+    const ASTBinaryNode *nodes;
+    const int *children;
+    const ASTBinarySymbol *symbols;
+    const char *strings;
+    std::vector<Symbol> interned;
+
+    Symbol GetSymbol(int s);
+    tree_node *BuildTree(int n);
+    tree_node *BuildNode(int n, tree_node **kids);
+};
+
+#endif
@@ -0,0 +1,252 @@
+/*  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+ *  Recorrido de las expresiones del AST con una pila explícita, y el
+ *  volcado del AST que lo usa.
+ */
+#include <vector>
+#include "ast-visitor.h"
+#include "utilities.h"
+
+///////////////////////////////////////////////////////////////////
+// Recorrido
+///////////////////////////////////////////////////////////////////
+
+struct WalkFrame {
+    Expression e;
+    int next;       // siguiente hijo a visitar
+    int count;      // NumChildren() de e
+};
+
+int ast_walk(Expression root, ASTVisitor &v) {
+    std::vector<WalkFrame> stack;
+    int max_depth = 1;
+
+    v.Pre(root);
+    WalkFrame top = { root, 0, root->NumChildren() };
+    stack.push_back(top);
+
+    while (!stack.empty()) {
+        WalkFrame &f = stack.back();
+        if (f.next < f.count) {
+            int i = f.next++;
+            Expression parent = f.e;
+            Expression child = parent->Child(i);
+            v.BeforeChild(parent, i);
+            v.Pre(child);
+            // f deja de ser válido: el vector puede crecer
+            WalkFrame frame = { child, 0, child->NumChildren() };
+            stack.push_back(frame);
+            if ((int) stack.size() > max_depth)
+                max_depth = stack.size();
+        } else {
+            v.Post(f.e);
+            stack.pop_back();
+            if (!stack.empty())
+                v.AfterChild(stack.back().e, stack.back().next - 1);
+        }
+    }
+    return max_depth;
+}
+
+///////////////////////////////////////////////////////////////////
+// Volcado
+///////////////////////////////////////////////////////////////////
+// Mismo formato que dump_with_types: cada nodo empieza con su línea y su
+// nombre, los campos y los hijos van con dos espacios más de sangría y las
+// expresiones terminan con su tipo.  Cada clase escribe su parte en
+// DumpEnter/DumpChild/DumpExit y ASTDumper sólo lleva la sangría de cada
+// nivel.
+
+static void dump_header(ostream &stream, int n, tree_node *t, const char *name) {
+    stream << pad(n) << "#" << t->get_line_number() << "\n";
+    stream << pad(n) << name << "\n";
+}
+
+static void dump_string(ostream &stream, int n, Symbol s) {
+    stream << pad(n) << "\"";
+    print_escaped_string(stream, s->get_string());
+    stream << "\"\n";
+}
+
+class ASTDumper : public ASTVisitor {
+public:
+    ASTDumper(ostream &s, int n) : stream(s), next_pad(n) { }
+
+    void Pre(Expression e) {
+        e->DumpEnter(stream, next_pad);
+        pads.push_back(next_pad);
+    }
+    void BeforeChild(Expression e, int i) {
+        next_pad = e->DumpChild(stream, pads.back(), i);
+    }
+    void Post(Expression e) {
+        e->DumpExit(stream, pads.back());
+        pads.pop_back();
+    }
+
+private:
+    ostream &stream;
+    int next_pad;
+    std::vector<int> pads;
+};
+
+void ast_dump_with_types(ostream &stream, int n, Expression e) {
+    ASTDumper dumper(stream, n);
+    ast_walk(e, dumper);
+}
+
+void ast_dump_with_types(ostream &stream, int n, Program program) {
+    dump_header(stream, n, program, "_program");
+    Classes classes = ((program_class *) program)->GetClasses();
+    for (int i = classes->first(); classes->more(i); i = classes->next(i)) {
+        Class_ c = classes->nth(i);
+        int m = n + 2;
+        dump_header(stream, m, c, "_class");
+        dump_Symbol(stream, m + 2, c->GetName());
+        dump_Symbol(stream, m + 2, c->GetParent());
+        dump_string(stream, m + 2, c->get_filename());
+        stream << pad(m + 2) << "(\n";
+
+        Features features = c->GetFeatures();
+        for (int j = features->first(); features->more(j); j = features->next(j)) {
+            Feature f = features->nth(j);
+            if (f->IsMethod()) {
+                method_class *method = (method_class *) f;
+                dump_header(stream, m + 2, f, "_method");
+                dump_Symbol(stream, m + 4, method->GetName());
+                Formals formals = method->GetFormals();
+                for (int k = formals->first(); formals->more(k); k = formals->next(k)) {
+                    Formal formal = formals->nth(k);
+                    dump_header(stream, m + 4, formal, "_formal");
+                    dump_Symbol(stream, m + 6, formal->GetName());
+                    dump_Symbol(stream, m + 6, formal->GetType());
+                }
+                dump_Symbol(stream, m + 4, method->GetType());
+                ast_dump_with_types(stream, m + 4, method->GetExpr());
+            } else {
+                attr_class *attr = (attr_class *) f;
+                dump_header(stream, m + 2, f, "_attr");
+                dump_Symbol(stream, m + 4, attr->GetName());
+                dump_Symbol(stream, m + 4, attr->GetTypeDecl());
+                ast_dump_with_types(stream, m + 4, attr->GetInit());
+            }
+        }
+        stream << pad(m + 2) << ")\n";
+    }
+}
+
+void Expression_class::DumpExit(ostream &stream, int n) {
+    dump_type(stream, n);
+}
+
+void assign_class::DumpEnter(ostream &stream, int n) {
+    dump_header(stream, n, this, "_assign");
+    dump_Symbol(stream, n + 2, name);
+}
+
+// Los argumentos van entre paréntesis después del nombre del método
+void static_dispatch_class::DumpEnter(ostream &stream, int n) {
+    dump_header(stream, n, this, "_static_dispatch");
+}
+
+int static_dispatch_class::DumpChild(ostream &stream, int n, int i) {
+    if (i == 1) {
+        dump_Symbol(stream, n + 2, type_name);
+        dump_Symbol(stream, n + 2, name);
+        stream << pad(n + 2) << "(\n";
+    }
+    return n + 2;
+}
+
+void static_dispatch_class::DumpExit(ostream &stream, int n) {
+    if (actual->len() == 0) {
+        dump_Symbol(stream, n + 2, type_name);
+        dump_Symbol(stream, n + 2, name);
+        stream << pad(n + 2) << "(\n";
+    }
+    stream << pad(n + 2) << ")\n";
+    dump_type(stream, n);
+}
+
+void dispatch_class::DumpEnter(ostream &stream, int n) {
+    dump_header(stream, n, this, "_dispatch");
+}
+
+int dispatch_class::DumpChild(ostream &stream, int n, int i) {
+    if (i == 1) {
+        dump_Symbol(stream, n + 2, name);
+        stream << pad(n + 2) << "(\n";
+    }
+    return n + 2;
+}
+
+void dispatch_class::DumpExit(ostream &stream, int n) {
+    if (actual->len() == 0) {
+        dump_Symbol(stream, n + 2, name);
+        stream << pad(n + 2) << "(\n";
+    }
+    stream << pad(n + 2) << ")\n";
+    dump_type(stream, n);
+}
+
+void cond_class::DumpEnter(ostream &stream, int n) { dump_header(stream, n, this, "_cond"); }
+void loop_class::DumpEnter(ostream &stream, int n) { dump_header(stream, n, this, "_loop"); }
+void block_class::DumpEnter(ostream &stream, int n) { dump_header(stream, n, this, "_block"); }
+
+// Cada rama es un nodo _branch con su cuerpo dos espacios más adentro
+void typcase_class::DumpEnter(ostream &stream, int n) {
+    dump_header(stream, n, this, "_typcase");
+}
+
+int typcase_class::DumpChild(ostream &stream, int n, int i) {
+    if (i == 0) {
+        return n + 2;
+    }
+    branch_class *b = (branch_class *) cases->nth(i - 1);
+    dump_header(stream, n + 2, b, "_branch");
+    dump_Symbol(stream, n + 4, b->GetName());
+    dump_Symbol(stream, n + 4, b->GetTypeDecl());
+    return n + 4;
+}
+
+void let_class::DumpEnter(ostream &stream, int n) {
+    dump_header(stream, n, this, "_let");
+    dump_Symbol(stream, n + 2, identifier);
+    dump_Symbol(stream, n + 2, type_decl);
+}
+
+void plus_class::DumpEnter(ostream &stream, int n) { dump_header(stream, n, this, "_plus"); }
+void sub_class::DumpEnter(ostream &stream, int n) { dump_header(stream, n, this, "_sub"); }
+void mul_class::DumpEnter(ostream &stream, int n) { dump_header(stream, n, this, "_mul"); }
+void divide_class::DumpEnter(ostream &stream, int n) { dump_header(stream, n, this, "_divide"); }
+void neg_class::DumpEnter(ostream &stream, int n) { dump_header(stream, n, this, "_neg"); }
+void lt_class::DumpEnter(ostream &stream, int n) { dump_header(stream, n, this, "_lt"); }
+void eq_class::DumpEnter(ostream &stream, int n) { dump_header(stream, n, this, "_eq"); }
+void leq_class::DumpEnter(ostream &stream, int n) { dump_header(stream, n, this, "_leq"); }
+void comp_class::DumpEnter(ostream &stream, int n) { dump_header(stream, n, this, "_comp"); }
+void isvoid_class::DumpEnter(ostream &stream, int n) { dump_header(stream, n, this, "_isvoid"); }
+void no_expr_class::DumpEnter(ostream &stream, int n) { dump_header(stream, n, this, "_no_expr"); }
+
+void int_const_class::DumpEnter(ostream &stream, int n) {
+    dump_header(stream, n, this, "_int");
+    dump_Symbol(stream, n + 2, token);
+}
+
+void bool_const_class::DumpEnter(ostream &stream, int n) {
+    dump_header(stream, n, this, "_bool");
+    dump_Boolean(stream, n + 2, val);
+}
+
+void string_const_class::DumpEnter(ostream &stream, int n) {
+    dump_header(stream, n, this, "_string");
+    dump_string(stream, n + 2, token);
+}
+
+void new__class::DumpEnter(ostream &stream, int n) {
+    dump_header(stream, n, this, "_new");
+    dump_Symbol(stream, n + 2, type_name);
+}
+
+void object_class::DumpEnter(ostream &stream, int n) {
+    dump_header(stream, n, this, "_object");
+    dump_Symbol(stream, n + 2, name);
+}
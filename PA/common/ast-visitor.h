@@ -0,0 +1,47 @@
+/*  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+ *  Recorrido de las expresiones del AST con una pila explícita.
+ *
+ *  Código compartido (PA/common): lo usan semant (lab03C++) para el chequeo
+ *  de tipos y el volcado del AST con tipos, y el parser (lab02C++,
+ *  parser-main.cc) para el volcado del AST.  Cada laboratorio lo compila
+ *  con -I../common y enlaza common/ast-visitor.cc.
+ */
+#ifndef AST_VISITOR_H
+#define AST_VISITOR_H
+
+#include "cool-tree.h"
+
+/*
+ *  El código generado por máquina puede tener cadenas de '+' o de let con
+ *  cientos de miles de niveles, y un recorrido recursivo (una llamada de
+ *  C++ por nivel) se queda sin pila.  ast_walk recorre una expresión en
+ *  profundidad con su propia pila en el heap y avisa al visitante en cada
+ *  paso:
+ *
+ *    Pre(e)                 al llegar a e, antes de sus hijos
+ *    BeforeChild(e, i)      antes de entrar al hijo i de e
+ *    AfterChild(e, i)       al terminar el hijo i de e
+ *    Post(e)                después de todos los hijos de e
+ *
+ *  Los hijos son los de NumChildren()/Child() en cool-tree.h.  El visitante
+ *  que necesite estado por nodo (p. ej. los tipos de los hijos) lo guarda
+ *  en su propia pila: Pre y Post siempre llegan anidados.
+ */
+class ASTVisitor {
+public:
+    virtual ~ASTVisitor() { }
+    virtual void Pre(Expression e) { }
+    virtual void BeforeChild(Expression e, int i) { }
+    virtual void AfterChild(Expression e, int i) { }
+    virtual void Post(Expression e) { }
+};
+
+/* Recorre root y devuelve la profundidad máxima a la que llegó. */
+int ast_walk(Expression root, ASTVisitor &v);
+
+/* Igual que dump_with_types(stream, n), pero sin recursión en las
+ * expresiones, así que sirve para árboles de cualquier profundidad. */
+void ast_dump_with_types(ostream &stream, int n, Program program);
+void ast_dump_with_types(ostream &stream, int n, Expression e);
+
+#endif
@@ -0,0 +1,56 @@
+/*  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+ *  Índice de saltos de línea del archivo que se está escaneando.
+ */
+#include <string.h>
+#include <algorithm>
+#include "line-index.h"
+
+LineIndex cool_line_index;
+int curr_offset = -1;
+
+void LineIndex::add_chunk(const char *buf, int len)
+{
+    /* memchr ya está vectorizado en la libc, así que es una sola pasada */
+    const char *p = buf, *end = buf + len;
+    while ((p = (const char *) memchr(p, '\n', end - p)) != NULL) {
+        newlines.push_back(input_offset + (p - buf));
+        p++;
+    }
+    input_offset += len;
+}
+
+void LineIndex::reset()
+{
+    newlines.clear();
+    input_offset = 0;
+    cursor = 0;
+    base_line = 0;
+    bounded = false;
+}
+
+int LineIndex::lineno(int offset)
+{
+    /* número de '\n' antes de offset, más uno */
+    return base_line + (std::lower_bound(newlines.begin(), newlines.end(), offset) - newlines.begin()) + 1;
+}
+
+int LineIndex::column(int offset)
+{
+    int k = lineno(offset) - base_line - 1;
+    int line_start = k > 0 ? newlines[k - 1] + 1 : 0;
+    return offset - line_start + 1;
+}
+
+int LineIndex::advance_to(int offset)
+{
+    while (cursor < newlines.size() && newlines[cursor] < offset)
+        cursor++;
+
+    /* Se conserva el último '\n' pasado para poder calcular columnas */
+    if (bounded && cursor > 4096) {
+        newlines.erase(newlines.begin(), newlines.begin() + (cursor - 1));
+        base_line += cursor - 1;
+        cursor = 1;
+    }
+    return base_line + cursor + 1;
+}
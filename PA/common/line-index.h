@@ -0,0 +1,53 @@
+/*  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+ *  Índice de saltos de línea del archivo que se está escaneando.
+ *
+ *  Código compartido (PA/common): lo usan el lexer (lab01C++/cool.flex),
+ *  que llena el índice, y el parser (lab02C++/cool.y), que lo consulta
+ *  para la columna de los errores.  Cada laboratorio lo compila con
+ *  -I../common y enlaza common/line-index.cc.
+ */
+#ifndef LINE_INDEX_H
+#define LINE_INDEX_H
+
+#include <stddef.h>
+#include <vector>
+
+/*
+ *  En vez de sumar curr_lineno en cada regla que consume un '\n', el lexer
+ *  le pasa a este índice cada bloque que lee del archivo (YY_INPUT) y los
+ *  tokens sólo guardan su posición en bytes.  La línea y la columna de una
+ *  posición se calculan con búsqueda binaria cuando alguien las necesita.
+ */
+class LineIndex {
+public:
+    LineIndex() : input_offset(0), cursor(0), base_line(0), bounded(false) { }
+
+    /* Registra los '\n' de un bloque leído; los bloques llegan en orden. */
+    void add_chunk(const char *buf, int len);
+    void reset();
+
+    /* Línea (desde 1) y columna (desde 1) de una posición en bytes. */
+    int lineno(int offset);
+    int column(int offset);
+
+    /* Como lineno(), para posiciones que no retroceden: avanza un cursor
+     * en lugar de buscar, así que cuesta O(1) amortizado por token. */
+    int advance_to(int offset);
+
+    /* En modo acotado (lexer en streaming) se olvidan los '\n' que el
+     * cursor ya pasó, así que sólo se pueden consultar posiciones desde
+     * la línea del último token. */
+    void set_bounded(bool b) { bounded = b; }
+
+private:
+    std::vector<int> newlines;   /* posición de cada '\n', en orden */
+    int input_offset;            /* bytes leídos hasta ahora */
+    size_t cursor;
+    int base_line;               /* '\n' olvidados en modo acotado */
+    bool bounded;
+};
+
+extern LineIndex cool_line_index;
+extern int curr_offset;   /* posición del primer byte del último token */
+
+#endif
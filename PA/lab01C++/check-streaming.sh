@@ -0,0 +1,71 @@
+#!/bin/sh
+#  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+#  Prueba de memoria del modo streaming del lexer: le pasa por una tubería
+#  entradas de cientos de megas (líneas en blanco, líneas con muchos
+#  espacios, comentarios de línea y tokens) y revisa que el pico de memoria
+#  residente (VmHWM en /proc) no pase del límite y que el último token
+#  salga con su número de línea.
+#
+#      ./check-streaming.sh
+#
+#  Variables de entorno: LEXER, el lexer a usar (por defecto ./lexer);
+#  SIZE_MB, el tamaño de cada entrada en megas (por defecto 256), y
+#  LIMIT_KB, el pico de memoria permitido en KB (por defecto 65536).
+
+LEXER=${LEXER:-./lexer}
+SIZE_MB=${SIZE_MB:-256}
+LIMIT_KB=${LIMIT_KB:-65536}
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+pass=0
+fail=0
+
+# check <nombre> <línea>: le pasa al lexer <línea> repetida hasta llenar
+# $SIZE_MB megas, seguida de "class", y mide el pico de memoria mientras
+# corre.  De la salida sólo se guardan las últimas líneas.
+check() {
+    lines=$((SIZE_MB * 1048576 / ($(printf '%s' "$2" | wc -c) + 1)))
+    rm -f "$WORK/pipe"
+    mkfifo "$WORK/pipe"
+    tail -n 5 < "$WORK/pipe" > "$WORK/$1.out" &
+    (yes "$2" | head -n $lines; echo class) | $LEXER /dev/stdin > "$WORK/pipe" 2>&1 &
+    pid=$!
+    peak=0
+    while kill -0 $pid 2>/dev/null; do
+        hwm=$(awk '/^VmHWM:/ { print $2 }' /proc/$pid/status 2>/dev/null)
+        [ -n "$hwm" ] && peak=$hwm
+        sleep 0.1
+    done
+    if ! wait $pid; then
+        wait
+        echo "$1: el lexer falló"
+        tail -5 "$WORK/$1.out"
+        fail=$((fail + 1))
+        return
+    fi
+    wait
+    if ! grep -q "^#$((lines + 1)) CLASS\$" "$WORK/$1.out"; then
+        echo "$1: falta CLASS en la línea $((lines + 1))"
+        tail -5 "$WORK/$1.out"
+        fail=$((fail + 1))
+        return
+    fi
+    if [ "$peak" -gt "$LIMIT_KB" ]; then
+        echo "$1: pico de $peak KB, más de $LIMIT_KB KB"
+        fail=$((fail + 1))
+        return
+    fi
+    echo "$1: ok ($peak KB)"
+    pass=$((pass + 1))
+}
+
+check vacias ""
+check espacios "$(printf '%200s' '')"
+check tabs "$(printf ' \t\f\r%.0s' $(seq 50))"
+check comentarios "   -- comentario de línea"
+check tokens "  x <- x + 1;   "
+
+echo "$pass ok, $fail con diferencias"
+[ $fail -eq 0 ]
@@ -0,0 +1,85 @@
+#!/bin/sh
+#  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+#  Prueba de ida y vuelta de la caché de tokens (COOL_TOKEN_CACHE): para
+#  cada archivo corre el lexer sin caché, después con la caché vacía (la
+#  graba) y después otra vez (la reproduce), y compara las tres salidas.
+#  Al final cambia el fuente y revisa que la caché vieja no se use.
+#
+#      ./check-token-cache.sh               COOLExamples/*.cl y errores.cl
+#      ./check-token-cache.sh a.cl b.cl     sólo esos
+#
+#  Variables de entorno: LEXER, el lexer a usar (por defecto ./lexer).
+
+LEXER=${LEXER:-./lexer}
+case "$LEXER" in
+    */*) LEXER=$(cd "$(dirname "$LEXER")" && pwd)/$(basename "$LEXER") ;;
+esac
+
+EXAMPLES=$(cd "$(dirname "$0")/../COOLExamples" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# Tokens de error y cadenas con escapes, que van a sus propias tablas
+cat > "$WORK/errores.cl" <<'EOF'
+class Main { s : String <- "a\tb\
+c"; x : Int <- 007; # ~ "sin cerrar
+ t : Bool <- tRUE; f : Bool <- fALSE; c : String <- "\0";
+};
+"nul: \
+EOF
+
+if [ $# -eq 0 ]; then
+    set -- "$EXAMPLES"/*.cl "$WORK/errores.cl"
+fi
+
+# Los archivos se copian a $WORK: la caché se guarda al lado del fuente, y
+# el nombre del archivo aparece en la salida del lexer
+lex() {
+    (cd "$WORK" && "$@" "$LEXER" "$name")
+}
+
+pass=0
+fail=0
+for file in "$@"; do
+    name=$(basename "$file")
+    [ "$file" -ef "$WORK/$name" ] || cp "$file" "$WORK/$name"
+    rm -f "$WORK/$name.tok"
+
+    lex env -u COOL_TOKEN_CACHE > "$WORK/live" 2>&1
+    lex env COOL_TOKEN_CACHE=1 > "$WORK/record" 2>&1
+    if [ ! -f "$WORK/$name.tok" ]; then
+        echo "$name: no se grabó la caché"
+        fail=$((fail + 1))
+        continue
+    fi
+    lex env COOL_TOKEN_CACHE=1 > "$WORK/replay" 2>&1
+
+    if cmp -s "$WORK/live" "$WORK/record" && cmp -s "$WORK/live" "$WORK/replay"; then
+        echo "$name: ok"
+        pass=$((pass + 1))
+    else
+        echo "$name: distinto"
+        diff "$WORK/live" "$WORK/record"
+        diff "$WORK/live" "$WORK/replay"
+        fail=$((fail + 1))
+    fi
+done
+
+# Con el fuente cambiado el hash ya no coincide y se vuelve a escanear
+name=cambiado.cl
+printf 'class Main {};\n' > "$WORK/$name"
+lex env COOL_TOKEN_CACHE=1 > /dev/null 2>&1
+printf 'class Main { x : Int; };\n' > "$WORK/$name"
+lex env -u COOL_TOKEN_CACHE > "$WORK/live" 2>&1
+lex env COOL_TOKEN_CACHE=1 > "$WORK/replay" 2>&1
+if cmp -s "$WORK/live" "$WORK/replay"; then
+    echo "$name: ok"
+    pass=$((pass + 1))
+else
+    echo "$name: se usó la caché de otro fuente"
+    diff "$WORK/live" "$WORK/replay"
+    fail=$((fail + 1))
+fi
+
+echo "$pass ok, $fail con diferencias"
+[ $fail -eq 0 ]
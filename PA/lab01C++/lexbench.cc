@@ -0,0 +1,258 @@
+/*  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+ *  Benchmark de rendimiento del lexer de COOL (cool.flex).
+ *
+ *  Se enlaza igual que lextest (en lugar de lextest.o) y recibe los tamaños
+ *  en MB de los corpus a generar:
+ *
+ *      lexbench            corpus de 1, 10 y 100 MB
+ *      lexbench 1 10       sólo 1 y 10 MB
+ *
+ *  Para cada tamaño genera un archivo sintético por cada mezcla (muchos
+ *  identificadores, strings, comentarios, enteros o todo mezclado), lo
+ *  escanea con cool_yylex y reporta tokens/s, MB/s y asignaciones con new
+ *  por token.  Con la mezcla "mixed" además compara el volcado textual de
+ *  tokens con la caché binaria de token-cache.h.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <new>
+#include <string>
+#include <sstream>
+#include <iostream>
+#include "cool-parse.h"
+#include "utilities.h"
+#include "token-cache.h"
+
+FILE *fin;
+int curr_lineno = 1;
+char *curr_filename = (char *) "<bench>";
+
+extern int cool_yylex();
+extern void yyrestart(FILE *);
+
+/* Conteo de asignaciones hechas con new durante el escaneo */
+static unsigned long allocations = 0;
+
+void *operator new(size_t size)
+{
+    allocations++;
+    void *p = malloc(size ? size : 1);
+    if (p == NULL)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) throw() { free(p); }
+void operator delete[](void *p) throw() { free(p); }
+
+enum Mix { IDENT_MIX, STRING_MIX, COMMENT_MIX, INTEGER_MIX, MIXED_MIX, NUM_MIXES };
+
+static const char *mix_names[NUM_MIXES] = { "ident", "string", "comment", "integer", "mixed" };
+
+static unsigned int seed = 12345;
+
+static unsigned int next_random()
+{
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) & 0x7fff;
+}
+
+static const char *words[] = {
+    "x", "count", "list_head", "value", "tmp2", "iterator", "self", "parent_node",
+    "out_string", "a2i_aux", "nextElement", "sum", "i", "CONST_9", "result"
+};
+static const int num_words = sizeof(words) / sizeof(words[0]);
+
+static void gen_ident(std::string &out)
+{
+    out += words[next_random() % num_words];
+    out += " <- ";
+    out += words[next_random() % num_words];
+    out += ".";
+    out += words[next_random() % num_words];
+    out += "(";
+    out += words[next_random() % num_words];
+    out += ", ";
+    out += words[next_random() % num_words];
+    out += ");\n";
+}
+
+static void gen_string(std::string &out)
+{
+    out += "out_string(\"";
+    int n = 4 + next_random() % 12;
+    for (int i = 0; i < n; i++) {
+        out += words[next_random() % num_words];
+        switch (next_random() % 6) {
+            case 0:  out += "\\n"; break;
+            case 1:  out += "\\t"; break;
+            case 2:  out += "\\\"q\\\""; break;
+            default: out += " "; break;
+        }
+    }
+    out += "\");\n";
+}
+
+static void gen_comment(std::string &out)
+{
+    if (next_random() % 3 == 0) {
+        out += "-- ";
+        out += words[next_random() % num_words];
+        out += " * ( ) comentario de una línea\n";
+        return;
+    }
+    out += "(* ";
+    int lines = 1 + next_random() % 6;
+    for (int i = 0; i < lines; i++) {
+        out += "  Copyright (c) ";
+        out += words[next_random() % num_words];
+        out += " -- * ( ) ** ((x)) ";
+        if (next_random() % 4 == 0)
+            out += "(* anidado *) ";
+        out += "\n";
+    }
+    out += "*)\n";
+}
+
+static void gen_integer(std::string &out)
+{
+    char buf[32];
+    int n = 2 + next_random() % 5;
+    for (int i = 0; i < n; i++) {
+        snprintf(buf, sizeof(buf), "%u", next_random() * (next_random() % 100));
+        out += buf;
+        out += i + 1 < n ? " + " : ";\n";
+    }
+}
+
+/* Escribe un corpus de aproximadamente mb megabytes y devuelve su ruta */
+static std::string generate_corpus(Mix mix, int mb)
+{
+    char path[] = "/tmp/lexbenchXXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        perror("mkstemp");
+        exit(1);
+    }
+    FILE *out = fdopen(fd, "w");
+
+    size_t target = (size_t) mb << 20, written = 0;
+    std::string chunk;
+    while (written < target) {
+        chunk.clear();
+        chunk += "class C { f() : Object {{\n";
+        while (chunk.size() < 4096) {
+            Mix m = mix == MIXED_MIX ? (Mix) (next_random() % MIXED_MIX) : mix;
+            switch (m) {
+                case IDENT_MIX:   gen_ident(chunk); break;
+                case STRING_MIX:  gen_string(chunk); break;
+                case COMMENT_MIX: gen_comment(chunk); break;
+                default:          gen_integer(chunk); break;
+            }
+        }
+        chunk += "}} };\n";
+        fwrite(chunk.data(), 1, chunk.size(), out);
+        written += chunk.size();
+    }
+    fclose(out);
+    return path;
+}
+
+static double now()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/* Escanea el archivo completo; si stream no es NULL guarda ahí los tokens
+ * y su volcado textual en dump */
+static unsigned long scan(const std::string &path, TokenStream *stream, std::ostream *dump)
+{
+    fin = fopen(path.c_str(), "r");
+    curr_lineno = 1;
+    yyrestart(fin);
+
+    unsigned long tokens = 0;
+    int token;
+    while ((token = cool_yylex()) != 0) {
+        tokens++;
+        if (stream != NULL) {
+            stream->add(token, curr_lineno, &cool_yylval);
+            dump_cool_token(*dump, curr_lineno, token, cool_yylval);
+        }
+    }
+    fclose(fin);
+    return tokens;
+}
+
+static void run(Mix mix, int mb)
+{
+    std::string path = generate_corpus(mix, mb);
+
+    unsigned long allocs_before = allocations;
+    double start = now();
+    unsigned long tokens = scan(path, NULL, NULL);
+    double elapsed = now() - start;
+    unsigned long allocs = allocations - allocs_before;
+
+    printf("%-8s %4d MB  %10lu tokens  %7.3f s  %12.0f tok/s  %8.2f MB/s  %6.3f alloc/tok\n",
+           mix_names[mix], mb, tokens, elapsed, tokens / elapsed, mb / elapsed,
+           tokens ? (double) allocs / tokens : 0.0);
+
+    /* La comparación con la caché se hace en otra pasada, fuera de la
+     * medición */
+    if (mix == MIXED_MIX) {
+        TokenStream stream;
+        std::ostringstream dump;
+        scan(path, &stream, &dump);
+
+        FILE *cache = tmpfile();
+        stream.write(cache);
+        long cache_size = ftell(cache);
+
+        rewind(cache);
+        TokenStream loaded;
+        start = now();
+        loaded.read(cache);
+        YYSTYPE val;
+        int lineno;
+        for (int i = 0; i < loaded.size(); i++)
+            loaded.get(i, &val, &lineno);
+        double load = now() - start;
+        fclose(cache);
+
+        printf("         volcado textual %10lu bytes, caché binaria %10ld bytes (%.1f%%), "
+               "carga de la caché %.3f s\n",
+               (unsigned long) dump.str().size(), cache_size,
+               100.0 * cache_size / dump.str().size(), load);
+    }
+
+    unlink(path.c_str());
+}
+
+int main(int argc, char **argv)
+{
+    int sizes[16], num_sizes = 0;
+    for (int i = 1; i < argc && num_sizes < 16; i++)
+        sizes[num_sizes++] = atoi(argv[i]);
+    if (num_sizes == 0) {
+        sizes[0] = 1;
+        sizes[1] = 10;
+        sizes[2] = 100;
+        num_sizes = 3;
+    }
+
+    for (int i = 0; i < num_sizes; i++)
+        for (int mix = 0; mix < NUM_MIXES; mix++)
+            run((Mix) mix, sizes[i]);
+    return 0;
+}
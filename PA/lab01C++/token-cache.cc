@@ -0,0 +1,264 @@
+/*  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+ *  Caché binaria del flujo de tokens producido por el lexer de COOL.
+ */
+#include <string.h>
+#include <stdlib.h>
+#include "token-cache.h"
+
+static TokenStream cache;
+static bool replaying = false;
+static bool recording = false;
+static int replay_pos = 0;
+static std::string cache_path;
+
+/* Tabla de cadenas en la que se guarda el valor de cada tipo de token. */
+static int table_of(int token)
+{
+    switch (token) {
+        case OBJECTID:
+        case TYPEID:    return TokenStream::ID_TABLE;
+        case INT_CONST: return TokenStream::INT_TABLE;
+        case STR_CONST: return TokenStream::STR_TABLE;
+        case ERROR:     return TokenStream::ERR_TABLE;
+        default:        return -1;
+    }
+}
+
+static void put_varint(FILE *out, unsigned long long n)
+{
+    while (n >= 0x80) {
+        putc((int) (n & 0x7f) | 0x80, out);
+        n >>= 7;
+    }
+    putc((int) n, out);
+}
+
+static bool get_varint(FILE *in, unsigned long long *n)
+{
+    int c, shift = 0;
+    *n = 0;
+    while ((c = getc(in)) != EOF) {
+        *n |= (unsigned long long) (c & 0x7f) << shift;
+        if ((c & 0x80) == 0)
+            return true;
+        shift += 7;
+        if (shift > 63)
+            return false;
+    }
+    return false;
+}
+
+int TokenStream::intern(int table, const char *s, int len)
+{
+    std::string str(s, len);
+    std::map<std::string, int>::iterator it = indexes[table].find(str);
+    if (it != indexes[table].end())
+        return it->second;
+
+    int index = strings[table].size();
+    strings[table].push_back(str);
+    indexes[table].insert(std::make_pair(str, index));
+    return index;
+}
+
+void TokenStream::add(int token, int lineno, YYSTYPE *val)
+{
+    Token t;
+    t.token = token;
+    t.lineno = lineno;
+    t.value = -1;
+
+    int table = table_of(token);
+    if (token == BOOL_CONST) {
+        t.value = val->boolean ? 1 : 0;
+    } else if (table == ERR_TABLE) {
+        /* error_msg puede apuntar a yytext, que el lexer reutiliza */
+        t.value = intern(table, val->error_msg, strlen(val->error_msg));
+    } else if (table >= 0) {
+        t.value = intern(table, val->symbol->get_string(), val->symbol->get_len());
+    }
+    tokens.push_back(t);
+}
+
+bool TokenStream::write(FILE *out)
+{
+    fwrite(TOKEN_CACHE_MAGIC, 1, 7, out);
+    putc(TOKEN_CACHE_VERSION, out);
+    put_varint(out, source_hash);
+
+    for (int table = 0; table < NUM_TABLES; table++) {
+        put_varint(out, strings[table].size());
+        for (size_t i = 0; i < strings[table].size(); i++) {
+            put_varint(out, strings[table][i].size());
+            fwrite(strings[table][i].data(), 1, strings[table][i].size(), out);
+        }
+    }
+
+    put_varint(out, tokens.size());
+    int lineno = 0;
+    for (size_t i = 0; i < tokens.size(); i++) {
+        put_varint(out, tokens[i].token);
+        put_varint(out, tokens[i].lineno - lineno);
+        lineno = tokens[i].lineno;
+        if (tokens[i].value >= 0)
+            put_varint(out, tokens[i].value);
+    }
+    return !ferror(out);
+}
+
+bool TokenStream::read(FILE *in)
+{
+    char magic[8];
+    unsigned long long n, len, value;
+
+    if (fread(magic, 1, 8, in) != 8 || memcmp(magic, TOKEN_CACHE_MAGIC, 7) != 0
+        || magic[7] != TOKEN_CACHE_VERSION)
+        return false;
+    if (!get_varint(in, &source_hash))
+        return false;
+
+    for (int table = 0; table < NUM_TABLES; table++) {
+        strings[table].clear();
+        symbols[table].clear();
+        if (!get_varint(in, &n))
+            return false;
+        for (unsigned long long i = 0; i < n; i++) {
+            if (!get_varint(in, &len))
+                return false;
+            std::string str(len, '\0');
+            if (len > 0 && fread(&str[0], 1, len, in) != len)
+                return false;
+            strings[table].push_back(str);
+
+            /* Se internan una sola vez al cargar, no en cada token */
+            char *s = (char *) strings[table].back().c_str();
+            switch (table) {
+                case ID_TABLE:  symbols[table].push_back(idtable.add_string(s, len)); break;
+                case INT_TABLE: symbols[table].push_back(inttable.add_string(s, len)); break;
+                case STR_TABLE: symbols[table].push_back(stringtable.add_string(s, len)); break;
+                default:        symbols[table].push_back(NULL); break;
+            }
+        }
+    }
+
+    if (!get_varint(in, &n))
+        return false;
+    tokens.clear();
+    tokens.reserve(n);
+    int lineno = 0;
+    for (unsigned long long i = 0; i < n; i++) {
+        Token t;
+        if (!get_varint(in, &value))
+            return false;
+        t.token = (int) value;
+        if (!get_varint(in, &value))
+            return false;
+        lineno += (int) value;
+        t.lineno = lineno;
+        t.value = -1;
+
+        int table = table_of(t.token);
+        if (table >= 0 || t.token == BOOL_CONST) {
+            if (!get_varint(in, &value))
+                return false;
+            t.value = (int) value;
+            if (table >= 0 && value >= strings[table].size())
+                return false;
+        }
+        tokens.push_back(t);
+    }
+    return true;
+}
+
+int TokenStream::get(int i, YYSTYPE *val, int *lineno)
+{
+    Token &t = tokens[i];
+    *lineno = t.lineno;
+
+    int table = table_of(t.token);
+    if (t.token == BOOL_CONST)
+        val->boolean = t.value;
+    else if (table == ERR_TABLE)
+        val->error_msg = (char *) strings[table][t.value].c_str();
+    else if (table >= 0)
+        val->symbol = symbols[table][t.value];
+    return t.token;
+}
+
+unsigned long long token_cache_hash(FILE *f)
+{
+    if (fseek(f, 0, SEEK_SET) != 0)
+        return 0;
+
+    unsigned long long hash = 14695981039346656037ULL;
+    char buf[1 << 16];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            hash ^= (unsigned char) buf[i];
+            hash *= 1099511628211ULL;
+        }
+    }
+    clearerr(f);
+    fseek(f, 0, SEEK_SET);
+    return hash == 0 ? 1 : hash;
+}
+
+bool token_cache_open(const char *source_path, FILE *source)
+{
+    replaying = recording = false;
+    replay_pos = 0;
+
+    unsigned long long hash = token_cache_hash(source);
+    if (hash == 0)
+        return false;
+
+    cache_path = std::string(source_path) + ".tok";
+    FILE *in = fopen(cache_path.c_str(), "rb");
+    if (in != NULL) {
+        bool ok = cache.read(in) && cache.source_hash == hash;
+        fclose(in);
+        if (ok) {
+            replaying = true;
+            return true;
+        }
+    }
+
+    cache = TokenStream();
+    cache.source_hash = hash;
+    recording = true;
+    return false;
+}
+
+bool token_cache_replaying()
+{
+    return replaying;
+}
+
+int token_cache_next(YYSTYPE *val, int *lineno)
+{
+    if (replay_pos >= cache.size())
+        return 0;
+    return cache.get(replay_pos++, val, lineno);
+}
+
+bool token_cache_recording()
+{
+    return recording;
+}
+
+void token_cache_record(int token, int lineno, YYSTYPE *val)
+{
+    cache.add(token, lineno, val);
+
+    /* Al llegar al fin de archivo se escribe la caché completa */
+    if (token == 0) {
+        recording = false;
+        FILE *out = fopen(cache_path.c_str(), "wb");
+        if (out == NULL)
+            return;
+        bool ok = cache.write(out);
+        if (fclose(out) != 0 || !ok)
+            remove(cache_path.c_str());
+    }
+}
@@ -0,0 +1,80 @@
+/*  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+ *  Caché binaria del flujo de tokens producido por el lexer de COOL.
+ */
+#ifndef TOKEN_CACHE_H
+#define TOKEN_CACHE_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <cool-parse.h>
+#include <stringtab.h>
+
+/*
+ *  Formato del archivo (todos los enteros se escriben como varint LEB128):
+ *
+ *    "COOLTOK" <versión>             cabecera de 8 bytes
+ *    <hash FNV-1a del fuente>        para saber si la caché sigue vigente
+ *    4 tablas de cadenas             idtable, inttable, stringtable, errores
+ *        <n> { <largo> <bytes> }*
+ *    <n tokens>
+ *        { <token> <delta de línea> [<índice en la tabla>] }*
+ *
+ *  Solo OBJECTID, TYPEID, INT_CONST, STR_CONST, BOOL_CONST y ERROR llevan
+ *  índice (BOOL_CONST guarda directamente 0 o 1).  Las líneas sólo crecen,
+ *  así que se guarda la diferencia con el token anterior.
+ */
+#define TOKEN_CACHE_MAGIC   "COOLTOK"
+#define TOKEN_CACHE_VERSION 1
+
+/* Variable de entorno que activa la caché: si existe, el lexer guarda o
+ * reutiliza <archivo>.tok al lado de cada fuente. */
+#define TOKEN_CACHE_ENV     "COOL_TOKEN_CACHE"
+
+class TokenStream {
+public:
+    enum { ID_TABLE, INT_TABLE, STR_TABLE, ERR_TABLE, NUM_TABLES };
+
+    struct Token {
+        int token;   /* código del token (258.. o un caracter) */
+        int lineno;
+        int value;   /* índice en la tabla, booleano o -1 */
+    };
+
+    TokenStream() : source_hash(0) { }
+
+    void add(int token, int lineno, YYSTYPE *val);
+    bool write(FILE *out);
+    bool read(FILE *in);
+
+    int size() { return tokens.size(); }
+    /* Restaura el token i en *val y devuelve su código. */
+    int get(int i, YYSTYPE *val, int *lineno);
+
+    unsigned long long source_hash;
+
+private:
+    int intern(int table, const char *s, int len);
+
+    std::vector<Token> tokens;
+    std::vector<std::string> strings[NUM_TABLES];
+    std::map<std::string, int> indexes[NUM_TABLES];
+    std::vector<Symbol> symbols[NUM_TABLES];   /* llenado por read() */
+};
+
+/* Hash FNV-1a del contenido de f; deja f al inicio.  Devuelve 0 si f no
+ * se puede rebobinar (p. ej. una tubería), en cuyo caso no se usa caché. */
+unsigned long long token_cache_hash(FILE *f);
+
+/* Ganchos que usa cool_yylex (ver cool.flex). */
+bool token_cache_replaying();
+int  token_cache_next(YYSTYPE *val, int *lineno);
+bool token_cache_recording();
+void token_cache_record(int token, int lineno, YYSTYPE *val);
+
+/* Abre la caché de source_path: la carga si coincide con el fuente, o
+ * empieza a grabar una nueva.  Devuelve true si se va a reproducir. */
+bool token_cache_open(const char *source_path, FILE *source);
+
+#endif
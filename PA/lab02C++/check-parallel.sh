@@ -0,0 +1,91 @@
+#!/bin/sh
+#  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+#  Prueba del parseo en paralelo (COOL_PARSE_JOBS, ver parallel-parse.h):
+#  parsea programas de varios archivos en un solo proceso y con 2, 4 y 8
+#  procesos, y compara la salida estándar, la de errores y el código de
+#  salida.  Los programas son COOLExamples completo, uno generado con
+#  muchos archivos, el mismo con errores de sintaxis repartidos (menos y
+#  más de 50, el límite del parser) y ese último con COOL_MAX_ERRORS.
+#
+#      ./check-parallel.sh
+#
+#  Variables de entorno: PARSER, el parser enlazado con parser-main.o (por
+#  defecto ./parser).
+
+PARSER=${PARSER:-./parser}
+FILES=40
+
+EXAMPLES=$(cd "$(dirname "$0")/../COOLExamples" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+pass=0
+fail=0
+
+# check <nombre> <archivos...>: compara COOL_PARSE_JOBS=1 con 2, 4 y 8
+check() {
+    name=$1
+    shift
+    COOL_PARSE_JOBS=1 $PARSER "$@" > "$WORK/$name.1.out" 2> "$WORK/$name.1.err"
+    serial=$?
+    for jobs in 2 4 8; do
+        COOL_PARSE_JOBS=$jobs $PARSER "$@" > "$WORK/$name.$jobs.out" 2> "$WORK/$name.$jobs.err"
+        status=$?
+        if [ $status -ne $serial ]; then
+            echo "$name: con $jobs procesos sale con $status y no con $serial"
+            fail=$((fail + 1))
+            return
+        fi
+        for kind in out err; do
+            if ! cmp -s "$WORK/$name.1.$kind" "$WORK/$name.$jobs.$kind"; then
+                echo "$name: con $jobs procesos cambia la salida ($kind)"
+                diff "$WORK/$name.1.$kind" "$WORK/$name.$jobs.$kind" | head -5
+                fail=$((fail + 1))
+                return
+            fi
+        done
+    done
+    echo "$name: ok (sale con $serial)"
+    pass=$((pass + 1))
+}
+
+# gen <prefijo> <errores>: $FILES archivos con tres clases cada uno; en
+# los impares la primera clase lleva ese número de errores de sintaxis
+gen() {
+    i=0
+    while [ $i -lt $FILES ]; do
+        awk -v f=$i -v errors=$2 'BEGIN {
+            for (c = 0; c < 3; c++) {
+                print "class C" f "_" c " inherits IO {"
+                print "  x : Int <- " f * 10 + c ";"
+                print "  get(y : Int) : Int { x + y * " c " };"
+                if (errors && f % 2 && c == 0)
+                    for (e = 0; e < errors; e++)
+                        print "  bad" e "() : Int { 1 + };"
+                print "  show() : SELF_TYPE { out_int(get(" f ")) };"
+                print "};"
+            }
+            if (f == 0)
+                print "class Main { main() : Object { (new C0_0).show() }; };"
+        }' > "$WORK/$1$i.cl"
+        i=$((i + 1))
+    done
+}
+
+check examples "$EXAMPLES"/*.cl
+
+gen ok 0
+check generado "$WORK"/ok*.cl
+
+gen pocos 1
+check errores "$WORK"/pocos*.cl
+
+gen muchos 4
+check limite "$WORK"/muchos*.cl
+
+export COOL_MAX_ERRORS=30
+check max-errors "$WORK"/muchos*.cl
+unset COOL_MAX_ERRORS
+
+echo "$pass ok, $fail con diferencias"
+[ $fail -eq 0 ]
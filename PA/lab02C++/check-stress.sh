@@ -0,0 +1,77 @@
+#!/bin/sh
+#  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+#  Prueba de listas largas en el parser: una clase con 100.000 features,
+#  un método con 10.000 argumentos y un bloque con 100.000 expresiones.
+#  Con las listas recursivas por la derecha la pila de bison se llenaba
+#  ("memory exhausted"); con las recursivas por la izquierda cada elemento
+#  se reduce al leerlo.  Revisa que el parser termine bien y que el AST
+#  tenga todos los elementos, en orden.
+#
+#      ./check-stress.sh
+#
+#  Variables de entorno: PARSER, el lexer y el parser encadenados (por
+#  defecto ./myparser).
+
+PARSER=${PARSER:-./myparser}
+FEATURES=100000
+FORMALS=10000
+BLOCK=100000
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+pass=0
+fail=0
+
+# check <nombre> <patrón> <cantidad>: parsea $WORK/<nombre>.cl y cuenta las
+# líneas del AST que son exactamente <patrón>
+check() {
+    if ! $PARSER "$WORK/$1.cl" > "$WORK/$1.out" 2> "$WORK/$1.err"; then
+        echo "$1: el parser falló"
+        head -5 "$WORK/$1.err"
+        fail=$((fail + 1))
+        return
+    fi
+    found=$(grep -c "^ *$2\$" "$WORK/$1.out")
+    if [ "$found" -ne "$3" ]; then
+        echo "$1: $found de $3 elementos"
+        fail=$((fail + 1))
+        return
+    fi
+    echo "$1: ok"
+    pass=$((pass + 1))
+}
+
+# Métodos y atributos alternados; el nombre dice la posición
+awk -v n=$FEATURES 'BEGIN {
+    print "class Main {"
+    for (i = 0; i < n; i++)
+        if (i % 2) print "  m" i "() : Int { " i " };"
+        else print "  a" i " : Int;"
+    print "};"
+}' > "$WORK/features.cl"
+check features "_\(method\|attr\)" $FEATURES
+# orden: el último feature del AST es el último del archivo
+if ! grep "^ *[am][0-9]*\$" "$WORK/features.out" | tail -1 | grep -q "m$((FEATURES - 1))\$"; then
+    echo "features: los features quedaron fuera de orden"
+    fail=$((fail + 1))
+fi
+
+awk -v n=$FORMALS 'BEGIN {
+    printf "class Main { f("
+    for (i = 0; i < n; i++)
+        printf "%sx%d : Int", (i ? ", " : ""), i
+    print ") : Int { 0 }; };"
+}' > "$WORK/formals.cl"
+check formals "_formal" $FORMALS
+
+awk -v n=$BLOCK 'BEGIN {
+    print "class Main { f() : Object { {"
+    for (i = 0; i < n; i++)
+        print "  " i ";"
+    print "} }; };"
+}' > "$WORK/block.cl"
+check block "_int" $BLOCK
+
+echo "$pass ok, $fail con diferencias"
+[ $fail -eq 0 ]
@@ -6,15 +6,70 @@
 */
 %{
     #include <iostream>
+    #include <sstream>
+    #include <map>
+    #include <stdlib.h>
+    #include <string.h>
     #include "cool-tree.h"
     #include "stringtab.h"
     #include "utilities.h"
+    #include "line-index.h"
+    #include "ast-binary.h"
 
     extern char *curr_filename;
   
   
     /* Locations */
     #define YYLTYPE int              /* the type of locations */
+    
+    /* Compilado como C++, bison sólo agranda su pila si YYLTYPE_IS_TRIVIAL
+       y YYSTYPE_IS_TRIVIAL valen 1; si no, se queda en las 200 entradas
+       iniciales y unos 66 paréntesis anidados o un let con 33 variables
+       dan "memory exhausted".  YYLTYPE_IS_TRIVIAL no se puede definir
+       porque YYLTYPE es int: con esa macro bison inicializa yylloc (aquí
+       curr_lineno) como la estructura de siempre, "= { 1, 1, 1, 1 }", que
+       no compila para un int.  En su lugar se define yyoverflow, que bison
+       llama cuando la pila se llena: cool_grow_stack la pasa al heap y la
+       duplica cada vez, así que la profundidad sólo la limita la memoria
+       (13 bytes por entrada: estado, valor y línea). */
+    #define yyoverflow cool_grow_stack
+
+    /* Copia stack (used bytes) a *owned, que queda de bytes bytes: la
+       primera vez stack es el arreglo local de yyparse */
+    static bool grow_stack(void **owned, void **stack, size_t used, size_t bytes) {
+        void *grown = *stack == *owned ? realloc(*owned, bytes) : malloc(bytes);
+        if (grown == NULL)
+            return false;
+        if (*stack != *owned) {
+            memcpy(grown, *stack, used);
+            free(*owned);
+        }
+        *owned = *stack = grown;
+        return true;
+    }
+
+    void yyerror(char *s);
+
+    /* Las tres pilas quedan en memoria de este archivo y se reusan en el
+       siguiente parseo; bison no las libera cuando hay yyoverflow */
+    template <class State, class Value, class Location, class Size>
+    static void cool_grow_stack(const char *msg,
+                                State **states, size_t states_used,
+                                Value **values, size_t values_used,
+                                Location **locations, size_t locations_used,
+                                Size *size) {
+        static void *owned[3];
+        Size grown = *size * 2;
+        if (grown <= *size ||
+            !grow_stack(&owned[0], (void **) states, states_used, grown * sizeof(State)) ||
+            !grow_stack(&owned[1], (void **) values, values_used, grown * sizeof(Value)) ||
+            !grow_stack(&owned[2], (void **) locations, locations_used, grown * sizeof(Location))) {
+            yyerror((char *) msg);   /* *size no cambia y bison aborta */
+            return;
+        }
+        *size = grown;
+    }
+
     #define cool_yylloc curr_lineno  /* use the curr_lineno from the lexer
                                         for the location of tokens */
     
@@ -25,7 +80,21 @@
       
     #define YYLLOC_DEFAULT(Current, Rhs, N)         \
     Current = Rhs[1];                             \
-    node_lineno = Current;
+    node_lineno = Current;                        \
+    TRACK_STACK_DEPTH()
+    
+    #ifdef PARSEBENCH
+    /* Profundidad máxima que alcanzó la pila de bison en el último
+       cool_yyparse (la reporta parsebench.cc, que compila este archivo con
+       -DPARSEBENCH).  Se mide en cada reducción, que es cuando la pila está
+       más alta: después de apilar un token el parser apila otro o reduce. */
+    int cool_parse_max_depth = 0;
+    #define TRACK_STACK_DEPTH()                     \
+    if (yyssp - yyss + 1 > cool_parse_max_depth)  \
+        cool_parse_max_depth = yyssp - yyss + 1;
+    #else
+    #define TRACK_STACK_DEPTH()
+    #endif
     
     
     #define SET_NODELOC(Current)  \
@@ -75,6 +144,29 @@
     
     
     
+    /* La función generada por bison queda como cool_yyparse_grammar;
+       cool_yyparse (al final del archivo) la envuelve para escribir los
+       diagnósticos acumulados al terminar. */
+    #undef yyparse
+    #define yyparse cool_yyparse_grammar
+
+    /* Variable de entorno con el máximo de errores a reportar (0: sin
+       límite).  Sin ella el parser se porta como el original: reporta
+       todos los errores y al pasar de 50 termina (ver yyerror). */
+    #define MAX_ERRORS_ENV "COOL_MAX_ERRORS"
+    #define DEFAULT_MAX_ERRORS 50
+
+    static void error_sync();     /* fin de la ventana de errores en cascada */
+
+    /* Hojas compartidas y símbolos preinternados, ver al final del archivo */
+    static Expression shared_int_const(Symbol token);
+    static Expression shared_string_const(Symbol token);
+    static Expression shared_bool_const(Boolean val);
+    static Expression shared_object(Symbol name);
+    static Expression self_object();
+    static Symbol object_symbol();
+    static Symbol filename_symbol();
+
     void yyerror(char *s);        /*  defined below; called for each parse error */
     extern int yylex();           /*  the entry point to the lexer  */
     
@@ -162,25 +254,38 @@ documentation for details). */
 
 %%
 
-program : class_list {@$ = @1; ast_root = program($1) ; } ;
+program : class_list {@$ = @1; ast_root = program($1);
+                      /* Con COOL_AST_OUT=<ruta> también se deja el AST en formato binario */
+                      if (omerrs == 0 && getenv(AST_BINARY_ENV) != NULL)
+                        ast_binary_write(ast_root, getenv(AST_BINARY_ENV)); } ;
 
 class_list : class { $$ = single_Classes($1); parse_results = $$; }
 
             | class_list class { $$ = append_Classes($1, single_Classes($2)); parse_results = $$; };
 
-class : CLASS TYPEID '{' feature_list '}' ';' { $$ = class_($2, idtable.add_string("Object"), $4, stringtable.add_string(curr_filename));}
+/* Recuperación de errores: después de un error sólo se vuelve a reportar
+   otro cuando el parser se sincroniza, es decir, al terminar un feature o
+   una expresión de un bloque con ';' o al empezar una clase nueva (ver
+   error_sync).  Los errores de en medio suelen ser consecuencia del
+   primero. */
+class : class_start TYPEID '{' feature_list '}' ';' { $$ = class_($2, object_symbol(), $4, filename_symbol());}
       
-      | CLASS TYPEID INHERITS TYPEID '{' feature_list '}' ';' { $$ = class_($2, $4, $6, stringtable.add_string(curr_filename)); }
+      | class_start TYPEID INHERITS TYPEID '{' feature_list '}' ';' { $$ = class_($2, $4, $6, filename_symbol()); }
 
       | error ;
 
+class_start : CLASS { error_sync(); } ;
+
 feature_list : nonempty_feature_list { $$ = $1; }
 
              | { $$ = nil_Features(); } ;
 
-nonempty_feature_list : feature ';' nonempty_feature_list { $$ = append_Features(single_Features($1), $3); }
+/* Las listas son recursivas por la izquierda, como class_list: bison reduce
+   cada elemento apenas lo lee en vez de guardarlos todos en su pila hasta
+   el final de la lista, y append_* sólo agrega un nodo por elemento. */
+nonempty_feature_list : nonempty_feature_list feature ';' { $$ = append_Features($1, single_Features($2)); error_sync(); }
 
-                      | feature ';' { $$ = single_Features($1); } ;
+                      | feature ';' { $$ = single_Features($1); error_sync(); } ;
 
 feature : OBJECTID '(' formal_list ')' ':' TYPEID '{' nonempty_expr '}' { $$ = method($1, $3, $6, $8); }
 
@@ -194,7 +299,7 @@ formal_list : nonempty_formal_list { $$ = $1; }
 
             | { $$ = nil_Formals(); } ;
 
-nonempty_formal_list : formal ',' nonempty_formal_list { $$ = append_Formals(single_Formals($1), $3); }
+nonempty_formal_list : nonempty_formal_list ',' formal { $$ = append_Formals($1, single_Formals($3)); }
 
                      | formal { $$ = single_Formals($1); };
 
@@ -207,9 +312,9 @@ expression_list : expression_list ',' nonempty_expr { $$ = append_Expressions($1
                 | { $$ = nil_Expressions(); } ;
 
 
-nonempty_block : nonempty_expr ';' { $$ = single_Expressions($1); }
+nonempty_block : nonempty_expr ';' { $$ = single_Expressions($1); error_sync(); }
 
-               | nonempty_expr ';' nonempty_block { $$ = append_Expressions(single_Expressions($1), $3); }
+               | nonempty_block nonempty_expr ';' { $$ = append_Expressions($1, single_Expressions($2)); error_sync(); }
                
                | error ;
 
@@ -237,7 +342,7 @@ nonempty_expr : OBJECTID ASSIGN nonempty_expr { $$ = assign($1, $3); }
 
               | nonempty_expr '.' OBJECTID '(' expression_list ')' { $$ = dispatch($1, $3, $5); }
 
-              | OBJECTID '(' expression_list ')' { $$ = dispatch(object(idtable.add_string("self")), $1, $3); }
+              | OBJECTID '(' expression_list ')' { $$ = dispatch(self_object(), $1, $3); }
 
               | IF nonempty_expr THEN nonempty_expr ELSE nonempty_expr FI { $$ = cond($2, $4, $6); }
 
@@ -273,13 +378,13 @@ nonempty_expr : OBJECTID ASSIGN nonempty_expr { $$ = assign($1, $3); }
 
               | '(' nonempty_expr ')' { $$ = $2; }
 
-              | OBJECTID { $$ = object($1); }
+              | OBJECTID { $$ = shared_object($1); }
 
-              | INT_CONST { $$ = int_const($1); }
+              | INT_CONST { $$ = shared_int_const($1); }
               
-              | STR_CONST { $$ = string_const($1); }
+              | STR_CONST { $$ = shared_string_const($1); }
 
-              | BOOL_CONST { $$ = bool_const($1); }
+              | BOOL_CONST { $$ = shared_bool_const($1); }
 
               | error { } ;
 
@@ -290,22 +395,207 @@ while_exp : WHILE nonempty_expr LOOP expression POOL { $$ = loop($2, $4); }
 /* end of grammar */
 %%
 
-/* This function is called automatically when Bison detects a parse error. */
+/* Hojas compartidas (hash-consing)
+   ================================
+   Las constantes y self se repiten muchísimo en el código generado, y cada
+   aparición creaba un nodo nuevo.  Estos nodos no cambian después de
+   creados salvo por el tipo, que para ellos siempre es el mismo (Int,
+   String, Bool, SELF_TYPE), así que se pueden compartir.  El volcado del
+   AST imprime la línea de cada nodo, por eso sólo se comparten entre
+   apariciones de la misma línea: la tabla se vacía cuando cambia
+   node_lineno, y así sólo guarda las hojas de la línea actual.  Los demás
+   identificadores no se comparten porque su tipo depende del alcance. */
+typedef std::map<Symbol, Expression> LeafTable;
+
+static int leaf_lineno = -1;
+static LeafTable int_leaves, string_leaves;
+static Expression bool_leaves[2], self_leaf;
+
+static void check_leaf_line() {
+    if (node_lineno != leaf_lineno) {
+        leaf_lineno = node_lineno;
+        int_leaves.clear();
+        string_leaves.clear();
+        bool_leaves[0] = bool_leaves[1] = self_leaf = NULL;
+    }
+}
+
+static Expression shared_leaf(LeafTable &table, Symbol token, Expression (*make)(Symbol)) {
+    check_leaf_line();
+    LeafTable::iterator it = table.find(token);
+    if (it != table.end())
+        return it->second;
+    Expression e = make(token);
+    table.insert(std::make_pair(token, e));
+    return e;
+}
+
+static Expression shared_int_const(Symbol token) {
+    return shared_leaf(int_leaves, token, int_const);
+}
+
+static Expression shared_string_const(Symbol token) {
+    return shared_leaf(string_leaves, token, string_const);
+}
+
+static Expression shared_bool_const(Boolean val) {
+    check_leaf_line();
+    Expression &e = bool_leaves[val ? 1 : 0];
+    if (e == NULL)
+        e = bool_const(val);
+    return e;
+}
+
+static Symbol self_symbol() {
+    static Symbol self = idtable.add_string("self");
+    return self;
+}
+
+static Expression self_object() {
+    check_leaf_line();
+    if (self_leaf == NULL)
+        self_leaf = object(self_symbol());
+    return self_leaf;
+}
+
+static Expression shared_object(Symbol name) {
+    return name == self_symbol() ? self_object() : object(name);
+}
+
+static Symbol object_symbol() {
+    static Symbol object = idtable.add_string("Object");
+    return object;
+}
+
+/* El nombre del archivo se interna una vez por archivo, no por clase */
+static Symbol filename_symbol() {
+    static Symbol symbol = NULL;
+    if (symbol == NULL || strcmp(symbol->get_string(), curr_filename) != 0)
+        symbol = stringtable.add_string(curr_filename);
+    return symbol;
+}
+
+/* Los diagnósticos se acumulan en memoria y se escriben de una vez al
+   terminar el parseo (o cuando pasan de 64 KB): cerr no tiene buffer y cada
+   << de un mensaje era una escritura aparte. */
+static std::ostringstream diagnostics;
+static bool error_window = false;   /* hubo un error y no se ha sincronizado */
+static int max_errors = -1;         /* -1: aún no se lee MAX_ERRORS_ENV */
+static bool error_exit;             /* sin MAX_ERRORS_ENV: exit(1) pasado el límite */
+static bool suppress_cascades;      /* con MAX_ERRORS_ENV */
+
+/* Con varios archivos (parallel-parse.cc) el resumen "More than N errors"
+   se escribe una vez al final, no al terminar cada archivo */
+bool cool_parse_partial = false;
+
+static void read_max_errors() {
+    if (max_errors >= 0)
+        return;
+    char *env = getenv(MAX_ERRORS_ENV);
+    error_exit = env == NULL;
+    suppress_cascades = env != NULL;
+    max_errors = env != NULL ? atoi(env) : DEFAULT_MAX_ERRORS;
+}
+
+static void flush_diagnostics() {
+    cerr << diagnostics.str();
+    cerr.flush();
+    diagnostics.str("");
+}
+
+/* El límite es para todo el programa: omerrs suma los errores de todos
+   los archivos.  Estas funciones también las usa parallel-parse.cc, que
+   aplica el límite al escribir los errores de sus procesos. */
+
+/* Cuenta un error y dice si todavía se reporta */
+bool cool_count_error() {
+    read_max_errors();
+    omerrs++;
+    return error_exit || max_errors == 0 || omerrs <= max_errors;
+}
+
+/* Sin MAX_ERRORS_ENV: ya se reportó el error que pasa del límite */
+bool cool_error_limit_hit() {
+    return error_exit && omerrs > max_errors;
+}
+
+void cool_error_exit() {
+    flush_diagnostics();
+    fprintf(stdout, "More than %d errors\n", max_errors);
+    exit(1);
+}
+
+/* Con MAX_ERRORS_ENV, al terminar de parsear */
+void cool_errors_summary() {
+    if (!error_exit && max_errors > 0 && omerrs > max_errors)
+        fprintf(stdout, "More than %d errors\n", max_errors);
+}
+
+/* Los procesos de parallel-parse.cc reportan todos sus errores; el límite
+   lo aplica el proceso principal */
+void cool_uncapped_errors() {
+    read_max_errors();
+    error_exit = false;
+    max_errors = 0;
+}
+
+static void error_sync() {
+    error_window = false;
+}
+
+/* This function is called automatically when Bison detects a parse error.
+   Con MAX_ERRORS_ENV los errores en cascada no se reportan ni se cuentan,
+   y pasado el límite se sigue parseando hasta el final del archivo sin
+   reportar nada más.  Sin la variable se reporta cada error y, como en el
+   parser original, el que pasa de 50 termina el proceso. */
 void yyerror(char *s) {
     extern int curr_lineno;
 
-    cerr << "\"" << curr_filename << "\", line " << curr_lineno << ": "
-         << s << " at or near ";
+    if (suppress_cascades) {
+        if (error_window)
+            return;
+        error_window = true;
+    }
+
+    if (!cool_count_error())
+        return;
+
+    /* print_cool_token escribe en cerr, así que se redirige todo el mensaje */
+    std::streambuf *out = cerr.rdbuf(diagnostics.rdbuf());
+
+    cerr << "\"" << curr_filename << "\", line " << curr_lineno;
+    
+    /* La columna sale del índice de saltos de línea del lexer; no se conoce
+       cuando los tokens vienen de la caché */
+    if (curr_offset >= 0)
+        cerr << ", column " << cool_line_index.column(curr_offset);
+    
+    cerr << ": " << s << " at or near ";
          
     print_cool_token(yychar);
     
     cerr << endl;
-    
-    omerrs++;
 
-    if (omerrs > 50) {
-        fprintf(stdout, "More than 50 errors\n");
-        exit(1);
-    }
-    
+    cerr.rdbuf(out);
+
+    if (cool_error_limit_hit())
+        cool_error_exit();
+
+    if (diagnostics.tellp() > (1 << 16))
+        flush_diagnostics();
+}
+
+int cool_yyparse() {
+    read_max_errors();
+    error_window = false;
+#ifdef PARSEBENCH
+    cool_parse_max_depth = 0;
+#endif
+
+    int result = yyparse();
+
+    flush_diagnostics();
+    if (!cool_parse_partial)
+        cool_errors_summary();
+    return result;
 }
@@ -0,0 +1,239 @@
+/*  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+ *  Parseo en paralelo de un programa repartido en varios archivos.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <string>
+#include <vector>
+#include "cool-tree.h"
+#include "ast-binary.h"
+#include "parallel-parse.h"
+
+extern FILE *fin;
+extern char *curr_filename;
+extern int omerrs;
+extern int node_lineno;
+extern Program ast_root;
+extern Classes parse_results;
+extern int cool_yyparse();
+extern void cool_yylex_new_file(FILE *);
+
+/* Límite de errores, ver cool.y */
+extern bool cool_parse_partial;
+extern bool cool_count_error();
+extern bool cool_error_limit_hit();
+extern void cool_error_exit();
+extern void cool_errors_summary();
+extern void cool_uncapped_errors();
+
+int parse_jobs()
+{
+    char *env = getenv(PARSE_JOBS_ENV);
+    int jobs = env != NULL ? atoi(env) : (int) sysconf(_SC_NPROCESSORS_ONLN);
+    return jobs > 0 ? jobs : 1;
+}
+
+/* Parsea un archivo en el proceso actual.  Si no hubo errores devuelve
+ * true y deja sus clases en parse_results y su program en ast_root. */
+static bool parse_file(char *file)
+{
+    fin = fopen(file, "r");
+    if (fin == NULL) {
+        if (cool_count_error())
+            cerr << "Could not open input file " << file << endl;
+        if (cool_error_limit_hit())
+            cool_error_exit();
+        return false;
+    }
+    curr_filename = file;
+    parse_results = NULL;
+
+    int errors = omerrs;
+    cool_yylex_new_file(fin);
+    cool_yyparse();
+    fclose(fin);
+    return omerrs == errors && parse_results != NULL;
+}
+
+/* Copia el contenido de path en out y borra el archivo */
+static void replay(const std::string &path, FILE *out)
+{
+    FILE *in = fopen(path.c_str(), "r");
+    if (in != NULL) {
+        char buf[1 << 16];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), in)) > 0)
+            fwrite(buf, 1, n, out);
+        fclose(in);
+    }
+    fflush(out);
+    unlink(path.c_str());
+}
+
+/* Escribe en stderr los errores de un archivo, uno por línea, contándolos
+ * en omerrs con el límite como si se hubieran reportado en este proceso.
+ * Borra el archivo y devuelve cuántos errores tenía. */
+static int replay_errors(const std::string &path)
+{
+    int errors = 0;
+    FILE *in = fopen(path.c_str(), "r");
+    if (in != NULL) {
+        char *line = NULL;
+        size_t cap = 0;
+        while (getline(&line, &cap, in) > 0 && !cool_error_limit_hit()) {
+            errors++;
+            if (cool_count_error())
+                fputs(line, stderr);
+        }
+        free(line);
+        fclose(in);
+    }
+    fflush(stderr);
+    unlink(path.c_str());
+    return errors;
+}
+
+/* Borra lo que quede de los procesos en dir */
+static void remove_work_dir(const std::string &dir, int nfiles)
+{
+    static const char *suffixes[] = { ".out", ".err", ".ast" };
+    for (int i = 0; i < nfiles; i++)
+        for (int k = 0; k < 3; k++) {
+            char name[32];
+            snprintf(name, sizeof(name), "/%d%s", i, suffixes[k]);
+            unlink((dir + name).c_str());
+        }
+    rmdir(dir.c_str());
+}
+
+/* Trabajo de un proceso hijo: los archivos first, first + step, ...  La
+ * salida de cada archivo va a <dir>/<i>.out y <dir>/<i>.err, y su AST a
+ * <dir>/<i>.ast sólo si se parseó sin errores. */
+static void parse_worker(int nfiles, char **files, int first, int step, const std::string &dir)
+{
+    cool_uncapped_errors();
+    for (int i = first; i < nfiles; i += step) {
+        char name[32];
+        snprintf(name, sizeof(name), "/%d", i);
+        std::string base = dir + name;
+
+        cout.flush();
+        fflush(stdout);
+        int out = open((base + ".out").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+        int err = open((base + ".err").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+        if (out < 0 || err < 0)
+            _exit(1);
+        dup2(out, 1);
+        dup2(err, 2);
+        close(out);
+        close(err);
+
+        if (parse_file(files[i]))
+            ast_binary_write(ast_root, (base + ".ast").c_str());
+    }
+    cout.flush();
+    fflush(stdout);
+}
+
+int parallel_parse(int nfiles, char **files, int jobs)
+{
+    /* El parser escribe COOL_AST_OUT al terminar cada archivo; aquí sólo
+     * se escribe una vez, con el programa completo. */
+    std::string ast_out;
+    if (getenv(AST_BINARY_ENV) != NULL) {
+        ast_out = getenv(AST_BINARY_ENV);
+        unsetenv(AST_BINARY_ENV);
+    }
+
+    Classes classes = nil_Classes();
+    int failed = 0;
+    int line = 0;
+
+    if (jobs > nfiles)
+        jobs = nfiles;
+
+    std::string dir;
+    if (jobs > 1) {
+        char tmp[] = "/tmp/coolparseXXXXXX";
+        if (mkdtemp(tmp) == NULL)
+            jobs = 1;
+        else
+            dir = tmp;
+    }
+
+    cool_parse_partial = true;
+    if (jobs <= 1) {
+        for (int i = 0; i < nfiles; i++) {
+            if (parse_file(files[i])) {
+                classes = append_Classes(classes, parse_results);
+                line = ast_root->get_line_number();
+            } else {
+                failed++;
+            }
+        }
+    } else {
+        cout.flush();
+        fflush(stdout);
+        fflush(stderr);
+
+        std::vector<pid_t> workers;
+        for (int k = 0; k < jobs; k++) {
+            pid_t pid = fork();
+            if (pid == 0) {
+                parse_worker(nfiles, files, k, jobs, dir);
+                _exit(0);
+            }
+            if (pid > 0)
+                workers.push_back(pid);
+        }
+        for (size_t k = 0; k < workers.size(); k++)
+            waitpid(workers[k], NULL, 0);
+
+        /* Si un proceso no se pudo crear o terminó antes de tiempo, sus
+         * archivos no tienen AST y se reportan como fallidos. */
+        for (int i = 0; i < nfiles; i++) {
+            char name[32];
+            snprintf(name, sizeof(name), "/%d", i);
+            std::string base = dir + name;
+
+            replay(base + ".out", stdout);
+            int errors = replay_errors(base + ".err");
+
+            ASTView view;
+            if (view.Open((base + ".ast").c_str())) {
+                classes = append_Classes(classes, view.BuildClasses());
+                line = view.Node(view.Root()).line;
+            } else {
+                if (errors == 0 && cool_count_error())
+                    cerr << "Parsing of " << files[i] << " did not finish" << endl;
+                failed++;
+            }
+            view.Close();
+            unlink((base + ".ast").c_str());
+
+            /* Sin COOL_MAX_ERRORS el parser termina en el error 51, igual
+             * que si hubiera parseado los archivos en orden */
+            if (cool_error_limit_hit()) {
+                remove_work_dir(dir, nfiles);
+                cool_error_exit();
+            }
+        }
+        remove_work_dir(dir, nfiles);
+    }
+    cool_parse_partial = false;
+    cool_errors_summary();
+
+    node_lineno = line;
+    ast_root = program(classes);
+    parse_results = classes;
+
+    if (!ast_out.empty()) {
+        setenv(AST_BINARY_ENV, ast_out.c_str(), 1);
+        if (omerrs == 0)
+            ast_binary_write(ast_root, ast_out.c_str());
+    }
+    return failed;
+}
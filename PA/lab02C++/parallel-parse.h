@@ -0,0 +1,37 @@
+/*  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+ *  Parseo en paralelo de un programa repartido en varios archivos.
+ */
+#ifndef PARALLEL_PARSE_H
+#define PARALLEL_PARSE_H
+
+/*
+ *  Cada archivo de COOL es una lista de clases independiente, así que se
+ *  puede parsear por separado y después concatenar las listas.  El lexer,
+ *  el parser de bison y las tablas de símbolos son estado global, por eso
+ *  en lugar de hilos se usan procesos: cada uno tiene su propia arena del
+ *  AST y sus propias tablas de símbolos, parsea su parte de los archivos y
+ *  deja el AST de cada uno en el formato binario de ast-binary.h.  El
+ *  proceso principal los mapea en el orden de entrada, interna los símbolos
+ *  en sus tablas y arma un solo program con todas las clases.
+ *
+ *  Los mensajes de error de cada archivo se guardan aparte y se imprimen en
+ *  el orden de entrada, así que la salida no depende de qué proceso
+ *  terminó primero.  Los procesos reportan todos sus errores y el
+ *  principal los cuenta en omerrs al escribirlos, así que el límite de
+ *  errores (ver COOL_MAX_ERRORS en cool.y) es para el programa entero, como
+ *  al parsear los archivos en orden en un solo proceso.
+ */
+
+/* Variable de entorno con el número de procesos (por omisión, uno por
+ * procesador).  Con 1 se parsea todo en el mismo proceso. */
+#define PARSE_JOBS_ENV "COOL_PARSE_JOBS"
+
+/* Parsea files[0..nfiles) con hasta jobs procesos y deja el resultado en
+ * ast_root y parse_results.  Devuelve el número de archivos con errores;
+ * omerrs queda con el total de errores. */
+int parallel_parse(int nfiles, char **files, int jobs);
+
+/* Número de procesos a usar según PARSE_JOBS_ENV. */
+int parse_jobs();
+
+#endif
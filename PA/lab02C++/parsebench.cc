@@ -0,0 +1,251 @@
+/*  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+ *  Benchmark de rendimiento y memoria del parser de COOL (cool.y).
+ *
+ *  Se enlaza igual que parser, pero en lugar de parser-phase.o y del lexer
+ *  de tokens (tokens-lex.o), con cool-parse.cc compilado con -DPARSEBENCH
+ *  para que mida la pila, y recibe los tamaños en miles de tokens de las
+ *  entradas a generar:
+ *
+ *      parsebench            entradas de 10, 100 y 1000 mil tokens
+ *      parsebench 50 500     sólo 50 y 500 mil tokens
+ *
+ *  Para cada tamaño arma en memoria un flujo de tokens ya escaneado por
+ *  cada forma de programa (expresiones muy anidadas, bloques largos,
+ *  muchas clases pequeñas y cadenas largas de let, que pasan por
+ *  inner_let), se lo da al parser con cool_yylex y reporta el tiempo de
+ *  parseo, nodos/s, la profundidad máxima de la pila del parser y los
+ *  bytes del AST por nodo.  Así el lexer no entra en la medición.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <vector>
+#include "cool-tree.h"
+#include "cool-parse.h"
+#include "utilities.h"
+#include "line-index.h"
+
+char *curr_filename = (char *) "<bench>";
+
+extern int curr_lineno;       /* la define cool.y (cool_yylloc) */
+extern int omerrs;
+extern int cool_yyparse();
+extern int cool_parse_max_depth;   /* ver cool.y, sólo con -DPARSEBENCH */
+
+/* Niveles de paréntesis por expresión anidada y variables por let.  Ambas
+ * formas hacen crecer la pila de bison con cada nivel; se dejan fijos para
+ * que con el tamaño de la entrada crezca la cantidad de expresiones y no
+ * la profundidad. */
+#define NEST_DEPTH  1000
+#define LET_LENGTH  500
+#define BLOCK_LENGTH 5000
+
+enum Shape { NEST_SHAPE, BLOCK_SHAPE, CLASS_SHAPE, LET_SHAPE, NUM_SHAPES };
+
+static const char *shape_names[NUM_SHAPES] = { "nest", "block", "classes", "let" };
+
+struct BenchToken {
+    int token;
+    int lineno;
+    YYSTYPE val;
+};
+
+/* Flujo que está leyendo el parser */
+static std::vector<BenchToken> tokens;
+static size_t next_token = 0;
+
+int cool_yylex()
+{
+    if (next_token >= tokens.size())
+        return 0;
+    BenchToken &t = tokens[next_token++];
+    cool_yylval = t.val;
+    curr_lineno = t.lineno;
+    return t.token;
+}
+
+/* Generación de los flujos
+ * ======================== */
+static int lineno = 1;
+
+static void tok(int token)
+{
+    BenchToken t;
+    t.token = token;
+    t.lineno = lineno;
+    t.val.symbol = NULL;
+    tokens.push_back(t);
+}
+
+static void sym(int token, Symbol s)
+{
+    tok(token);
+    tokens.back().val.symbol = s;
+}
+
+static void type(const char *name)   { sym(TYPEID, idtable.add_string((char *) name)); }
+static void ident(const char *name)  { sym(OBJECTID, idtable.add_string((char *) name)); }
+static void number(int n)            { sym(INT_CONST, inttable.add_int(n)); }
+static void newline()                { lineno++; }
+
+/* class <name> inherits IO { ... } ; */
+static void open_class(const char *name)
+{
+    tok(CLASS); type(name); tok(INHERITS); type("IO"); tok('{');
+}
+
+static void close_class()
+{
+    tok('}'); tok(';');
+    newline();
+}
+
+/* <name>(x : Int) : Int { ... } ; */
+static void open_method(const char *name)
+{
+    ident(name); tok('('); ident("x"); tok(':'); type("Int"); tok(')');
+    tok(':'); type("Int"); tok('{');
+    newline();
+}
+
+static void close_method()
+{
+    tok('}'); tok(';');
+    newline();
+}
+
+/* (x + (1 + (x + ... ))) con NEST_DEPTH niveles */
+static void gen_nest(int n)
+{
+    open_method("nest");
+    for (int i = 0; i < NEST_DEPTH; i++) {
+        tok('(');
+        if (i % 2) ident("x"); else number(i);
+        tok(i % 3 ? '+' : '*');
+        if (i % 16 == 15)
+            newline();
+    }
+    number(n);
+    for (int i = 0; i < NEST_DEPTH; i++)
+        tok(')');
+    close_method();
+}
+
+/* { x <- x + i; out_int(x); ... } con BLOCK_LENGTH expresiones */
+static void gen_block(int n)
+{
+    open_method("block");
+    tok('{');
+    for (int i = 0; i < BLOCK_LENGTH; i++) {
+        ident("x"); tok(ASSIGN); ident("x"); tok('+'); number(n + i); tok(';');
+        ident("out_int"); tok('('); ident("x"); tok(')'); tok(';');
+        newline();
+    }
+    tok('}');
+    close_method();
+}
+
+/* Una clase pequeña con un atributo y un método */
+static void gen_class(int n)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "C%d", n);
+    open_class(name);
+    ident("count"); tok(':'); type("Int"); tok(ASSIGN); number(n); tok(';');
+    newline();
+    open_method("get");
+    ident("count"); tok('+'); ident("x");
+    close_method();
+    close_class();
+}
+
+/* let a0 : Int <- 0, a1 : Int <- a0 + 1, ... in a<LET_LENGTH - 1> */
+static void gen_let(int n)
+{
+    open_method("let");
+    tok(LET);
+    char name[32], prev[32];
+    for (int i = 0; i < LET_LENGTH; i++) {
+        snprintf(name, sizeof(name), "a%d", i);
+        ident(name); tok(':'); type("Int"); tok(ASSIGN);
+        if (i == 0) {
+            number(n);
+        } else {
+            ident(prev); tok('+'); number(1);
+        }
+        tok(i + 1 < LET_LENGTH ? ',' : IN);
+        newline();
+        snprintf(prev, sizeof(prev), "%s", name);
+    }
+    ident(prev);
+    close_method();
+}
+
+/* Llena tokens con unos target tokens de la forma pedida */
+static void generate(Shape shape, size_t target)
+{
+    tokens.clear();
+    next_token = 0;
+    lineno = 1;
+
+    int n = 0;
+    if (shape != CLASS_SHAPE)
+        open_class("Main");
+    while (tokens.size() < target) {
+        switch (shape) {
+            case NEST_SHAPE:  gen_nest(n); break;
+            case BLOCK_SHAPE: gen_block(n); break;
+            case CLASS_SHAPE: gen_class(n); break;
+            default:          gen_let(n); break;
+        }
+        n++;
+    }
+    if (shape != CLASS_SHAPE)
+        close_class();
+}
+
+static double now()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static void run(Shape shape, int thousands)
+{
+    generate(shape, (size_t) thousands * 1000);
+
+    omerrs = 0;
+    size_t nodes_before = ASTArena::num_nodes();
+    size_t bytes_before = ASTArena::bytes_used();
+    double start = now();
+    int result = cool_yyparse();
+    double elapsed = now() - start;
+    size_t nodes = ASTArena::num_nodes() - nodes_before;
+    size_t bytes = ASTArena::bytes_used() - bytes_before;
+
+    printf("%-8s %6dk  %9lu tokens  %7.3f s  %12.0f tok/s  %9lu nodos  %12.0f nodos/s  "
+           "pila %6d  %5.1f bytes/nodo%s\n",
+           shape_names[shape], thousands, (unsigned long) tokens.size(), elapsed,
+           tokens.size() / elapsed, (unsigned long) nodes, nodes / elapsed,
+           cool_parse_max_depth, nodes ? (double) bytes / nodes : 0.0,
+           result != 0 || omerrs != 0 ? "  (con errores)" : "");
+}
+
+int main(int argc, char **argv)
+{
+    int sizes[16], num_sizes = 0;
+    for (int i = 1; i < argc && num_sizes < 16; i++)
+        sizes[num_sizes++] = atoi(argv[i]);
+    if (num_sizes == 0) {
+        sizes[0] = 10;
+        sizes[1] = 100;
+        sizes[2] = 1000;
+        num_sizes = 3;
+    }
+
+    for (int i = 0; i < num_sizes; i++)
+        for (int shape = 0; shape < NUM_SHAPES; shape++)
+            run((Shape) shape, sizes[i]);
+    return 0;
+}
@@ -0,0 +1,51 @@
+/*  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+ *  Programa principal del parser para programas de varios archivos.
+ *
+ *  Se enlaza en lugar de parser-phase.o y del lector de tokens
+ *  (tokens-lex.o), con el lexer de lab01C++ (cool.flex): en lugar de leer
+ *  los tokens que imprime el lexer, escanea y parsea directamente los
+ *  archivos que recibe, con parallel_parse (ver parallel-parse.h):
+ *
+ *      ./parser a.cl b.cl c.cl                 un proceso por procesador
+ *      COOL_PARSE_JOBS=4 ./parser a.cl b.cl    hasta cuatro procesos
+ *      COOL_PARSE_JOBS=1 ./parser a.cl b.cl    todo en este proceso
+ *
+ *  Sin archivos parsea stdin.  La salida es la de parser-phase.o: los
+ *  errores en stderr y, si no hubo, el AST con dump_with_types, pero
+ *  volcado sin recursión (ast_dump_with_types, ver ast-visitor.h) para que
+ *  no se quede sin pila con expresiones de millones de niveles.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "cool-tree.h"
+#include "parallel-parse.h"
+#include "ast-visitor.h"
+
+FILE *fin;                                   /* lo lee cool.flex */
+char *curr_filename = (char *) "<stdin>";
+
+extern int omerrs;
+extern Program ast_root;
+extern int cool_yyparse();
+extern void handle_flags(int argc, char *argv[]);
+
+int main(int argc, char *argv[])
+{
+    handle_flags(argc, argv);
+
+    int nfiles = argc - optind;
+    if (nfiles > 0) {
+        parallel_parse(nfiles, argv + optind, parse_jobs());
+    } else {
+        fin = stdin;
+        cool_yyparse();
+    }
+
+    if (omerrs != 0) {
+        cerr << "Compilation halted due to lex and parse errors\n";
+        exit(1);
+    }
+    ast_dump_with_types(cout, 0, ast_root);
+    return 0;
+}
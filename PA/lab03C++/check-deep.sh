@@ -0,0 +1,94 @@
+#!/bin/sh
+#  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+#  Prueba de anidamiento profundo: programas con expresiones de un millón de
+#  niveles (un let de un millón de variables, una suma anidada por la
+#  derecha entre paréntesis, una por la izquierda y una cadena de dispatch).
+#  El parser, el chequeo de tipos y los volcados del AST tienen que terminar
+#  sin quedarse sin pila, y el AST con tipos tiene que tener todos los nodos.
+#
+#      ./check-deep.sh
+#
+#  El volcado de texto del AST no sirve entre el parser y semant: lo lee un
+#  parser de bison con pila de profundidad fija.  Por eso el AST pasa en el
+#  formato binario (COOL_AST_OUT y COOL_AST_IN, ver ast-binary.h).
+#
+#  Variables de entorno: PARSER, el parser enlazado con parser-main.o (por
+#  defecto ../lab02C++/parser), y SEMANT, semant enlazado con semant-main.o
+#  (por defecto ./semant).
+
+PARSER=${PARSER:-../lab02C++/parser}
+SEMANT=${SEMANT:-./semant}
+DEPTH=1000000
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+pass=0
+fail=0
+
+# check <nombre> <patrón> <cantidad>: compila $WORK/<nombre>.cl hasta semant
+# y cuenta las líneas del AST con tipos que son exactamente <patrón>
+check() {
+    if ! COOL_AST_OUT="$WORK/$1.ast" $PARSER "$WORK/$1.cl" > /dev/null 2> "$WORK/$1.err"; then
+        echo "$1: el parser falló"
+        head -5 "$WORK/$1.err"
+        fail=$((fail + 1))
+        return
+    fi
+    if ! COOL_AST_IN="$WORK/$1.ast" $SEMANT "$WORK/$1.cl" < /dev/null > "$WORK/$1.out" 2> "$WORK/$1.err"; then
+        echo "$1: semant falló"
+        head -5 "$WORK/$1.err"
+        fail=$((fail + 1))
+        return
+    fi
+    found=$(grep -c "^ *$2\$" "$WORK/$1.out")
+    if [ "$found" -ne "$3" ]; then
+        echo "$1: $found de $3 nodos"
+        fail=$((fail + 1))
+        return
+    fi
+    echo "$1: ok"
+    pass=$((pass + 1))
+}
+
+# let x0 : Int <- 0, x1 : Int <- 1, ... in x0: un _let por variable
+awk -v n=$DEPTH 'BEGIN {
+    printf "class Main { main() : Int { let "
+    for (i = 0; i < n; i++)
+        printf "%sx%d : Int <- %d", (i ? ", " : ""), i, i
+    print " in x0 }; };"
+}' > "$WORK/let.cl"
+check let _let $DEPTH
+
+# 1 + (1 + (1 + ... )): la pila del parser crece con cada paréntesis
+awk -v n=$DEPTH 'BEGIN {
+    printf "class Main { main() : Int { "
+    for (i = 1; i < n; i++)
+        printf "1 + ("
+    printf "1"
+    for (i = 1; i < n; i++)
+        printf ")"
+    print " }; };"
+}' > "$WORK/nested.cl"
+check nested _plus $((DEPTH - 1))
+
+# 1 + 1 + ... + 1: el árbol es igual de profundo, pero por la izquierda
+awk -v n=$DEPTH 'BEGIN {
+    printf "class Main { main() : Int { 1"
+    for (i = 1; i < n; i++)
+        printf " + 1"
+    print " }; };"
+}' > "$WORK/plus.cl"
+check plus _plus $((DEPTH - 1))
+
+# self.f().f()...
+awk -v n=$DEPTH 'BEGIN {
+    printf "class Main { f() : Main { self }; main() : Main { self"
+    for (i = 0; i < n; i++)
+        printf ".f()"
+    print " }; };"
+}' > "$WORK/dispatch.cl"
+check dispatch _dispatch $DEPTH
+
+echo "$pass ok, $fail con diferencias"
+[ $fail -eq 0 ]
@@ -9,9 +9,122 @@
 //////////////////////////////////////////////////////////
 
 
+#include <stddef.h>
+#include <stdlib.h>
+#include <vector>
 #include "tree.h"
 #include "cool-tree.handcode.h"
 
+// Arena de la compilación
+// =======================
+// Todos los nodos del AST (y las listas) se piden aquí en lugar de hacer un
+// new por nodo: se reservan bloques grandes y se van llenando en el orden en
+// que se crean los nodos, así que un padre y sus hijos quedan cerca en
+// memoria.  Los nodos viven hasta que termina el compilador, por eso delete
+// no hace nada.
+class ASTArena {
+public:
+   enum { BLOCK_SIZE = 1 << 20, ALIGN = sizeof(double) > sizeof(void *) ? sizeof(double) : sizeof(void *) };
+
+   static void *allocate(size_t size) {
+      ASTArena &a = instance();
+      size = (size + ALIGN - 1) & ~(size_t) (ALIGN - 1);
+      if (size > (size_t) (a.end - a.next)) {
+         // los pedidos enormes van en un bloque propio y no gastan el actual
+         if (size > BLOCK_SIZE / 4)
+            return a.new_block(size);
+         a.next = a.new_block(BLOCK_SIZE);
+         a.end = a.next + BLOCK_SIZE;
+      }
+      void *p = a.next;
+      a.next += size;
+      a.used += size;
+      a.nodes++;
+      return p;
+   }
+
+   static size_t bytes_used() { return instance().used; }
+   static size_t bytes_reserved() { return instance().reserved; }
+   static size_t num_nodes() { return instance().nodes; }
+
+private:
+   char *next, *end;
+   size_t used, reserved, nodes;
+
+   ASTArena() : next(NULL), end(NULL), used(0), reserved(0), nodes(0) { }
+
+   static ASTArena &instance() {
+      static ASTArena arena;
+      return arena;
+   }
+
+   char *new_block(size_t size) {
+      char *block = (char *) malloc(size);
+      if (block == NULL) {
+         cerr << "Out of memory while building the AST" << endl;
+         exit(1);
+      }
+      reserved += size;
+      return block;
+   }
+};
+
+#define AST_ARENA_ALLOCATED \
+   void *operator new(size_t size) { return ASTArena::allocate(size); } \
+   void operator delete(void *) { }
+
+class FlatAST;     // representación plana del AST, ver semant.h
+struct TypeFrame;  // estado del chequeo de una expresión, ver semant.h
+class ASTWriter;   // formato binario del AST, ver ast-binary.h
+
+// Constructores
+// =============
+// Una fila por cada constructor definido abajo: su fase, cuántos hijos
+// puede tener (mínimo y máximo, -1 si lleva una lista) y en qué tabla van
+// sus dos primeros símbolos (NO_TABLE si no los usa).  Los hijos son los
+// de NumChildren()/Child() en las expresiones y, en las demás fases, los
+// elementos de sus listas y sus subexpresiones, en el orden de
+// ast-binary.h.  De aquí salen ASTKind y la tabla con la que ASTView
+// valida el formato binario, así que no hay que mantener otra lista.
+#define COOL_CONSTRUCTORS(X) \
+   X(PROGRAM,         Program,    0, -1, NO_TABLE,  NO_TABLE) \
+   X(CLASS,           Class_,     0, -1, ID_TABLE,  ID_TABLE) \
+   X(METHOD,          Feature,    1, -1, ID_TABLE,  ID_TABLE) \
+   X(ATTR,            Feature,    1,  1, ID_TABLE,  ID_TABLE) \
+   X(FORMAL,          Formal,     0,  0, ID_TABLE,  ID_TABLE) \
+   X(BRANCH,          Case,       1,  1, ID_TABLE,  ID_TABLE) \
+   X(ASSIGN,          Expression, 1,  1, ID_TABLE,  NO_TABLE) \
+   X(STATIC_DISPATCH, Expression, 1, -1, ID_TABLE,  ID_TABLE) \
+   X(DISPATCH,        Expression, 1, -1, ID_TABLE,  NO_TABLE) \
+   X(COND,            Expression, 3,  3, NO_TABLE,  NO_TABLE) \
+   X(LOOP,            Expression, 2,  2, NO_TABLE,  NO_TABLE) \
+   X(TYPCASE,         Expression, 1, -1, NO_TABLE,  NO_TABLE) \
+   X(BLOCK,           Expression, 0, -1, NO_TABLE,  NO_TABLE) \
+   X(LET,             Expression, 2,  2, ID_TABLE,  ID_TABLE) \
+   X(PLUS,            Expression, 2,  2, NO_TABLE,  NO_TABLE) \
+   X(SUB,             Expression, 2,  2, NO_TABLE,  NO_TABLE) \
+   X(MUL,             Expression, 2,  2, NO_TABLE,  NO_TABLE) \
+   X(DIVIDE,          Expression, 2,  2, NO_TABLE,  NO_TABLE) \
+   X(NEG,             Expression, 1,  1, NO_TABLE,  NO_TABLE) \
+   X(LT,              Expression, 2,  2, NO_TABLE,  NO_TABLE) \
+   X(EQ,              Expression, 2,  2, NO_TABLE,  NO_TABLE) \
+   X(LEQ,             Expression, 2,  2, NO_TABLE,  NO_TABLE) \
+   X(COMP,            Expression, 1,  1, NO_TABLE,  NO_TABLE) \
+   X(INT_CONST,       Expression, 0,  0, INT_TABLE, NO_TABLE) \
+   X(BOOL_CONST,      Expression, 0,  0, NO_TABLE,  NO_TABLE) \
+   X(STRING_CONST,    Expression, 0,  0, STR_TABLE, NO_TABLE) \
+   X(NEW,             Expression, 0,  0, ID_TABLE,  NO_TABLE) \
+   X(ISVOID,          Expression, 1,  1, NO_TABLE,  NO_TABLE) \
+   X(NO_EXPR,         Expression, 0,  0, NO_TABLE,  NO_TABLE) \
+   X(OBJECT,          Expression, 0,  0, ID_TABLE,  NO_TABLE)
+
+#define COOL_CONSTRUCTOR_KIND(kind, phylum, min, max, table0, table1) AST_##kind,
+enum ASTKind {
+   COOL_CONSTRUCTORS(COOL_CONSTRUCTOR_KIND)
+   AST_NUM_KINDS
+};
+#undef COOL_CONSTRUCTOR_KIND
+
 //Partes extraídas de: https://github.com/skyzluo/CS143-Compilers-Stanford
 // define the class for phylum
 // define simple phylum - Program
@@ -21,6 +134,8 @@ class Program_class : public tree_node {
 public:
    tree_node *copy()     { return copy_Program(); }
    virtual Program copy_Program() = 0;
+   AST_ARENA_ALLOCATED
+   virtual int Serialize(ASTWriter &w) = 0;
 
 #ifdef Program_EXTRAS
    Program_EXTRAS
@@ -35,6 +150,8 @@ class Class__class : public tree_node {
 public:
    tree_node *copy()     { return copy_Class_(); }
    virtual Class_ copy_Class_() = 0;
+   AST_ARENA_ALLOCATED
+   virtual int Serialize(ASTWriter &w) = 0;
 
    virtual Symbol GetName() = 0;
    virtual Symbol GetParent() = 0;
@@ -53,12 +170,15 @@ class Feature_class : public tree_node {
 public:
    tree_node *copy()     { return copy_Feature(); }
    virtual Feature copy_Feature() = 0;
+   AST_ARENA_ALLOCATED
+   virtual int Serialize(ASTWriter &w) = 0;
    virtual void CheckFeatureType() = 0;
    //virtual void AddToTable(Symbol class_name) = 0;
    virtual void AddMethodToTable(Symbol class_name) = 0;
    virtual void AddAttribToTable(Symbol class_name) = 0;
    virtual Symbol GetName() = 0;
    virtual bool IsMethod() = 0;
+   virtual void Flatten(FlatAST &ast) = 0;
 #ifdef Feature_EXTRAS
    Feature_EXTRAS
 #endif
@@ -72,6 +192,8 @@ class Formal_class : public tree_node {
 public:
    tree_node *copy()     { return copy_Formal(); }
    virtual Formal copy_Formal() = 0;
+   AST_ARENA_ALLOCATED
+   virtual int Serialize(ASTWriter &w) = 0;
    virtual Symbol GetName() = 0;
    virtual Symbol GetType() = 0;
 #ifdef Formal_EXTRAS
@@ -87,7 +209,28 @@ class Expression_class : public tree_node {
 public:
    tree_node *copy()     { return copy_Expression(); }
    virtual Expression copy_Expression() = 0;
-   virtual Symbol CheckExprType() = 0;
+   AST_ARENA_ALLOCATED
+   virtual int Serialize(ASTWriter &w) = 0;
+
+   // Hijos de la expresión, para recorrerla sin recursión (ast-visitor.h).
+   // En los dispatch son expr y los argumentos; en typcase, expr y el
+   // cuerpo de cada rama.
+   virtual int NumChildren() = 0;
+   virtual Expression Child(int i) = 0;
+
+   // Chequeo de tipos paso a paso (ver TypeChecker en semant.cc):
+   // CheckEnter antes de los hijos, CheckChild después de cada hijo con su
+   // tipo y CheckExprType al final con los tipos de todos los hijos.
+   virtual void CheckEnter(TypeFrame &f) { }
+   virtual void CheckChild(TypeFrame &f, int i, Symbol type) { }
+   virtual Symbol CheckExprType(TypeFrame &f, Symbol *types) = 0;
+
+   // Volcado paso a paso con el formato de dump_with_types (ver
+   // ast-visitor.cc): DumpChild escribe lo que va antes del hijo i y
+   // devuelve su sangría.
+   virtual void DumpEnter(ostream &stream, int n) = 0;
+   virtual int DumpChild(ostream &stream, int n, int i) { return n + 2; }
+   virtual void DumpExit(ostream &stream, int n);
 #ifdef Expression_EXTRAS
    Expression_EXTRAS
 #endif
@@ -101,7 +244,8 @@ class Case_class : public tree_node {
 public:
    tree_node *copy()     { return copy_Case(); }
    virtual Case copy_Case() = 0;
-   virtual Symbol CheckBranchType() = 0;
+   AST_ARENA_ALLOCATED
+   virtual int Serialize(ASTWriter &w) = 0;
 #ifdef Case_EXTRAS
    Case_EXTRAS
 #endif
@@ -109,6 +253,102 @@ public:
 
 
 // define the class for phylum - LIST
+//
+// Las listas se construyen con append_*, que arma un árbol de append_node.
+// En tree.h, len() y nth() recorren ese árbol completo en cada llamada, así
+// que un for (first(); more(); next()) ... nth(i) es cuadrático.  Para las
+// listas del AST se especializa append_node: la primera vez que se consulta
+// se aplana en un vector y desde ahí len() y nth() son O(1).  Las listas no
+// se modifican después de construidas, así que la copia no se invalida.
+template <class Elem> class flat_append_node : public list_node<Elem> {
+protected:
+   list_node<Elem> *some, *rest;
+   std::vector<Elem> elems;
+   bool flattened;
+
+   void flatten() {
+      std::vector<list_node<Elem> *> pending;
+      pending.push_back(rest);
+      pending.push_back(some);
+      while (!pending.empty()) {
+         list_node<Elem> *l = pending.back();
+         pending.pop_back();
+         flat_append_node<Elem> *a = dynamic_cast<flat_append_node<Elem> *>(l);
+         if (a == NULL) {
+            // nil_node o single_list_node: a lo sumo un elemento
+            for (int i = 0, n = l->len(); i < n; i++)
+               elems.push_back(l->nth(i));
+         } else if (a->flattened) {
+            elems.insert(elems.end(), a->elems.begin(), a->elems.end());
+         } else {
+            pending.push_back(a->rest);
+            pending.push_back(a->some);
+         }
+      }
+      flattened = true;
+   }
+
+public:
+   AST_ARENA_ALLOCATED
+
+   flat_append_node(list_node<Elem> *l1, list_node<Elem> *l2) {
+      some = l1;
+      rest = l2;
+      flattened = false;
+   }
+   list_node<Elem> *copy_list() {
+      if (!flattened) flatten();
+      list_node<Elem> *copy = list_node<Elem>::nil();
+      for (size_t i = 0; i < elems.size(); i++)
+         copy = list_node<Elem>::append(copy, list_node<Elem>::single((Elem) elems[i]->copy()));
+      return copy;
+   }
+   int len() {
+      if (!flattened) flatten();
+      return elems.size();
+   }
+   Elem nth(int n) {
+      int len;
+      return nth_length(n, len);
+   }
+   Elem nth_length(int n, int &len) {
+      if (!flattened) flatten();
+      len = elems.size();
+      return n >= 0 && n < len ? elems[n] : NULL;
+   }
+   void dump(ostream& stream, int n) {
+      if (!flattened) flatten();
+      for (size_t i = 0; i < elems.size(); i++)
+         elems[i]->dump(stream, n);
+   }
+};
+
+template <> class append_node<Class_> : public flat_append_node<Class_> {
+public:
+   append_node(list_node<Class_> *l1, list_node<Class_> *l2) : flat_append_node<Class_>(l1, l2) { }
+};
+
+template <> class append_node<Feature> : public flat_append_node<Feature> {
+public:
+   append_node(list_node<Feature> *l1, list_node<Feature> *l2) : flat_append_node<Feature>(l1, l2) { }
+};
+
+template <> class append_node<Formal> : public flat_append_node<Formal> {
+public:
+   append_node(list_node<Formal> *l1, list_node<Formal> *l2) : flat_append_node<Formal>(l1, l2) { }
+};
+
+template <> class append_node<Expression> : public flat_append_node<Expression> {
+public:
+   append_node(list_node<Expression> *l1, list_node<Expression> *l2) : flat_append_node<Expression>(l1, l2) { }
+};
+
+template <> class append_node<Case> : public flat_append_node<Case> {
+public:
+   append_node(list_node<Case> *l1, list_node<Case> *l2) : flat_append_node<Case>(l1, l2) { }
+};
+
+
 // define list phlyum - Classes
 typedef list_node<Class_> Classes_class;
 typedef Classes_class *Classes;
@@ -145,6 +385,8 @@ public:
    }
    Program copy_Program();
    void dump(ostream& stream, int n);
+   int Serialize(ASTWriter &w);
+   Classes GetClasses() { return classes; }
 
 #ifdef Program_SHARED_EXTRAS
    Program_SHARED_EXTRAS
@@ -171,6 +413,7 @@ public:
    }
    Class_ copy_Class_();
    void dump(ostream& stream, int n);
+   int Serialize(ASTWriter &w);
 
    Symbol GetName() { return name; }
    Symbol GetParent() { return parent; }
@@ -198,6 +441,7 @@ public:
       formals = a2;
       return_type = a3;
       expr = a4;
+      flat_root = -1;
    }
    Feature copy_Feature();
    void dump(ostream& stream, int n);
@@ -208,7 +452,11 @@ public:
    Formals GetFormals() { return formals; }
    Symbol GetType() { return return_type; }
    Symbol GetName() { return name; }
+   Expression GetExpr() { return expr; }
    bool IsMethod() { return true; }
+   void Flatten(FlatAST &ast);
+   int Serialize(ASTWriter &w);
+   int flat_root;   // cuerpo del método en el AST plano, -1 si no se ha aplanado
 #ifdef Feature_SHARED_EXTRAS
    Feature_SHARED_EXTRAS
 #endif
@@ -229,6 +477,7 @@ public:
       name = a1;
       type_decl = a2;
       init = a3;
+      flat_root = -1;
    }
    Feature copy_Feature();
    void dump(ostream& stream, int n);
@@ -237,7 +486,12 @@ public:
    void AddMethodToTable(Symbol class_name);
    void AddAttribToTable(Symbol class_name);
    Symbol GetName() { return name; }
+   Symbol GetTypeDecl() { return type_decl; }
+   Expression GetInit() { return init; }
    bool IsMethod() { return false; }
+   void Flatten(FlatAST &ast);
+   int Serialize(ASTWriter &w);
+   int flat_root;   // inicialización en el AST plano, -1 si no se ha aplanado
 #ifdef Feature_SHARED_EXTRAS
    Feature_SHARED_EXTRAS
 #endif
@@ -259,6 +513,7 @@ public:
    }
    Formal copy_Formal();
    void dump(ostream& stream, int n);
+   int Serialize(ASTWriter &w);
    Symbol GetName() { return name; }
    Symbol GetType() { return type_decl; }
 #ifdef Formal_SHARED_EXTRAS
@@ -284,8 +539,10 @@ public:
    }
    Case copy_Case();
    void dump(ostream& stream, int n);
-   Symbol CheckBranchType();
+   Symbol GetName() { return name; }
    Symbol GetTypeDecl() { return type_decl; }
+   Expression GetExpr() { return expr; }
+   int Serialize(ASTWriter &w);
 #ifdef Case_SHARED_EXTRAS
    Case_SHARED_EXTRAS
 #endif
@@ -307,7 +564,11 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-   Symbol CheckExprType();
+   int NumChildren() { return 1; }
+   Expression Child(int i) { return expr; }
+   Symbol CheckExprType(TypeFrame &f, Symbol *types);
+   void DumpEnter(ostream &stream, int n);
+   int Serialize(ASTWriter &w);
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
 #endif
@@ -333,7 +594,14 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-   Symbol CheckExprType();
+   int NumChildren() { return 1 + actual->len(); }
+   Expression Child(int i) { return i == 0 ? expr : actual->nth(i - 1); }
+   void CheckChild(TypeFrame &f, int i, Symbol type);
+   Symbol CheckExprType(TypeFrame &f, Symbol *types);
+   void DumpEnter(ostream &stream, int n);
+   int DumpChild(ostream &stream, int n, int i);
+   void DumpExit(ostream &stream, int n);
+   int Serialize(ASTWriter &w);
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
 #endif
@@ -357,7 +625,14 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-   Symbol CheckExprType();
+   int NumChildren() { return 1 + actual->len(); }
+   Expression Child(int i) { return i == 0 ? expr : actual->nth(i - 1); }
+   void CheckChild(TypeFrame &f, int i, Symbol type);
+   Symbol CheckExprType(TypeFrame &f, Symbol *types);
+   void DumpEnter(ostream &stream, int n);
+   int DumpChild(ostream &stream, int n, int i);
+   void DumpExit(ostream &stream, int n);
+   int Serialize(ASTWriter &w);
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
 #endif
@@ -381,7 +656,12 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-   Symbol CheckExprType();
+   int NumChildren() { return 3; }
+   Expression Child(int i) { return i == 0 ? pred : i == 1 ? then_exp : else_exp; }
+   void CheckChild(TypeFrame &f, int i, Symbol type);
+   Symbol CheckExprType(TypeFrame &f, Symbol *types);
+   void DumpEnter(ostream &stream, int n);
+   int Serialize(ASTWriter &w);
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
 #endif
@@ -403,7 +683,12 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-   Symbol CheckExprType();
+   int NumChildren() { return 2; }
+   Expression Child(int i) { return i == 0 ? pred : body; }
+   void CheckChild(TypeFrame &f, int i, Symbol type);
+   Symbol CheckExprType(TypeFrame &f, Symbol *types);
+   void DumpEnter(ostream &stream, int n);
+   int Serialize(ASTWriter &w);
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
 #endif
@@ -425,7 +710,13 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-   Symbol CheckExprType();
+   int NumChildren() { return 1 + cases->len(); }
+   Expression Child(int i) { return i == 0 ? expr : ((branch_class *) cases->nth(i - 1))->GetExpr(); }
+   void CheckChild(TypeFrame &f, int i, Symbol type);
+   Symbol CheckExprType(TypeFrame &f, Symbol *types);
+   void DumpEnter(ostream &stream, int n);
+   int DumpChild(ostream &stream, int n, int i);
+   int Serialize(ASTWriter &w);
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
 #endif
@@ -445,7 +736,11 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-   Symbol CheckExprType();
+   int NumChildren() { return body->len(); }
+   Expression Child(int i) { return body->nth(i); }
+   Symbol CheckExprType(TypeFrame &f, Symbol *types);
+   void DumpEnter(ostream &stream, int n);
+   int Serialize(ASTWriter &w);
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
 #endif
@@ -471,7 +766,13 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-   Symbol CheckExprType();
+   int NumChildren() { return 2; }
+   Expression Child(int i) { return i == 0 ? init : body; }
+   void CheckEnter(TypeFrame &f);
+   void CheckChild(TypeFrame &f, int i, Symbol type);
+   Symbol CheckExprType(TypeFrame &f, Symbol *types);
+   void DumpEnter(ostream &stream, int n);
+   int Serialize(ASTWriter &w);
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
 #endif
@@ -493,7 +794,11 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-   Symbol CheckExprType();
+   int NumChildren() { return 2; }
+   Expression Child(int i) { return i == 0 ? e1 : e2; }
+   Symbol CheckExprType(TypeFrame &f, Symbol *types);
+   void DumpEnter(ostream &stream, int n);
+   int Serialize(ASTWriter &w);
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
 #endif
@@ -515,7 +820,11 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-   Symbol CheckExprType();
+   int NumChildren() { return 2; }
+   Expression Child(int i) { return i == 0 ? e1 : e2; }
+   Symbol CheckExprType(TypeFrame &f, Symbol *types);
+   void DumpEnter(ostream &stream, int n);
+   int Serialize(ASTWriter &w);
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
 #endif
@@ -537,7 +846,11 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-   Symbol CheckExprType();
+   int NumChildren() { return 2; }
+   Expression Child(int i) { return i == 0 ? e1 : e2; }
+   Symbol CheckExprType(TypeFrame &f, Symbol *types);
+   void DumpEnter(ostream &stream, int n);
+   int Serialize(ASTWriter &w);
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
 #endif
@@ -559,7 +872,11 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-   Symbol CheckExprType();
+   int NumChildren() { return 2; }
+   Expression Child(int i) { return i == 0 ? e1 : e2; }
+   Symbol CheckExprType(TypeFrame &f, Symbol *types);
+   void DumpEnter(ostream &stream, int n);
+   int Serialize(ASTWriter &w);
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
 #endif
@@ -579,7 +896,11 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-   Symbol CheckExprType();
+   int NumChildren() { return 1; }
+   Expression Child(int i) { return e1; }
+   Symbol CheckExprType(TypeFrame &f, Symbol *types);
+   void DumpEnter(ostream &stream, int n);
+   int Serialize(ASTWriter &w);
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
 #endif
@@ -601,7 +922,11 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-   Symbol CheckExprType();
+   int NumChildren() { return 2; }
+   Expression Child(int i) { return i == 0 ? e1 : e2; }
+   Symbol CheckExprType(TypeFrame &f, Symbol *types);
+   void DumpEnter(ostream &stream, int n);
+   int Serialize(ASTWriter &w);
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
 #endif
@@ -623,7 +948,11 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-   Symbol CheckExprType();
+   int NumChildren() { return 2; }
+   Expression Child(int i) { return i == 0 ? e1 : e2; }
+   Symbol CheckExprType(TypeFrame &f, Symbol *types);
+   void DumpEnter(ostream &stream, int n);
+   int Serialize(ASTWriter &w);
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
 #endif
@@ -645,7 +974,11 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-   Symbol CheckExprType();
+   int NumChildren() { return 2; }
+   Expression Child(int i) { return i == 0 ? e1 : e2; }
+   Symbol CheckExprType(TypeFrame &f, Symbol *types);
+   void DumpEnter(ostream &stream, int n);
+   int Serialize(ASTWriter &w);
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
 #endif
@@ -665,7 +998,11 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-   Symbol CheckExprType();
+   int NumChildren() { return 1; }
+   Expression Child(int i) { return e1; }
+   Symbol CheckExprType(TypeFrame &f, Symbol *types);
+   void DumpEnter(ostream &stream, int n);
+   int Serialize(ASTWriter &w);
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
 #endif
@@ -685,7 +1022,11 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-   Symbol CheckExprType();
+   int NumChildren() { return 0; }
+   Expression Child(int i) { return NULL; }
+   Symbol CheckExprType(TypeFrame &f, Symbol *types);
+   void DumpEnter(ostream &stream, int n);
+   int Serialize(ASTWriter &w);
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
 #endif
@@ -705,7 +1046,11 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-   Symbol CheckExprType();
+   int NumChildren() { return 0; }
+   Expression Child(int i) { return NULL; }
+   Symbol CheckExprType(TypeFrame &f, Symbol *types);
+   void DumpEnter(ostream &stream, int n);
+   int Serialize(ASTWriter &w);
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
 #endif
@@ -725,7 +1070,11 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-   Symbol CheckExprType();
+   int NumChildren() { return 0; }
+   Expression Child(int i) { return NULL; }
+   Symbol CheckExprType(TypeFrame &f, Symbol *types);
+   void DumpEnter(ostream &stream, int n);
+   int Serialize(ASTWriter &w);
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
 #endif
@@ -745,7 +1094,11 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-   Symbol CheckExprType();
+   int NumChildren() { return 0; }
+   Expression Child(int i) { return NULL; }
+   Symbol CheckExprType(TypeFrame &f, Symbol *types);
+   void DumpEnter(ostream &stream, int n);
+   int Serialize(ASTWriter &w);
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
 #endif
@@ -765,7 +1118,11 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-   Symbol CheckExprType();
+   int NumChildren() { return 1; }
+   Expression Child(int i) { return e1; }
+   Symbol CheckExprType(TypeFrame &f, Symbol *types);
+   void DumpEnter(ostream &stream, int n);
+   int Serialize(ASTWriter &w);
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
 #endif
@@ -783,7 +1140,11 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-   Symbol CheckExprType();
+   int NumChildren() { return 0; }
+   Expression Child(int i) { return NULL; }
+   Symbol CheckExprType(TypeFrame &f, Symbol *types);
+   void DumpEnter(ostream &stream, int n);
+   int Serialize(ASTWriter &w);
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
 #endif
@@ -803,7 +1164,11 @@ public:
    }
    Expression copy_Expression();
    void dump(ostream& stream, int n);
-   Symbol CheckExprType();
+   int NumChildren() { return 0; }
+   Expression Child(int i) { return NULL; }
+   Symbol CheckExprType(TypeFrame &f, Symbol *types);
+   void DumpEnter(ostream &stream, int n);
+   int Serialize(ASTWriter &w);
 #ifdef Expression_SHARED_EXTRAS
    Expression_SHARED_EXTRAS
 #endif
@@ -0,0 +1,43 @@
+/*  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+ *  Programa principal de semant que puede leer el AST en formato binario.
+ *
+ *  Se enlaza en lugar de semant-phase.o.  Hace lo mismo que el de la
+ *  distribución (leer el AST, semant() y dump_with_types), pero si
+ *  COOL_AST_IN nombra un archivo escrito por el parser con COOL_AST_OUT,
+ *  lo abre con ASTView en lugar de leer el volcado de texto de stdin:
+ *
+ *      COOL_AST_OUT=f.ast ../lab02C++/parser f.cl > /dev/null
+ *      COOL_AST_IN=f.ast ./semant f.cl
+ *
+ *  El lector de texto (ast-parse) es un parser de bison con pila de
+ *  profundidad fija, así que no acepta árboles de miles de niveles; el
+ *  binario se lee sin recursión.
+ */
+#include <stdlib.h>
+#include "cool-tree.h"
+#include "ast-binary.h"
+
+extern Program ast_root;
+extern int ast_yyparse(void);
+extern void handle_flags(int argc, char *argv[]);
+
+int main(int argc, char *argv[])
+{
+    handle_flags(argc, argv);
+
+    const char *in = getenv(AST_BINARY_IN_ENV);
+    if (in != NULL) {
+        ASTView view;
+        if (!view.Open(in)) {
+            cerr << "Cannot read the binary AST in " << in << endl;
+            exit(1);
+        }
+        ast_root = view.Build();
+    } else {
+        ast_yyparse();
+    }
+
+    ast_root->semant();
+    ast_root->dump_with_types(cout, 0);
+    return 0;
+}
@@ -1,6 +1,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <time.h>
 #include <vector>
 #include <list>
 #include <set>
@@ -8,6 +9,8 @@
 #include <string>
 #include <cstring>
 #include "semant.h"
+#include "ast-binary.h"
+#include "ast-visitor.h"
 #include "utilities.h"
 
 static bool TESTING = false;
@@ -17,6 +20,7 @@ static std::ostream &log = TESTING ? std::cout : nop_sstream;
 
 extern int semant_debug;
 extern char *curr_filename;
+extern Program ast_root;
 
 //////////////////////////////////////////////////////////////////////
 //
@@ -95,6 +99,12 @@ typedef SymbolTable<Symbol, method_class> MethodTable;
 // Se usa para almacenar y consultar métodos definidos en cada clase, validando herencia y sobreescritura.
 static std::map<Symbol, MethodTable> methodtables;
 
+// AST plano del programa (ver semant.h).  Si no es NULL, CheckFeatureType
+// chequea los tipos sobre él en lugar de recorrer los punteros del AST.
+static FlatAST* flat_ast = NULL;
+
+SemantTiming semant_timing;
+
 //Partes extraídas de: https://github.com/skyzluo/CS143-Compilers-Stanford
 //
 // Initializing the predefined symbols.
@@ -529,7 +539,9 @@ ostream& ClassTable::semant_error()
 
 void method_class::AddMethodToTable(Symbol class_name) {
     log << "    Adding method " << name << std::endl;
-    methodtables[class_name].addid(name, new method_class(copy_Symbol(name), formals->copy_list(), copy_Symbol(return_type), expr->copy_Expression()));
+    // La tabla sólo consulta los formales y el tipo de retorno, así que
+    // guarda el mismo nodo en vez de una copia de todo el cuerpo
+    methodtables[class_name].addid(name, this);
 }
 
 void method_class::AddAttribToTable(Symbol class_name) { }
@@ -554,6 +566,47 @@ void attr_class::AddAttribToTable(Symbol class_name) {
 // Type checking functions
 ///////////////////////////////////////////////////////////////////
 // EN ESTO DEFINIMOS LAS FUNCIONES PARA VERIFICAR LOS TIPOS DE CADA EXPRESIÓN
+//
+// Las expresiones se chequean con ast_walk (ver ast-visitor.h) en lugar de
+// que cada una llame a sus hijos: el código generado puede tener miles de
+// niveles de anidamiento y la recursión se quedaba sin pila.  TypeChecker
+// guarda en su pila el tipo de cada hijo ya chequeado y el TypeFrame de
+// cada expresión abierta, y le pasa ambos a los métodos de cada clase.
+
+class TypeChecker : public ASTVisitor {
+public:
+    Symbol result;
+
+    void Pre(Expression e) {
+        TypeFrame f;
+        f.base = types.size();
+        f.method = NULL;
+        f.error = false;
+        frames.push_back(f);
+        e->CheckEnter(frames.back());
+    }
+    void AfterChild(Expression e, int i) {
+        e->CheckChild(frames.back(), i, types.back());
+    }
+    void Post(Expression e) {
+        TypeFrame &f = frames.back();
+        Symbol type = e->CheckExprType(f, types.data() + f.base);
+        types.resize(f.base);
+        types.push_back(type);
+        frames.pop_back();
+        result = type;
+    }
+
+private:
+    std::vector<Symbol> types;       // tipos de los hijos ya chequeados
+    std::vector<TypeFrame> frames;   // una por expresión abierta
+};
+
+static Symbol CheckExprType(Expression e) {
+    TypeChecker checker;
+    ast_walk(e, checker);
+    return checker.result;
+}
 
 void method_class::CheckFeatureType() {
     // Imprime en el log que se está verificando el método actual
@@ -602,7 +655,7 @@ void method_class::CheckFeatureType() {
     }
     
     // Obtiene el tipo de la expresión de retorno del método
-    Symbol expr_type = expr->CheckExprType();
+    Symbol expr_type = flat_ast != NULL ? flat_ast->CheckExprType(flat_root) : CheckExprType(expr);
 
     // Verifica que el tipo de retorno del método sea un ancestro válido del tipo de la expresión
     if (classtable->CheckInheritance(return_type, expr_type) == false) {
@@ -619,18 +672,19 @@ void attr_class::CheckFeatureType() {
     log << "    Checking attribute \"" << name << "\"" << std::endl;
 
     // Verifica si la expresión de asignación tiene tipo No_type (no está inicializada)
-    if (init->CheckExprType() == No_type) {
+    Symbol init_type = flat_ast != NULL ? flat_ast->CheckExprType(flat_root) : CheckExprType(init);
+    if (init_type == No_type) {
         log << "NO INIT!" << std::endl;
     }
 }
 
 
-Symbol assign_class::CheckExprType() { 
+Symbol assign_class::CheckExprType(TypeFrame &f, Symbol *types) { 
     // Busca el tipo de la variable en la tabla de atributos
     Symbol* lvalue_type = attribtable.lookup(name);
 
-    // Obtiene el tipo de la expresión del lado derecho
-    Symbol rvalue_type = expr->CheckExprType();
+    // Tipo de la expresión del lado derecho
+    Symbol rvalue_type = types[0];
 
     // Verifica si la variable existe en la tabla de atributos
     if (lvalue_type == NULL) {
@@ -657,17 +711,56 @@ Symbol assign_class::CheckExprType() {
     type = rvalue_type;
     return type;
 }
+
+// Busca name en la jerarquía de herencia de type, desde la clase más
+// cercana.  Devuelve NULL si ninguna clase lo define.
+static method_class *LookupMethod(Symbol type, Symbol name) {
+    std::list<Symbol> path = classtable->GetInheritancePath(type);
+    method_class* method = NULL;
+
+    for (std::list<Symbol>::iterator iter = path.begin(); iter != path.end(); ++iter) {
+        log << "Looking for method in class " << *iter << std::endl;
+
+        // Busca el método en la tabla de métodos de la clase actual en la jerarquía
+        if ((method = methodtables[*iter].lookup(name)) != NULL) {
+            break;  // Si se encuentra el método, se detiene la búsqueda
+        }
+    }
+    return method;
+}
+
+// Verifica el argumento i (desde 0) de una llamada contra el formal del
+// método, si se encontró
+static void CheckActual(TypeFrame &f, int i, Symbol actual_type) {
+    // Como el parser sigue, solo ejecutamos si encontramos el método
+    if (f.method != NULL) {
+        // Obtenemos el tipo del formal en la posición actual
+        Symbol formal_type = f.method->GetFormals()->nth(i)->GetType();
+
+        // Verifica que el tipo del argumento sea un subtipo del tipo esperado
+        if (classtable->CheckInheritance(formal_type, actual_type) == false) {
+            classtable->semant_error(curr_class) 
+                << "Error! Actual type " << actual_type 
+                << " doesn't suit formal type " << formal_type << std::endl;
+            f.error = true;
+        }
+    }
+}
+
 //(obj@Clase).metodo(param1, param2, ...)
-Symbol static_dispatch_class::CheckExprType() {
-    // Variable para rastrear si se encuentra algún error
-    bool error = false;
+// El hijo 0 es obj; los demás, los parámetros.
+void static_dispatch_class::CheckChild(TypeFrame &f, int i, Symbol type) {
+    if (i > 0) {
+        CheckActual(f, i - 1, type);
+        return;
+    }
 
-    // Arroja el tipo sobre el que llamamos el método (obj) 
-    Symbol expr_class = expr->CheckExprType();
+    // type es el tipo sobre el que llamamos el método (obj) 
+    Symbol expr_class = type;
 
     // Verifica que el type_name (Clase) sea ancestro de expr_class (obj)
     if (classtable->CheckInheritance(type_name, expr_class) == false) {
-        error = true;
+        f.error = true;
         classtable->semant_error(curr_class) 
             << "Error! Static dispatch class is not an ancestor." << std::endl;
     }
@@ -676,51 +769,23 @@ Symbol static_dispatch_class::CheckExprType() {
 
     // Busca el método en la jerarquía de herencia
     // Se recorre el camino de herencia de type_name (Class) para encontrar la definición del método
-    std::list<Symbol> path = classtable->GetInheritancePath(type_name);
-    method_class* method = NULL;
-
-    for (std::list<Symbol>::iterator iter = path.begin(); iter != path.end(); ++iter) {
-        log << "Looking for method in class " << *iter << std::endl;
-
-        // Busca el método en la tabla de métodos de la clase actual en la jerarquía
-        if ((method = methodtables[*iter].lookup(name)) != NULL) {
-            break;  // Si se encuentra el método, se detiene la búsqueda
-        }
-    }
+    f.method = LookupMethod(type_name, name);
 
     // Si no se encuentra el método en la jerarquía de herencia, se genera un error
-    if (method == NULL) {
-        error = true;
+    if (f.method == NULL) {
+        f.error = true;
         classtable->semant_error(curr_class) 
             << "Error! Cannot find method '" << name << "'" << std::endl;
     }
+}
 
-    // Verificación de los parámetros pasados al método
-    for (int i = actual->first(); actual->more(i); i = actual->next(i)) {
-        // Obtiene el tipo del parámetro de la iteración
-        Symbol actual_type = actual->nth(i)->CheckExprType();
-
-        // Como el parser sigue, solo ejecutamos si encontramos el método
-        if (method != NULL) {
-            // Obtenemos el tipo del formal en la posición actual
-            Symbol formal_type = method->GetFormals()->nth(i)->GetType();
-
-            // Verifica que el tipo del argumento sea un subtipo del tipo esperado
-            if (classtable->CheckInheritance(formal_type, actual_type) == false) {
-                classtable->semant_error(curr_class) 
-                    << "Error! Actual type " << actual_type 
-                    << " doesn't suit formal type " << formal_type << std::endl;
-                error = true;
-            }
-        }
-    }
-
+Symbol static_dispatch_class::CheckExprType(TypeFrame &f, Symbol *types) {
     // Si hubo errores, se asigna Object como tipo de retorno para evitar problemas
-    if (error) {
+    if (f.error) {
         type = Object;
     } else {
         // Si no hay errores, el tipo de la expresión es el tipo de retorno del método
-        type = method->GetType();
+        type = f.method->GetType();
 
         // Si el método retorna SELF_TYPE, se reemplaza por la clase sobre la que se hizo dispatch
         if (type == SELF_TYPE) {
@@ -732,12 +797,14 @@ Symbol static_dispatch_class::CheckExprType() {
 }
 
 //obj.metodo(param1, param2, ...)
-Symbol dispatch_class::CheckExprType() {
-    // Variable para rastrear si hay errores durante la verificación del dispatch
-    bool error = false;
+void dispatch_class::CheckChild(TypeFrame &f, int i, Symbol type) {
+    if (i > 0) {
+        CheckActual(f, i - 1, type);
+        return;
+    }
 
-    // Arroja el tipo sobre el que llamamos el método
-    Symbol expr_type = expr->CheckExprType();
+    // type es el tipo sobre el que llamamos el método
+    Symbol expr_type = type;
 
     // Si el tipo de la expresión es SELF_TYPE, se imprime en el log con el nombre de la clase actual
     if (expr_type == SELF_TYPE) {
@@ -748,56 +815,27 @@ Symbol dispatch_class::CheckExprType() {
 
     // Busca el método en la jerarquía de herencia de la clase del objeto en el dispatch
     // Se busca la definición del método en la clase más cercana posible en la jerarquía
-    std::list<Symbol> path = classtable->GetInheritancePath(expr_type);
-    method_class* method = NULL;
-
-    // Se recorre la jerarquía de herencia para encontrar el método
-    for (std::list<Symbol>::iterator iter = path.begin(); iter != path.end(); ++iter) {
-        log << "Looking for method in class " << *iter << std::endl;
-
-        // Busca el método en la tabla de métodos de la clase actual de la jerarquía
-        if ((method = methodtables[*iter].lookup(name)) != NULL) {
-            break; // Si encuentra el método, se detiene la búsqueda
-        }
-    }
+    f.method = LookupMethod(expr_type, name);
 
     // Si el método no se encuentra en ninguna clase de la jerarquía, se genera un error
-    if (method == NULL) {
-        error = true;
+    if (f.method == NULL) {
+        f.error = true;
         classtable->semant_error(curr_class) 
             << "Error! Cannot find method '" << name << "'" << std::endl;
     }
+}
 
-    // Verificación de los parámetros de la llamada al método
-    for (int i = actual->first(); actual->more(i); i = actual->next(i)) {
-        // Se obtiene el tipo del argumento pasado en la llamada al método
-        Symbol actual_type = actual->nth(i)->CheckExprType();
-
-        // Solo se realiza la verificación si el método fue encontrado
-        if (method != NULL) {
-            // Se obtiene el tipo esperado del parámetro en la declaración del método
-            Symbol formal_type = method->GetFormals()->nth(i)->GetType();
-
-            // Se verifica que el argumento pasado sea un subtipo válido del parámetro esperado
-            if (classtable->CheckInheritance(formal_type, actual_type) == false) {
-                classtable->semant_error(curr_class) 
-                    << "Error! Actual type " << actual_type 
-                    << " doesn't suit formal type " << formal_type << std::endl;
-                error = true;
-            }
-        }
-    }
-
+Symbol dispatch_class::CheckExprType(TypeFrame &f, Symbol *types) {
     // Si hubo errores en el dispatch, se asigna Object como tipo de retorno para evitar problemas
-    if (error) {
+    if (f.error) {
         type = Object;
     } else {
         // Si no hubo errores, el tipo de la expresión será el tipo de retorno del método
-        type = method->GetType();
+        type = f.method->GetType();
 
         // Si el método retorna SELF_TYPE, se reemplaza por el tipo de la expresión original
         if (type == SELF_TYPE) {
-            type = expr_type;
+            type = types[0];
         }
     }
 
@@ -811,15 +849,17 @@ Symbol dispatch_class::CheckExprType() {
 // Expression then_exp;
 // Expression else_exp;
 // 
-Symbol cond_class::CheckExprType() {
+void cond_class::CheckChild(TypeFrame &f, int i, Symbol type) {
     //Si el predicado del condicional no es booleano, retorna error
-    if (pred->CheckExprType() != Bool) {
+    if (i == 0 && type != Bool) {
         classtable->semant_error(curr_class) << "Error! Type of pred is not Bool." << std::endl;
     }
+}
 
+Symbol cond_class::CheckExprType(TypeFrame &f, Symbol *types) {
     //Miramos el tipo de las expresiones en el then y en el else
-    Symbol then_type = then_exp->CheckExprType();
-    Symbol else_type = else_exp->CheckExprType();
+    Symbol then_type = types[1];
+    Symbol else_type = types[2];
 
     if (else_type == No_type) {
         // Si no hay un else, el tipo del condicional es el del then
@@ -831,13 +871,14 @@ Symbol cond_class::CheckExprType() {
     return type;
 }
 
-Symbol loop_class::CheckExprType() {
+void loop_class::CheckChild(TypeFrame &f, int i, Symbol type) {
     //Si el predicado del condicional no es booleano, retorna error
-    if (pred->CheckExprType() != Bool) {
+    if (i == 0 && type != Bool) {
         classtable->semant_error(curr_class) << "Error! Type of pred is not Bool." << std::endl;
     }
-    //Miramos el tipo de la expresión del cuerpo
-    body->CheckExprType();
+}
+
+Symbol loop_class::CheckExprType(TypeFrame &f, Symbol *types) {
     type = Object;
     return type;
 }
@@ -847,22 +888,27 @@ Symbol loop_class::CheckExprType() {
 // Expression expr;
 // Cases cases;
 // 
-Symbol typcase_class::CheckExprType() {
-    //Obtener el tipo de la expresión que evalúa el case
-    Symbol expr_type = expr->CheckExprType();
+// El hijo 0 es expr y el hijo i es el cuerpo de la rama i - 1.  Cada rama
+// tiene su propio scope con la variable declarada: se abre al terminar el
+// hijo anterior y se cierra al terminar su cuerpo.
+void typcase_class::CheckChild(TypeFrame &f, int i, Symbol type) {
+    if (i > 0) {
+        attribtable.exitscope();
+    }
+    if (i < cases->len()) {
+        branch_class *branch = (branch_class *) cases->nth(i);
+        attribtable.enterscope();
+        attribtable.addid(branch->GetName(), new Symbol(branch->GetTypeDecl()));
+    }
+}
 
-    Case branch;
+Symbol typcase_class::CheckExprType(TypeFrame &f, Symbol *types) {
     //Almacena los retornos de cada rama
-    std::vector<Symbol> branch_types;
+    std::vector<Symbol> branch_types(types + 1, types + 1 + cases->len());
     //Almacena los tipos declarados en cada rama
     std::vector<Symbol> branch_type_decls;
-
-    //Recorrer cada rama, obtener el retorno de cada rama, obtener el retorno de la declaración
     for (int i = cases->first(); cases->more(i); i = cases->next(i)) {
-        branch = cases->nth(i);
-        Symbol branch_type = branch->CheckBranchType();
-        branch_types.push_back(branch_type);
-        branch_type_decls.push_back(((branch_class *)branch)->GetTypeDecl());
+        branch_type_decls.push_back(((branch_class *)cases->nth(i))->GetTypeDecl());
     }
     //Verificar que no haya tipos duplicados en las ramas
     // case x of
@@ -884,27 +930,10 @@ Symbol typcase_class::CheckExprType() {
     return type;
 }
 
-// branch
-// ======
-// Symbol name;
-// Symbol type_decl;
-// Expression expr;
-// 
-Symbol branch_class::CheckBranchType() {
-    attribtable.enterscope();
-
-    attribtable.addid(name, new Symbol(type_decl));
-    Symbol type = expr->CheckExprType();
-
-    attribtable.exitscope();
-
-    return type;
-}
-
 //Obtiene el tipo de la última expresión en el bloque
-Symbol block_class::CheckExprType() {
-    for (int i = body->first(); body->more(i); i = body->next(i)) {
-        type = body->nth(i)->CheckExprType();
+Symbol block_class::CheckExprType(TypeFrame &f, Symbol *types) {
+    if (body->len() > 0) {
+        type = types[body->len() - 1];
     }
     return type;
 }
@@ -916,7 +945,7 @@ Symbol block_class::CheckExprType() {
 // Expression init;
 // Expression body;
 // 
-Symbol let_class::CheckExprType() {
+void let_class::CheckEnter(TypeFrame &f) {
     // Verifica que el identificador no sea 'self', ya que 'self' no puede ser redefinido
     if (identifier == self) {
         classtable->semant_error(curr_class) << "Error! self in let binding." << std::endl;
@@ -927,19 +956,20 @@ Symbol let_class::CheckExprType() {
 
     // Agrega la variable a la tabla de atributos con su tipo declarado
     attribtable.addid(identifier, new Symbol(type_decl));
+}
 
-    // Obtiene el tipo de la expresión de inicialización (si existe)
-    Symbol init_type = init->CheckExprType();
-
+void let_class::CheckChild(TypeFrame &f, int i, Symbol type) {
     // Si hay una expresión de inicialización, verifica que sea un subtipo válido
-    if (init_type != No_type) {
-        if (classtable->CheckInheritance(type_decl, init_type) == false) {
+    if (i == 0 && type != No_type) {
+        if (classtable->CheckInheritance(type_decl, type) == false) {
             classtable->semant_error(curr_class) << "Error! init value is not child." << std::endl;
         }
     }
+}
 
-    // Evalúa el tipo del cuerpo del 'let'
-    type = body->CheckExprType();
+Symbol let_class::CheckExprType(TypeFrame &f, Symbol *types) {
+    // El tipo del 'let' es el de su cuerpo
+    type = types[1];
 
     // Sale del scope del 'let', eliminando la variable de la tabla de atributos
     attribtable.exitscope();
@@ -947,57 +977,37 @@ Symbol let_class::CheckExprType() {
     return type;
 }
 
-
-Symbol plus_class::CheckExprType() {
-    Symbol e1_type = e1->CheckExprType();
-    Symbol e2_type = e2->CheckExprType();
-    if (e1_type != Int || e2_type != Int) {
-        classtable->semant_error(curr_class) << "Error! '+' meets non-Int value." << std::endl;
-        type = Object;
-    } else {
-        type = Int;
+// Operaciones aritméticas: ambos operandos deben ser Int
+static Symbol CheckArith(Symbol *types, const char *op) {
+    if (types[0] != Int || types[1] != Int) {
+        classtable->semant_error(curr_class) << "Error! '" << op << "' meets non-Int value." << std::endl;
+        return Object;
     }
+    return Int;
+}
+
+Symbol plus_class::CheckExprType(TypeFrame &f, Symbol *types) {
+    type = CheckArith(types, "+");
     return type;
 }
 
-Symbol sub_class::CheckExprType() {
-    Symbol e1_type = e1->CheckExprType();
-    Symbol e2_type = e2->CheckExprType();
-    if (e1_type != Int || e2_type != Int) {
-        classtable->semant_error(curr_class) << "Error! '-' meets non-Int value." << std::endl;
-        type = Object;
-    } else {
-        type = Int;
-    }
+Symbol sub_class::CheckExprType(TypeFrame &f, Symbol *types) {
+    type = CheckArith(types, "-");
     return type;
 }
 
-Symbol mul_class::CheckExprType() {
-    Symbol e1_type = e1->CheckExprType();
-    Symbol e2_type = e2->CheckExprType();
-    if (e1_type != Int || e2_type != Int) {
-        classtable->semant_error(curr_class) << "Error! '*' meets non-Int value." << std::endl;
-        type = Object;
-    } else {
-        type = Int;
-    }
+Symbol mul_class::CheckExprType(TypeFrame &f, Symbol *types) {
+    type = CheckArith(types, "*");
     return type;
 }
 
-Symbol divide_class::CheckExprType() {
-    Symbol e1_type = e1->CheckExprType();
-    Symbol e2_type = e2->CheckExprType();
-    if (e1_type != Int || e2_type != Int) {
-        classtable->semant_error(curr_class) << "Error! '/' meets non-Int value." << std::endl;
-        type = Object;
-    } else {
-        type = Int;
-    }
+Symbol divide_class::CheckExprType(TypeFrame &f, Symbol *types) {
+    type = CheckArith(types, "/");
     return type;
 }
 //Negación por bits
-Symbol neg_class::CheckExprType() {
-    if (e1->CheckExprType() != Int) {
+Symbol neg_class::CheckExprType(TypeFrame &f, Symbol *types) {
+    if (types[0] != Int) {
         classtable->semant_error(curr_class) << "Error! '~' meets non-Int value." << std::endl;
         type = Object;
     } else {
@@ -1006,10 +1016,8 @@ Symbol neg_class::CheckExprType() {
     return type;
 }
 
-Symbol lt_class::CheckExprType() {
-    Symbol e1_type = e1->CheckExprType();
-    Symbol e2_type = e2->CheckExprType();
-    if (e1_type != Int || e2_type != Int) {
+Symbol lt_class::CheckExprType(TypeFrame &f, Symbol *types) {
+    if (types[0] != Int || types[1] != Int) {
         classtable->semant_error(curr_class) << "Error! '<' meets non-Int value." << std::endl;
         type = Object;
     } else {
@@ -1022,9 +1030,9 @@ Symbol lt_class::CheckExprType() {
 // =====
 // any types may be freely compared except for Int, Bool, and Str.
 // 
-Symbol eq_class::CheckExprType() {
-    Symbol e1_type = e1->CheckExprType();
-    Symbol e2_type = e2->CheckExprType();
+Symbol eq_class::CheckExprType(TypeFrame &f, Symbol *types) {
+    Symbol e1_type = types[0];
+    Symbol e2_type = types[1];
     if (e1_type == Int || e2_type == Int || e1_type == Bool || e2_type == Bool || e1_type == Str || e2_type == Str) {
         if (e1_type != e2_type) {
             classtable->semant_error(curr_class) << "Error! '=' meets different types." << std::endl;
@@ -1038,10 +1046,8 @@ Symbol eq_class::CheckExprType() {
     return type;
 }
 
-Symbol leq_class::CheckExprType() {
-    Symbol e1_type = e1->CheckExprType();
-    Symbol e2_type = e2->CheckExprType();
-    if (e1_type != Int || e2_type != Int) {
+Symbol leq_class::CheckExprType(TypeFrame &f, Symbol *types) {
+    if (types[0] != Int || types[1] != Int) {
         classtable->semant_error(curr_class) << "Error! '<=' meets non-Int value." << std::endl;
         type = Object;
     } else {
@@ -1050,8 +1056,8 @@ Symbol leq_class::CheckExprType() {
     return type;
 }
 //Negación lógica
-Symbol comp_class::CheckExprType() {
-    if (e1->CheckExprType() != Bool) {
+Symbol comp_class::CheckExprType(TypeFrame &f, Symbol *types) {
+    if (types[0] != Bool) {
         classtable->semant_error(curr_class) << "Error! 'not' meets non-Bool value." << std::endl;
         type = Object;
     } else {
@@ -1060,22 +1066,22 @@ Symbol comp_class::CheckExprType() {
     return type;
 }
 
-Symbol int_const_class::CheckExprType() {
+Symbol int_const_class::CheckExprType(TypeFrame &f, Symbol *types) {
     type = Int;
     return type;
 }
 
-Symbol bool_const_class::CheckExprType() {
+Symbol bool_const_class::CheckExprType(TypeFrame &f, Symbol *types) {
     type = Bool;
     return type;
 }
 
-Symbol string_const_class::CheckExprType() {
+Symbol string_const_class::CheckExprType(TypeFrame &f, Symbol *types) {
     type = Str;
     return type;
 }
 
-Symbol new__class::CheckExprType() {
+Symbol new__class::CheckExprType(TypeFrame &f, Symbol *types) {
     // Verifica si la clase instanciada existe en la tabla de clases
     // Se permite SELF_TYPE sin validación adicional, ya que representa la clase actual en tiempo de ejecución
     if (type_name != SELF_TYPE && classtable->m_classes.find(type_name) == classtable->m_classes.end()) {
@@ -1088,18 +1094,17 @@ Symbol new__class::CheckExprType() {
 }
 
 
-Symbol isvoid_class::CheckExprType() {
-    e1->CheckExprType();
+Symbol isvoid_class::CheckExprType(TypeFrame &f, Symbol *types) {
     type = Bool;
     return type;
 }
 
-Symbol no_expr_class::CheckExprType() {
+Symbol no_expr_class::CheckExprType(TypeFrame &f, Symbol *types) {
     return No_type;
 }
 
 
-Symbol object_class::CheckExprType() {
+Symbol object_class::CheckExprType(TypeFrame &f, Symbol *types) {
     if (name == self) {
         type = SELF_TYPE;
         return type;
@@ -1116,6 +1121,89 @@ Symbol object_class::CheckExprType() {
     return type;
 }
 
+///////////////////////////////////////////////////////////////////
+// AST plano
+///////////////////////////////////////////////////////////////////
+// FlatBuilder numera cada expresión al llegar a ella (preorden) y reserva
+// de una vez el espacio de sus hijos en `children`; cada hijo llena su
+// lugar al ser numerado.
+
+class FlatBuilder : public ASTVisitor {
+public:
+    FlatBuilder(FlatAST &a) : ast(a), slot(-1) { }
+
+    void Pre(Expression e) {
+        int node = ast.origin.size();
+        int count = e->NumChildren();
+        if (slot >= 0) {
+            ast.children[slot] = node;
+        }
+        ast.origin.push_back(e);
+        ast.child_begin.push_back(ast.children.size());
+        ast.child_count.push_back(count);
+        ast.children.resize(ast.children.size() + count);
+        open.push_back(node);
+    }
+    void BeforeChild(Expression e, int i) {
+        slot = ast.child_begin[open.back()] + i;
+    }
+    void Post(Expression e) {
+        open.pop_back();
+    }
+
+private:
+    FlatAST &ast;
+    int slot;                 // lugar en `children` del próximo nodo
+    std::vector<int> open;    // nodos con hijos pendientes
+};
+
+int FlatAST::Add(Expression root) {
+    int node = Size();
+    FlatBuilder builder(*this);
+    ast_walk(root, builder);
+    return node;
+}
+
+// Igual que TypeChecker, pero sin pedirle los hijos a cada nodo: el
+// subárbol de root son los nodos siguientes en preorden, así que basta
+// avanzar n y cerrar cada nodo cuando ya tiene el tipo de todos sus hijos.
+Symbol FlatAST::CheckExprType(int root) {
+    std::vector<Symbol> types;       // tipos de los hijos ya chequeados
+    std::vector<TypeFrame> frames;   // una por nodo abierto
+    std::vector<int> open;
+
+    for (int n = root; ; n++) {
+        TypeFrame f;
+        f.base = types.size();
+        f.method = NULL;
+        f.error = false;
+        frames.push_back(f);
+        open.push_back(n);
+        origin[n]->CheckEnter(frames.back());
+
+        while (types.size() - frames.back().base == (size_t) child_count[open.back()]) {
+            TypeFrame &done = frames.back();
+            Symbol type = origin[open.back()]->CheckExprType(done, types.data() + done.base);
+            types.resize(done.base);
+            types.push_back(type);
+            frames.pop_back();
+            open.pop_back();
+            if (open.empty()) {
+                return type;
+            }
+            origin[open.back()]->CheckChild(frames.back(), types.size() - 1 - frames.back().base, type);
+        }
+    }
+}
+
+void method_class::Flatten(FlatAST &ast) {
+    flat_root = ast.Add(expr);
+}
+
+void attr_class::Flatten(FlatAST &ast) {
+    flat_root = ast.Add(init);
+}
+
 /*   This is the entry point to the semantic checker.
      Your checker should do the following two things:
      1) Check that the program is semantically correct
@@ -1208,6 +1296,23 @@ void program_class::semant() {
     }
 
     log << std::endl;
+
+    // Con COOL_FLAT_AST se copian todas las expresiones al AST plano antes de
+    // chequear los tipos; el chequeo recorre los arreglos en lugar de los
+    // punteros del AST.
+    clock_t start = clock();
+    flat_ast = NULL;
+    if (getenv(FLAT_AST_ENV) != NULL) {
+        flat_ast = new FlatAST();
+        for (int i = classes->first(); classes->more(i); i = classes->next(i)) {
+            Features curr_features = classes->nth(i)->GetFeatures();
+            for (int j = curr_features->first(); curr_features->more(j); j = curr_features->next(j)) {
+                curr_features->nth(j)->Flatten(*flat_ast);
+            }
+        }
+        log << "Flat AST: " << flat_ast->Size() << " nodes" << std::endl;
+    }
+    clock_t flattened = clock();
     
     //Verificamos los tipos
     log << "Now checking all the types:" << std::endl;
@@ -1248,10 +1353,37 @@ void program_class::semant() {
         log << std::endl;
     }
 
+    semant_timing.flatten = (double) (flattened - start) / CLOCKS_PER_SEC;
+    semant_timing.check = (double) (clock() - flattened) / CLOCKS_PER_SEC;
+    if (getenv(SEMANT_TIMING_ENV) != NULL) {
+        cerr << "semant: " << (flat_ast != NULL ? "flat" : "pointer") << " AST, "
+             << "flatten " << semant_timing.flatten << " s, "
+             << "type check " << semant_timing.check << " s" << endl;
+    }
+    delete flat_ast;
+    flat_ast = NULL;
+
     // Si hubo errores durante el análisis semántico, se detiene la compilación
     if (classtable->errors()) {
         cerr << "Compilation halted due to static semantic errors." << endl;
         exit(1);
     }
 
+    // El AST ya anotado con tipos, para las fases siguientes
+    if (getenv(AST_BINARY_TYPED_ENV) != NULL) {
+        ast_binary_write(this, getenv(AST_BINARY_TYPED_ENV));
+    }
+
+    // Después de semant() el driver imprime ast_root con dump_with_types,
+    // que es recursivo y no aguanta árboles profundos: se cambia por un
+    // programa con las mismas clases que se imprime con ast_dump_with_types
+    if (ast_root == this) {
+        typed_program_class *typed = new typed_program_class(classes);
+        typed->set(this);
+        ast_root = typed;
+    }
+}
+
+void typed_program_class::dump_with_types(ostream &stream, int n) {
+    ast_dump_with_types(stream, n, this);
 }
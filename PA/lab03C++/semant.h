@@ -9,6 +9,7 @@
 #include "list.h"
 #include <map>
 #include <list>
+#include <vector>
 
 #define TRUE 1
 #define FALSE 0
@@ -43,4 +44,58 @@ public:
 	std::list<Symbol> GetInheritancePath(Symbol type); //Lista de ancestros de type hasta Object
 };
 
+// Estado del chequeo de una expresión entre sus hijos (ver TypeChecker en
+// semant.cc): dónde empiezan los tipos de sus hijos en la pila y, en los
+// dispatch, el método llamado y si ya hubo un error.
+struct TypeFrame {
+	size_t base;
+	method_class *method;
+	bool error;
+};
+
+// El programa que queda en ast_root después de semant(): el mismo árbol,
+// pero dump_with_types lo imprime sin recursión (ver ast-visitor.h)
+class typed_program_class : public program_class {
+public:
+	typed_program_class(Classes a1) : program_class(a1) { }
+	void dump_with_types(ostream &stream, int n);
+};
+
+// Representación plana del AST
+// =============================
+// Alternativa al árbol de punteros para el chequeo de tipos: las
+// expresiones de cada método y atributo se numeran en preorden y los hijos
+// de cada nodo quedan contiguos en `children`, así que el chequeo avanza
+// por los arreglos en orden en lugar de pedir NumChildren()/Child() (y
+// nth() de las listas) en cada nodo.  Add() arma los arreglos con ast_walk
+// y CheckExprType(n) recorre el subárbol de n con una pila explícita y
+// aplica las mismas reglas de cada clase (CheckEnter, CheckChild y
+// CheckExprType de cool-tree.h) sobre origin, así que los errores y los
+// tipos son los mismos que con el árbol de punteros.
+#define FLAT_AST_ENV      "COOL_FLAT_AST"      // usar el AST plano en el chequeo
+#define SEMANT_TIMING_ENV "COOL_SEMANT_TIMING" // imprimir tiempos en cerr
+
+class FlatAST {
+public:
+	std::vector<int> child_begin;       // primer hijo en `children`
+	std::vector<int> child_count;
+	std::vector<int> children;
+	std::vector<Expression> origin;     // nodo del AST de punteros
+
+	int Add(Expression root);           // devuelve el nodo de root
+	int Size() { return origin.size(); }
+	int Child(int node, int i) { return children[child_begin[node] + i]; }
+
+	Symbol CheckExprType(int root);
+};
+
+// Tiempos de la última llamada a semant(), en segundos: aplanar (0 sin
+// COOL_FLAT_AST) y chequear los tipos.  Los imprime COOL_SEMANT_TIMING y
+// los usa semantbench.
+struct SemantTiming {
+	double flatten;
+	double check;
+};
+extern SemantTiming semant_timing;
+
 #endif
\ No newline at end of file
@@ -0,0 +1,203 @@
+/*  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+ *  Benchmark del chequeo de tipos: el árbol de punteros contra el AST plano
+ *  (COOL_FLAT_AST, ver semant.h).
+ *
+ *  Se enlaza igual que semant, pero en lugar de semant-phase.o, de
+ *  handle_flags.o y del lector del AST de texto (ast-lex.o, ast-parse.o),
+ *  y recibe los tamaños en miles de nodos de los programas a generar:
+ *
+ *      semantbench            programas de 10, 100 y 1000 mil nodos
+ *      semantbench 50 500     sólo 50 y 500 mil nodos
+ *
+ *  Para cada tamaño arma en memoria un programa ya parseado por cada forma
+ *  (expresiones muy anidadas, bloques largos de dispatch, muchas clases
+ *  pequeñas y cadenas largas de let) y le corre semant() dos veces sobre
+ *  el mismo árbol, una con cada representación.  Reporta el tiempo de
+ *  aplanar, el del chequeo y el total de cada una, y nodos/s.  Así ni el
+ *  lexer ni el parser entran en la medición.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include "cool-tree.h"
+#include "semant.h"
+#include "utilities.h"
+
+char *curr_filename = (char *) "<bench>";
+int semant_debug = 0;
+Program ast_root = NULL;
+
+extern int node_lineno;
+
+/* Niveles por expresión anidada, variables por let y expresiones por
+ * bloque.  Se dejan fijos para que con el tamaño crezca la cantidad de
+ * métodos y no la profundidad. */
+#define NEST_DEPTH   1000
+#define LET_LENGTH   500
+#define BLOCK_LENGTH 1000
+
+enum Shape { NEST_SHAPE, BLOCK_SHAPE, CLASS_SHAPE, LET_SHAPE, NUM_SHAPES };
+
+static const char *shape_names[NUM_SHAPES] = { "nest", "block", "classes", "let" };
+
+/* Generación de los programas
+ * =========================== */
+static Symbol id(const char *name)   { return idtable.add_string((char *) name); }
+static Expression var(const char *name) { return object(id(name)); }
+static Expression number(int n)      { return int_const(inttable.add_int(n)); }
+
+static Expressions exprs(Expression a, Expression b)
+{
+    return append_Expressions(single_Expressions(a), single_Expressions(b));
+}
+
+/* <name>(x : Int) : Int { body } */
+static Feature int_method(const char *name, Expression body)
+{
+    return method(id(name), single_Formals(formal(id("x"), id("Int"))), id("Int"), body);
+}
+
+static Class_ int_class(Symbol name, Features features)
+{
+    return class_(name, id("IO"), features, stringtable.add_string(curr_filename));
+}
+
+/* (x + (1 * (x + ... ))) con NEST_DEPTH niveles */
+static Feature gen_nest(int n)
+{
+    Expression e = number(n);
+    for (int i = NEST_DEPTH - 1; i >= 0; i--) {
+        node_lineno = 2 + i / 16;
+        Expression left = i % 2 ? var("x") : number(i);
+        e = i % 3 ? plus(left, e) : mul(left, e);
+    }
+    return int_method("nest", e);
+}
+
+/* { x <- x + i; self.get(x); ... } con BLOCK_LENGTH pares de expresiones */
+static Feature gen_block(int n)
+{
+    Expressions body = nil_Expressions();
+    for (int i = 0; i < BLOCK_LENGTH; i++) {
+        node_lineno = 2 + i;
+        Expression assign_x = assign(id("x"), plus(var("x"), number(n + i)));
+        Expression call = dispatch(object(id("self")), id("get"), single_Expressions(var("x")));
+        body = append_Expressions(body, exprs(assign_x, call));
+    }
+    return int_method("block", block(body));
+}
+
+/* get(x : Int) : Int { x } */
+static Features get_feature()
+{
+    return single_Features(int_method("get", var("x")));
+}
+
+/* Una clase pequeña con un atributo y un método */
+static Class_ gen_class(int n)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "C%d", n);
+    Feature count = attr(id("count"), id("Int"), number(n));
+    Feature get = int_method("get", plus(var("count"), var("x")));
+    return int_class(id(name), append_Features(single_Features(count), single_Features(get)));
+}
+
+/* let a0 : Int <- n, a1 : Int <- a0 + 1, ... in a<LET_LENGTH - 1> */
+static Feature gen_let(int n)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "a%d", LET_LENGTH - 1);
+    Expression e = var(name);
+    for (int i = LET_LENGTH - 1; i >= 0; i--) {
+        char prev[32];
+        snprintf(name, sizeof(name), "a%d", i);
+        snprintf(prev, sizeof(prev), "a%d", i - 1);
+        node_lineno = 2 + i;
+        Expression init = i == 0 ? number(n) : plus(var(prev), number(1));
+        e = let(id(name), id("Int"), init, e);
+    }
+    return int_method("let", e);
+}
+
+/* Arma un programa con unos target nodos de la forma pedida.  Cada método
+ * va en su propia clase Main<n> para que los nombres no se repitan; la
+ * forma de clases ya trae las suyas.  Main.main no hace nada. */
+static Program generate(Shape shape, size_t target)
+{
+    node_lineno = 1;
+    size_t start = ASTArena::num_nodes();
+    Feature main_method = method(id("main"), nil_Formals(), id("Object"), object(id("self")));
+    Classes classes = single_Classes(int_class(id("Main"), append_Features(get_feature(), single_Features(main_method))));
+
+    for (int n = 0; ASTArena::num_nodes() - start < target; n++) {
+        if (shape == CLASS_SHAPE) {
+            classes = append_Classes(classes, single_Classes(gen_class(n)));
+            continue;
+        }
+        char name[32];
+        snprintf(name, sizeof(name), "Main%d", n);
+        Feature f = shape == NEST_SHAPE ? gen_nest(n) : shape == BLOCK_SHAPE ? gen_block(n) : gen_let(n);
+        // hereda de Main para que self.get(...) exista
+        Class_ c = class_(id(name), id("Main"), append_Features(get_feature(), single_Features(f)),
+                          stringtable.add_string(curr_filename));
+        classes = append_Classes(classes, single_Classes(c));
+    }
+    return program(classes);
+}
+
+static double now()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/* Corre semant() sobre program con una representación e imprime una fila */
+static void check(Program program, Shape shape, int thousands, size_t nodes, bool flat)
+{
+    if (flat)
+        setenv(FLAT_AST_ENV, "1", 1);
+    else
+        unsetenv(FLAT_AST_ENV);
+
+    double start = now();
+    program->semant();   // sale del programa si hay errores
+    double elapsed = now() - start;
+
+    printf("%-8s %6dk  %-7s  %9lu nodos  aplanar %7.3f s  chequeo %7.3f s  total %7.3f s  %12.0f nodos/s\n",
+           shape_names[shape], thousands, flat ? "plano" : "puntero", (unsigned long) nodes,
+           semant_timing.flatten, semant_timing.check, elapsed, nodes / elapsed);
+}
+
+static void run(Shape shape, int thousands)
+{
+    size_t before = ASTArena::num_nodes();
+    Program program = generate(shape, (size_t) thousands * 1000);
+    size_t nodes = ASTArena::num_nodes() - before;
+
+    // Primero una vuelta sin medir para que ambas encuentren las tablas de
+    // símbolos y el heap en el mismo estado
+    unsetenv(FLAT_AST_ENV);
+    program->semant();
+    check(program, shape, thousands, nodes, false);
+    check(program, shape, thousands, nodes, true);
+}
+
+int main(int argc, char **argv)
+{
+    int sizes[16], num_sizes = 0;
+    for (int i = 1; i < argc && num_sizes < 16; i++)
+        sizes[num_sizes++] = atoi(argv[i]);
+    if (num_sizes == 0) {
+        sizes[0] = 10;
+        sizes[1] = 100;
+        sizes[2] = 1000;
+        num_sizes = 3;
+    }
+
+    for (int i = 0; i < num_sizes; i++)
+        for (int shape = 0; shape < NUM_SHAPES; shape++)
+            run((Shape) shape, sizes[i]);
+    return 0;
+}
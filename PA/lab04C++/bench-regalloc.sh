@@ -0,0 +1,74 @@
+#!/bin/sh
+#  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+#  Cuenta las lecturas y escrituras a memoria que hacen los ejemplos en
+#  spim (-keepstats) con los temporales en la pila y en registros
+#  (COOL_REGALLOC), y revisa que las dos versiones, y la de x86-64 con
+#  registros, impriman lo mismo.  EXTRA agrega otras variables a las dos
+#  compilaciones (por ejemplo EXTRA=COOL_UNBOX=1).
+#
+#      ./bench-regalloc.sh                 stack y classlist
+#      ./bench-regalloc.sh list            sólo esos
+#
+#  Variables de entorno: COOLC, SPIM, TRAP e INPUT como en
+#  check-examples.sh y CC (por defecto gcc).
+
+COOLC=${COOLC:-./mycoolc}
+SPIM=${SPIM:-spim}
+TRAP=${TRAP:-/usr/class/cs143/cool/lib/trap.handler}
+INPUT=${INPUT:-7}
+CC=${CC:-gcc}
+EXTRA=${EXTRA:-}
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+EXAMPLES=$(cd "$HERE/../COOLExamples" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+run_spim() {
+    echo "$INPUT" | $SPIM -keepstats -exception_file "$TRAP" -file "$1" 2>&1 | sed '1,/^Loaded: /d'
+}
+
+# Lo que imprime el programa, sin las estadísticas
+output() {
+    sed '/^Stats -- /,$d' "$1"
+}
+
+# Número que sigue a "$2" en las estadísticas de "$1"
+stat() {
+    sed -n "s/.*$2 *:\{0,1\} *\([0-9][0-9]*\).*/\1/p" "$1" | tail -1
+}
+
+if [ $# -eq 0 ]; then
+    set -- stack classlist
+fi
+
+printf "%-12s %10s %10s %10s %10s\n" programa lecturas escrituras "lect. reg" "escr. reg"
+for name in "$@"; do
+    sources="$name.cl"
+    if [ "$name" != atoi ] && grep -q "A2I" "$EXAMPLES/$name.cl"; then
+        sources="$sources atoi.cl"
+    fi
+
+    if ! (cd "$EXAMPLES" && env -u COOL_REGALLOC $EXTRA COOL_TARGET= $COOLC $sources -o "$WORK/$name.s" &&
+          env $EXTRA COOL_TARGET= COOL_REGALLOC=1 $COOLC $sources -o "$WORK/$name.reg.s" &&
+          env $EXTRA COOL_TARGET=x86-64 COOL_REGALLOC=1 $COOLC $sources -o "$WORK/$name.x86.s") \
+          > "$WORK/$name.log" 2>&1 ||
+       ! $CC -O2 -o "$WORK/$name" "$WORK/$name.x86.s" "$HERE/cool-runtime.c" >> "$WORK/$name.log" 2>&1; then
+        echo "$name: no compila"
+        cat "$WORK/$name.log"
+        continue
+    fi
+
+    run_spim "$WORK/$name.s" > "$WORK/$name.out"
+    run_spim "$WORK/$name.reg.s" > "$WORK/$name.reg.out"
+    echo "$INPUT" | "$WORK/$name" > "$WORK/$name.x86.out"
+    if [ "$(output "$WORK/$name.out")" != "$(output "$WORK/$name.reg.out")" ] ||
+       [ "$(output "$WORK/$name.out")" != "$(cat "$WORK/$name.x86.out")" ]; then
+        echo "$name: con registros imprime otra cosa"
+        continue
+    fi
+
+    printf "%-12s %10s %10s %10s %10s\n" "$name" \
+        "$(stat "$WORK/$name.out" '#reads')" "$(stat "$WORK/$name.out" '#writes')" \
+        "$(stat "$WORK/$name.reg.out" '#reads')" "$(stat "$WORK/$name.reg.out" '#writes')"
+done
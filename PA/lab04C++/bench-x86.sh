@@ -0,0 +1,74 @@
+#!/bin/sh
+#  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+#  Compara el tiempo de los ejemplos compilados para MIPS y corridos en
+#  spim con el de los mismos compilados para x86-64 (COOL_TARGET=x86-64)
+#  y enlazados con cool-runtime.c.  Antes de medir revisa que las dos
+#  versiones impriman lo mismo.
+#
+#      ./bench-x86.sh                      factorial, stack y classlist
+#      ./bench-x86.sh list                 sólo esos
+#
+#  Variables de entorno: COOLC, SPIM, TRAP e INPUT como en
+#  check-examples.sh, CC (por defecto gcc) y REPS, cuántas veces se corre
+#  cada programa (por defecto 100).
+
+COOLC=${COOLC:-./mycoolc}
+SPIM=${SPIM:-spim}
+TRAP=${TRAP:-/usr/class/cs143/cool/lib/trap.handler}
+INPUT=${INPUT:-7}
+CC=${CC:-gcc}
+REPS=${REPS:-100}
+
+HERE=$(cd "$(dirname "$0")" && pwd)
+EXAMPLES=$(cd "$HERE/../COOLExamples" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+run_spim() {
+    echo "$INPUT" | $SPIM -exception_file "$TRAP" -file "$1" 2>&1 | sed '1,/^Loaded: /d'
+}
+
+run_native() {
+    echo "$INPUT" | "$1"
+}
+
+# Milisegundos que tardan REPS corridas de "$@"
+time_reps() {
+    start=$(date +%s%N)
+    i=0
+    while [ $i -lt "$REPS" ]; do
+        "$@" > /dev/null
+        i=$((i + 1))
+    done
+    end=$(date +%s%N)
+    echo $(((end - start) / 1000000))
+}
+
+if [ $# -eq 0 ]; then
+    set -- factorial stack classlist
+fi
+
+printf "%-12s %10s %10s %8s\n" programa "spim (ms)" "x86 (ms)" veces
+for name in "$@"; do
+    sources="$name.cl"
+    if [ "$name" != atoi ] && grep -q "A2I" "$EXAMPLES/$name.cl"; then
+        sources="$sources atoi.cl"
+    fi
+
+    if ! (cd "$EXAMPLES" && COOL_TARGET= $COOLC $sources -o "$WORK/$name.s" &&
+          COOL_TARGET=x86-64 $COOLC $sources -o "$WORK/$name.x86.s") > "$WORK/$name.log" 2>&1 ||
+       ! $CC -O2 -o "$WORK/$name" "$WORK/$name.x86.s" "$HERE/cool-runtime.c" >> "$WORK/$name.log" 2>&1; then
+        echo "$name: no compila"
+        cat "$WORK/$name.log"
+        continue
+    fi
+
+    if [ "$(run_spim "$WORK/$name.s")" != "$(run_native "$WORK/$name")" ]; then
+        echo "$name: spim y x86-64 imprimen cosas distintas"
+        continue
+    fi
+
+    spim_ms=$(time_reps run_spim "$WORK/$name.s")
+    native_ms=$(time_reps run_native "$WORK/$name")
+    printf "%-12s %10d %10d %8d\n" "$name" "$spim_ms" "$native_ms" "$REPS"
+done
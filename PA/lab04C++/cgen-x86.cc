@@ -0,0 +1,770 @@
+/*  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+ *  Backend de x86-64 (System V) del generador de código.
+ *
+ *  Usa las mismas tablas que el de MIPS (class_nameTab, class_objTab,
+ *  tablas de dispatch, prototipos y constantes, que
+ *  escribe cgen.cc con palabras de 8 bytes) y baja cada expresión con la
+ *  misma máquina de pila, cambiando sólo las instrucciones.  El resultado
+ *  se ensambla con gcc junto con cool-runtime.c:
+ *
+ *      COOL_TARGET=x86-64 ./mycoolc prog.cl -o prog.s
+ *      gcc -O2 -o prog prog.s cool-runtime.c
+ *
+ *  Registros: $a0 -> %rax, $s0 -> %rbx, $t1 -> %rcx, $t2 -> %rdx,
+ *  $a1 -> %rsi y $fp -> %rbp.  El marco queda así:
+ *
+ *      argumentos      apilados por quien llama, el primero más arriba
+ *      dirección de retorno
+ *      %rbp anterior
+ *      %rbx anterior   <- %rbp
+ *      locales         %rbp - 8, %rbp - 16, ...
+ *      %r12, %r13, ... los que usen los temporales (COOL_REGALLOC)
+ *
+ *  de modo que los argumentos y locales quedan a las mismas palabras de
+ *  %rbp que de $fp en MIPS y VarLocation sirve para los dos.  El método
+ *  saca sus argumentos con ret $n, como en MIPS.
+ */
+#include <sstream>
+#include "cgen.h"
+
+extern int cgen_debug;
+
+///////////////////////////////////////////////////////////////////////
+//
+//  x86_* procedures: una por instrucción, en sintaxis de AT&T
+//  (origen, destino).  Los desplazamientos van en palabras.
+//
+///////////////////////////////////////////////////////////////////////
+
+static void x86_load(const char *dest_reg, int offset, const char *source_reg, ostream &s)
+{ s << X86_MOV << offset * X86_WORD_SIZE << "(" << source_reg << "), " << dest_reg << endl; }
+
+static void x86_store(const char *source_reg, int offset, const char *dest_reg, ostream &s)
+{ s << X86_MOV << source_reg << ", " << offset * X86_WORD_SIZE << "(" << dest_reg << ")" << endl; }
+
+static void x86_move(const char *dest_reg, const char *source_reg, ostream &s)
+{ s << X86_MOV << source_reg << ", " << dest_reg << endl; }
+
+static void x86_load_imm(const char *dest_reg, int val, ostream &s)
+{ s << X86_MOV << "$" << val << ", " << dest_reg << endl; }
+
+// leaq <etiqueta>(%rip), dest: la etiqueta la escribe quien llama entre
+// las dos mitades
+static void x86_partial_load_address(ostream &s)
+{ s << X86_LEA; }
+
+static void x86_end_load_address(const char *dest_reg, ostream &s)
+{ s << "(%rip), " << dest_reg << endl; }
+
+static void x86_load_address(const char *dest_reg, const char *address, ostream &s)
+{
+  x86_partial_load_address(s);
+  s << address;
+  x86_end_load_address(dest_reg, s);
+}
+
+static void x86_load_bool(const char *dest, const BoolConst &b, ostream &s)
+{
+  x86_partial_load_address(s);
+  b.code_ref(s);
+  x86_end_load_address(dest, s);
+}
+
+static void x86_load_string(const char *dest, StringEntry *str, ostream &s)
+{
+  x86_partial_load_address(s);
+  str->code_ref(s);
+  x86_end_load_address(dest, s);
+}
+
+static void x86_load_int(const char *dest, IntEntry *i, ostream &s)
+{
+  x86_partial_load_address(s);
+  i->code_ref(s);
+  x86_end_load_address(dest, s);
+}
+
+static void x86_push(const char *reg, ostream &s)
+{ s << X86_PUSH << reg << endl; }
+
+static void x86_pop(const char *reg, ostream &s)
+{ s << X86_POP << reg << endl; }
+
+static void x86_call(const char *address, ostream &s)
+{
+  calls_emitted++;
+  s << X86_CALL << address << endl;
+}
+
+static void x86_call_indirect(int offset, const char *reg, ostream &s)
+{
+  calls_emitted++;
+  s << X86_CALL << "*" << offset * X86_WORD_SIZE << "(" << reg << ")" << endl;
+}
+
+static void x86_label_ref(int l, ostream &s)
+{ s << "label" << l; }
+
+static void x86_label_def(int l, ostream &s)
+{
+  x86_label_ref(l, s);
+  s << ":" << endl;
+}
+
+static void x86_jump(const char *op, int l, ostream &s)
+{
+  s << "\t" << op << "\t";
+  x86_label_ref(l, s);
+  s << endl;
+}
+
+static void x86_branch(int l, ostream &s)
+{ x86_jump("jmp", l, s); }
+
+// Salta a l si reg es void (zero != 0) o si no lo es
+static void x86_test_void(const char *reg, bool zero, int l, ostream &s)
+{
+  s << X86_TEST << reg << ", " << reg << endl;
+  x86_jump(zero ? "je" : "jne", l, s);
+}
+
+// Valor de un Int o Bool (32 bits, en la primera casilla después del
+// encabezado)
+static void x86_fetch_int(const char *dest32, const char *source, ostream &s)
+{ s << X86_MOVL << DEFAULT_OBJFIELDS * X86_WORD_SIZE << "(" << source << "), " << dest32 << endl; }
+
+static void x86_store_int(const char *source32, const char *dest, ostream &s)
+{ s << X86_MOVL << source32 << ", " << DEFAULT_OBJFIELDS * X86_WORD_SIZE << "(" << dest << ")" << endl; }
+
+// Salta a l si el Bool de reg es false
+static void x86_branch_false(const char *reg, int l, ostream &s)
+{
+  s << X86_CMPL << "$0, " << DEFAULT_OBJFIELDS * X86_WORD_SIZE << "(" << reg << ")" << endl;
+  x86_jump("je", l, s);
+}
+
+// Valores sin caja (COOL_UNBOX), como en cgen.cc.  Los Int sin caja se
+// operan y comparan en 32 bits, así que la mitad alta del registro no
+// importa.
+
+static void x86_bool_value(const char *dest, bool val, ostream &s)
+{
+  if (cgen_unbox)
+    x86_load_imm(dest, val, s);
+  else
+    x86_load_bool(dest, BoolConst(val), s);
+}
+
+// Salta a l si el Bool de reg es false
+static void x86_branch_if_false(const char *reg, int l, ostream &s)
+{
+  if (cgen_unbox)
+    x86_test_void(reg, true, l, s);
+  else
+    x86_branch_false(reg, l, s);
+}
+
+static void x86_box(Symbol type, ostream &s)
+{
+  if (type == Bool) {
+    int done = new_label();
+    x86_move(X86_T1, X86_ACC, s);
+    x86_load_bool(X86_ACC, truebool, s);
+    x86_test_void(X86_T1, false, done, s);
+    x86_load_bool(X86_ACC, falsebool, s);
+    x86_label_def(done, s);
+    return;
+  }
+  x86_push(X86_ACC, s);
+  x86_partial_load_address(s);
+  s << Int << PROTOBJ_SUFFIX;
+  x86_end_load_address(X86_ACC, s);
+  x86_call("Object.copy", s);
+  x86_pop(X86_T1, s);
+  x86_store_int(X86_T1_32, X86_ACC, s);
+}
+
+static void x86_convert(Symbol type, bool from_raw, bool to_raw, ostream &s)
+{
+  if (from_raw && !to_raw)
+    x86_box(type, s);
+  else if (!from_raw && to_raw)
+    x86_fetch_int(X86_ACC_32, X86_ACC, s);
+}
+
+static void x86_code_as(Expression e, bool raw, ostream &s)
+{
+  e->code_x86(s);
+  x86_convert(e->get_type(), unboxed(e->get_type()), raw, s);
+}
+
+static void x86_load_var(VarLocation *loc, ostream &s)
+{
+  x86_load(X86_ACC, loc->offset, loc->kind == VarLocation::ATTR ? X86_SELF : X86_FP, s);
+}
+
+static void x86_store_var(VarLocation *loc, ostream &s)
+{
+  x86_store(X86_ACC, loc->offset, loc->kind == VarLocation::ATTR ? X86_SELF : X86_FP, s);
+}
+
+//******************************************************************
+//
+//   Métodos e inicialización
+//
+//*****************************************************************
+
+// Registros para los temporales (COOL_REGALLOC): %r8-%r11 no se
+// preservan en las llamadas (tampoco en las de C del runtime) y
+// %r12-%r15 sí
+static const char *caller_temps[] = { "%r8", "%r9", "%r10", "%r11" };
+static const char *callee_temps[] = { "%r12", "%r13", "%r14", "%r15" };
+#define NUM_CALLER_TEMPS (int) (sizeof(caller_temps) / sizeof(caller_temps[0]))
+#define NUM_CALLEE_TEMPS (int) (sizeof(callee_temps) / sizeof(callee_temps[0]))
+
+// Los registros de temporales que usa el método se guardan después de
+// los locales
+static void x86_method(ostream &s, int num_args, int num_locals, int num_saved,
+                       const std::string &body)
+{
+  x86_push(X86_FP, s);
+  x86_push(X86_SELF, s);
+  x86_move(X86_FP, X86_SP, s);
+  if (num_locals + num_saved > 0)
+    s << X86_SUB << "$" << (num_locals + num_saved) * X86_WORD_SIZE << ", " << X86_SP << endl;
+  for (int i = 0; i < num_saved; i++)
+    x86_store(callee_temps[i], -(num_locals + i + 1), X86_FP, s);
+  x86_move(X86_SELF, X86_ACC, s);
+
+  s << body;
+
+  for (int i = 0; i < num_saved; i++)
+    x86_load(callee_temps[i], -(num_locals + i + 1), X86_FP, s);
+  x86_move(X86_SP, X86_FP, s);
+  x86_pop(X86_SELF, s);
+  x86_pop(X86_FP, s);
+  if (num_args > 0)
+    s << X86_RET << "$" << num_args * X86_WORD_SIZE << endl;
+  else
+    s << X86_RET << endl;
+}
+
+void CgenClassTable::code_x86()
+{
+  if (cgen_debug) cout << "coding global text" << endl;
+  code_x86_global_text();
+
+  if (cgen_debug) cout << "coding init methods" << endl;
+  code_x86_inits();
+
+  if (cgen_debug) cout << "coding methods" << endl;
+  code_x86_methods();
+}
+
+void CgenClassTable::code_x86_global_text()
+{
+  // sin esta sección ld marca la pila como ejecutable
+  str << "\t.section\t.note.GNU-stack,\"\",@progbits" << endl;
+  str << "\t.text" << endl;
+  const char *globals[] = { "Main", "Int", "String", "Bool" };
+  for (int i = 0; i < 4; i++)
+    str << GLOBAL << globals[i] << CLASSINIT_SUFFIX << endl;
+  str << GLOBAL << "Main" << METHOD_SEP << "main" << endl;
+}
+
+// Como code_inits en cgen.cc
+void CgenClassTable::code_x86_inits()
+{
+  for (size_t i = 0; i < nds.size(); i++) {
+    CgenNodeP nd = nds[i];
+    str << nd->get_name() << CLASSINIT_SUFFIX << LABEL;
+    if (nd->trivial_init()) {
+      str << X86_RET << endl;
+      continue;
+    }
+    enter_class(nd);
+
+    std::ostringstream body;
+    for (size_t j = nd->init_start; j < nd->attributes.size(); j++) {
+      Expression init = nd->attributes[j]->GetInit();
+      if (init->IsNoExpr())
+        continue;
+      curr_class = nd->attr_owner(j);
+      VarLocation *loc = var_env->lookup(nd->attributes[j]->GetName());
+      x86_code_as(init, loc->raw, body);
+      x86_store_var(loc, body);
+    }
+    curr_class = nd;
+    x86_move(X86_ACC, X86_SELF, body);
+
+    x86_method(str, 0, max_locals, temps_saved, body.str());
+  }
+}
+
+void CgenClassTable::code_x86_methods()
+{
+  for (size_t i = 0; i < nds.size(); i++) {
+    CgenNodeP nd = nds[i];
+    if (nd->basic())
+      continue;     // están en el runtime (cool-runtime.c)
+    enter_class(nd);
+
+    Features features = nd->GetFeatures();
+    for (int j = features->first(); features->more(j); j = features->next(j)) {
+      Feature f = features->nth(j);
+      if (!f->IsMethod())
+        continue;
+      method_class *method = (method_class *) f;
+      Formals formals = method->GetFormals();
+      int num_args = formals->len();
+      bool raw = raw_signature(nd, method->GetName());
+
+      var_env->enterscope();
+      for (int k = formals->first(); formals->more(k); k = formals->next(k)) {
+        VarLocation *loc = new VarLocation;
+        loc->kind = VarLocation::ARG;
+        loc->offset = 2 + num_args - k;
+        loc->raw = raw && unboxed(formals->nth(k)->GetType());
+        var_env->addid(formals->nth(k)->GetName(), loc);
+      }
+      next_local = 0;
+      max_locals = 0;
+      temps_saved = 0;
+      std::ostringstream body;
+      x86_code_as(method->GetExpr(), raw && unboxed(method->GetType()), body);
+      var_env->exitscope();
+
+      str << nd->get_name() << METHOD_SEP << method->GetName() << LABEL;
+      x86_method(str, num_args, max_locals, temps_saved, body.str());
+    }
+  }
+}
+
+//******************************************************************
+//
+//   Expresiones: todas dejan su valor en %rax
+//
+//*****************************************************************
+
+// Aborta con el archivo y la línea de e si %rax es void
+static void x86_void_check(tree_node *e, const char *handler, ostream &s)
+{
+  int ok = new_label();
+  x86_test_void(X86_ACC, false, ok, s);
+  x86_load_string(X86_ACC, (StringEntryP) curr_class->get_filename(), s);
+  x86_load_imm(X86_T1, e->get_line_number(), s);
+  x86_call(handler, s);
+  x86_label_def(ok, s);
+}
+
+// Como code_inline en cgen.cc
+static void x86_inline(Expression e, Expression expr, CgenNodeP impl, method_class *method,
+                       Expressions actual, ostream &s)
+{
+  std::vector<VarLocation *> args;
+  Formals formals = method->GetFormals();
+  for (int i = actual->first(); actual->more(i); i = actual->next(i)) {
+    args.push_back(new_slot());
+    args.back()->raw = unboxed(formals->nth(i)->GetType());
+    x86_code_as(actual->nth(i), args.back()->raw, s);
+    x86_store(X86_ACC, args.back()->offset, X86_FP, s);
+  }
+  x86_code_as(expr, false, s);
+  x86_void_check(e, "_dispatch_abort", s);
+
+  VarLocation *saved_self = new_slot();
+  x86_store(X86_SELF, saved_self->offset, X86_FP, s);
+  x86_move(X86_SELF, X86_ACC, s);
+  InlineFrame frame = enter_inline(impl, method, args);
+  x86_code_as(method->GetExpr(), unboxed(e->get_type()), s);
+  leave_inline(frame);
+  x86_load(X86_SELF, saved_self->offset, X86_FP, s);
+  next_local -= args.size() + 1;
+}
+
+static void x86_dispatch(Expression e, Expression expr, Symbol static_type,
+                         Symbol name, Expressions actual, ostream &s)
+{
+  CgenNodeP nd = codegen_classtable->lookup_class(static_type ? static_type : expr->get_type());
+  CgenNodeP impl;
+  method_class *method = inline_target(nd, name, static_type != NULL, &impl);
+  if (method != NULL) {
+    x86_inline(e, expr, impl, method, actual, s);
+    return;
+  }
+
+  method = nd->find_method(name);
+  bool raw = raw_signature(nd, name);
+  Formals formals = method->GetFormals();
+  for (int i = actual->first(); actual->more(i); i = actual->next(i)) {
+    x86_code_as(actual->nth(i), raw && unboxed(formals->nth(i)->GetType()), s);
+    x86_push(X86_ACC, s);
+  }
+  x86_code_as(expr, false, s);
+  x86_void_check(e, "_dispatch_abort", s);
+
+  Symbol direct = direct_call_target(nd, name, static_type != NULL);
+  if (direct != NULL) {
+    calls_emitted++;
+    s << X86_CALL << direct << METHOD_SEP << name << endl;
+  } else {
+    if (static_type) {
+      x86_partial_load_address(s);
+      s << static_type << DISPTAB_SUFFIX;
+      x86_end_load_address(X86_T1, s);
+    } else {
+      x86_load(X86_T1, DISPTABLE_OFFSET, X86_ACC, s);
+    }
+    x86_call_indirect(nd->method_offset(name), X86_T1, s);
+  }
+  x86_convert(e->get_type(), raw && unboxed(method->GetType()), unboxed(e->get_type()), s);
+}
+
+void assign_class::code_x86(ostream &s) {
+  expr->code_x86(s);
+  VarLocation *loc = var_env->lookup(name);
+  if (unboxed(expr->get_type()) && !loc->raw) {
+    x86_box(expr->get_type(), s);
+    x86_store_var(loc, s);
+    x86_fetch_int(X86_ACC_32, X86_ACC, s);
+    return;
+  }
+  x86_store_var(loc, s);
+}
+
+void static_dispatch_class::code_x86(ostream &s) {
+  x86_dispatch(this, expr, type_name, name, actual, s);
+}
+
+void dispatch_class::code_x86(ostream &s) {
+  x86_dispatch(this, expr, NULL, name, actual, s);
+}
+
+void cond_class::code_x86(ostream &s) {
+  int false_label = new_label();
+  int end_label = new_label();
+  pred->code_x86(s);
+  x86_branch_if_false(X86_ACC, false_label, s);
+  x86_code_as(then_exp, unboxed(type), s);
+  x86_branch(end_label, s);
+  x86_label_def(false_label, s);
+  x86_code_as(else_exp, unboxed(type), s);
+  x86_label_def(end_label, s);
+}
+
+void loop_class::code_x86(ostream &s) {
+  int loop_label = new_label();
+  int end_label = new_label();
+  x86_label_def(loop_label, s);
+  pred->code_x86(s);
+  x86_branch_if_false(X86_ACC, end_label, s);
+  body->code_x86(s);
+  x86_branch(loop_label, s);
+  x86_label_def(end_label, s);
+  x86_load_imm(X86_ACC, 0, s);
+}
+
+// Como emit_case_search en cgen.cc, con el tag en %rdx
+static void x86_case_search(const std::vector<CaseRange> &ranges, int lo, int hi,
+                            const std::vector<int> &labels, int abort_label, ostream &s)
+{
+  if (hi - lo == 1) {
+    x86_branch(ranges[lo].branch < 0 ? abort_label : labels[ranges[lo].branch], s);
+    return;
+  }
+  int mid = (lo + hi) / 2;
+  int upper = new_label();
+  s << X86_CMP << "$" << ranges[mid].first << ", " << X86_T2 << endl;
+  x86_jump("jge", upper, s);
+  x86_case_search(ranges, lo, mid, labels, abort_label, s);
+  x86_label_def(upper, s);
+  x86_case_search(ranges, mid, hi, labels, abort_label, s);
+}
+
+// Igual que en MIPS: se busca el tramo del tag del objeto
+void typcase_class::code_x86(ostream &s) {
+  x86_code_as(expr, false, s);
+  x86_void_check(this, "_case_abort2", s);
+
+  int end_label = new_label();
+  int abort_label = new_label();
+  std::vector<int> branch_labels;
+  for (int i = cases->first(); cases->more(i); i = cases->next(i))
+    branch_labels.push_back(new_label());
+
+  std::vector<CaseRange> ranges = case_ranges(cases);
+  x86_load(X86_T2, TAG_OFFSET, X86_ACC, s);
+  x86_case_search(ranges, 0, ranges.size(), branch_labels, abort_label, s);
+  x86_label_def(abort_label, s);
+  x86_call("_case_abort", s);
+
+  for (int i = cases->first(); cases->more(i); i = cases->next(i)) {
+    branch_class *b = (branch_class *) cases->nth(i);
+    x86_label_def(branch_labels[i], s);
+    VarLocation *loc = new_local(b->GetName());
+    x86_store_var(loc, s);
+    x86_code_as(b->GetExpr(), unboxed(type), s);
+    free_local();
+    x86_branch(end_label, s);
+  }
+  x86_label_def(end_label, s);
+}
+
+void block_class::code_x86(ostream &s) {
+  for (int i = body->first(); body->more(i); i = body->next(i))
+    body->nth(i)->code_x86(s);
+}
+
+void let_class::code_x86(ostream &s) {
+  bool raw = unboxed(type_decl);
+  if (!init->IsNoExpr()) {
+    x86_code_as(init, raw, s);
+  } else if (raw) {
+    x86_load_imm(X86_ACC, 0, s);
+  } else if (type_decl == Int || type_decl == Str || type_decl == Bool) {
+    x86_partial_load_address(s);
+    code_default_value(type_decl, s);
+    x86_end_load_address(X86_ACC, s);
+  } else {
+    x86_load_imm(X86_ACC, 0, s);
+  }
+  VarLocation *loc = new_local(identifier);
+  loc->raw = raw;
+  x86_store_var(loc, s);
+  body->code_x86(s);
+  free_local();
+}
+
+// Como code_operands y emit_temp_restore en cgen.cc
+static Temp x86_operands(Expression e1, Expression e2, bool boxed, bool call, ostream &s)
+{
+  x86_code_as(e1, !boxed && unboxed(e1->get_type()), s);
+  Temp t = temp_reserve(NUM_CALLER_TEMPS, NUM_CALLEE_TEMPS);
+  std::ostringstream second;
+  x86_code_as(e2, !boxed && unboxed(e2->get_type()), second);
+  temp_release(t, call);
+
+  switch (t.kind) {
+  case TEMP_STACK:  x86_push(X86_ACC, s); break;
+  case TEMP_CALLER: x86_move(caller_temps[t.reg], X86_ACC, s); break;
+  case TEMP_CALLEE: x86_move(callee_temps[t.reg], X86_ACC, s); break;
+  case TEMP_SPILL:  x86_store(X86_ACC, t.spill->offset, X86_FP, s); break;
+  }
+  s << second.str();
+  return t;
+}
+
+static void x86_temp_restore(const Temp &t, const char *dest, ostream &s)
+{
+  switch (t.kind) {
+  case TEMP_STACK:  x86_pop(dest, s); break;
+  case TEMP_CALLER: x86_move(dest, caller_temps[t.reg], s); break;
+  case TEMP_CALLEE: x86_move(dest, callee_temps[t.reg], s); break;
+  case TEMP_SPILL:  x86_load(dest, t.spill->offset, X86_FP, s); break;
+  }
+}
+
+// El primer operando queda en un temporal mientras se evalúa el segundo
+// y el resultado va en una copia del segundo
+static void x86_arith(Expression e1, Expression e2, const char *op, ostream &s)
+{
+  Temp t = x86_operands(e1, e2, false, !cgen_unbox, s);
+  if (cgen_unbox) {
+    x86_temp_restore(t, X86_T1, s);
+    s << op << X86_ACC_32 << ", " << X86_T1_32 << endl;
+    x86_move(X86_ACC, X86_T1, s);
+    return;
+  }
+  x86_call("Object.copy", s);
+  x86_temp_restore(t, X86_T1, s);
+  x86_fetch_int(X86_T1_32, X86_T1, s);
+  x86_fetch_int(X86_T2_32, X86_ACC, s);
+  s << op << X86_T2_32 << ", " << X86_T1_32 << endl;
+  x86_store_int(X86_T1_32, X86_ACC, s);
+}
+
+void plus_class::code_x86(ostream &s) {
+  x86_arith(e1, e2, X86_ADDL, s);
+}
+
+void sub_class::code_x86(ostream &s) {
+  x86_arith(e1, e2, X86_SUBL, s);
+}
+
+void mul_class::code_x86(ostream &s) {
+  x86_arith(e1, e2, X86_IMULL, s);
+}
+
+// %eax / divisor.  idivl también da SIGFPE con INT_MIN / -1, así que
+// dividir por -1 se hace con negl (INT_MIN queda igual, como en MIPS) y
+// la única excepción que queda es la división por cero (cool-runtime.c)
+static void x86_idivl(const std::string &divisor, ostream &s)
+{
+  int divide = new_label(), done = new_label();
+  s << X86_CMPL << "$-1, " << divisor << endl;
+  x86_jump("jne", divide, s);
+  s << X86_NEGL << X86_ACC_32 << endl;
+  x86_branch(done, s);
+  x86_label_def(divide, s);
+  s << X86_CLTD;
+  s << X86_IDIVL << divisor << endl;
+  x86_label_def(done, s);
+}
+
+// idivl divide %edx:%eax, así que la copia del segundo operando pasa a %rdi
+void divide_class::code_x86(ostream &s) {
+  Temp t = x86_operands(e1, e2, false, !cgen_unbox, s);
+  if (cgen_unbox) {
+    x86_move(X86_T3, X86_ACC, s);
+    x86_temp_restore(t, X86_ACC, s);
+    x86_idivl(X86_T3_32, s);
+    return;
+  }
+  x86_call("Object.copy", s);
+  x86_temp_restore(t, X86_T1, s);
+  x86_move(X86_T3, X86_ACC, s);
+  x86_fetch_int(X86_ACC_32, X86_T1, s);
+  std::ostringstream divisor;
+  divisor << DEFAULT_OBJFIELDS * X86_WORD_SIZE << "(" << X86_T3 << ")";
+  x86_idivl(divisor.str(), s);
+  x86_store_int(X86_ACC_32, X86_T3, s);
+  x86_move(X86_ACC, X86_T3, s);
+}
+
+void neg_class::code_x86(ostream &s) {
+  e1->code_x86(s);
+  if (cgen_unbox) {
+    s << X86_NEGL << X86_ACC_32 << endl;
+    return;
+  }
+  x86_call("Object.copy", s);
+  x86_fetch_int(X86_T1_32, X86_ACC, s);
+  s << X86_NEGL << X86_T1_32 << endl;
+  x86_store_int(X86_T1_32, X86_ACC, s);
+}
+
+static void x86_compare(Expression e1, Expression e2, const char *jump, ostream &s)
+{
+  Temp t = x86_operands(e1, e2, false, false, s);
+  x86_temp_restore(t, X86_T1, s);
+  if (cgen_unbox) {
+    x86_move(X86_T2, X86_ACC, s);
+  } else {
+    x86_fetch_int(X86_T1_32, X86_T1, s);
+    x86_fetch_int(X86_T2_32, X86_ACC, s);
+  }
+  int done = new_label();
+  x86_bool_value(X86_ACC, true, s);
+  s << X86_CMPL << X86_T2_32 << ", " << X86_T1_32 << endl;
+  x86_jump(jump, done, s);
+  x86_bool_value(X86_ACC, false, s);
+  x86_label_def(done, s);
+}
+
+void lt_class::code_x86(ostream &s) {
+  x86_compare(e1, e2, "jl", s);
+}
+
+void eq_class::code_x86(ostream &s) {
+  bool raw = unboxed(e1->get_type()) && unboxed(e2->get_type());
+  Temp t = x86_operands(e1, e2, !raw, false, s);
+  x86_temp_restore(t, X86_T1, s);
+  x86_move(X86_T2, X86_ACC, s);
+  int done = new_label();
+  x86_bool_value(X86_ACC, true, s);
+  if (raw) {
+    s << X86_CMPL << X86_T2_32 << ", " << X86_T1_32 << endl;
+    x86_jump("je", done, s);
+    x86_bool_value(X86_ACC, false, s);
+  } else {
+    s << X86_CMP << X86_T2 << ", " << X86_T1 << endl;
+    x86_jump("je", done, s);
+    x86_bool_value(X86_A1, false, s);
+    x86_call("equality_test", s);
+  }
+  x86_label_def(done, s);
+}
+
+void leq_class::code_x86(ostream &s) {
+  x86_compare(e1, e2, "jle", s);
+}
+
+void comp_class::code_x86(ostream &s) {
+  e1->code_x86(s);
+  x86_move(X86_T1, X86_ACC, s);
+  int done = new_label();
+  x86_bool_value(X86_ACC, true, s);
+  x86_branch_if_false(X86_T1, done, s);
+  x86_bool_value(X86_ACC, false, s);
+  x86_label_def(done, s);
+}
+
+void int_const_class::code_x86(ostream &s) {
+  if (cgen_unbox)
+    x86_load_imm(X86_ACC, atoi(token->get_string()), s);
+  else
+    x86_load_int(X86_ACC, inttable.lookup_string(token->get_string()), s);
+}
+
+void string_const_class::code_x86(ostream &s) {
+  x86_load_string(X86_ACC, stringtable.lookup_string(token->get_string()), s);
+}
+
+void bool_const_class::code_x86(ostream &s) {
+  x86_bool_value(X86_ACC, val, s);
+}
+
+void new__class::code_x86(ostream &s) {
+  if (unboxed(type_name)) {
+    x86_load_imm(X86_ACC, 0, s);
+    return;
+  }
+  if (type_name != SELF_TYPE) {
+    x86_partial_load_address(s);
+    s << type_name << PROTOBJ_SUFFIX;
+    x86_end_load_address(X86_ACC, s);
+    x86_call("Object.copy", s);
+    if (!codegen_classtable->lookup_class(type_name)->trivial_init()) {
+      calls_emitted++;
+      s << X86_CALL << type_name << CLASSINIT_SUFFIX << endl;
+    }
+    return;
+  }
+  x86_load_address(X86_T1, CLASSOBJTAB, s);
+  x86_load(X86_T2, TAG_OFFSET, X86_SELF, s);
+  s << X86_SHL << "$4, " << X86_T2 << endl;
+  s << X86_ADD << X86_T2 << ", " << X86_T1 << endl;
+  x86_push(X86_T1, s);
+  x86_load(X86_ACC, 0, X86_T1, s);
+  x86_call("Object.copy", s);
+  x86_pop(X86_T1, s);
+  x86_call_indirect(1, X86_T1, s);
+}
+
+void isvoid_class::code_x86(ostream &s) {
+  e1->code_x86(s);
+  if (unboxed(e1->get_type())) {
+    x86_bool_value(X86_ACC, false, s);
+    return;
+  }
+  x86_move(X86_T1, X86_ACC, s);
+  int done = new_label();
+  x86_bool_value(X86_ACC, true, s);
+  x86_test_void(X86_T1, true, done, s);
+  x86_bool_value(X86_ACC, false, s);
+  x86_label_def(done, s);
+}
+
+void no_expr_class::code_x86(ostream &s) {
+  x86_load_imm(X86_ACC, 0, s);
+}
+
+void object_class::code_x86(ostream &s) {
+  if (name == self) {
+    x86_move(X86_ACC, X86_SELF, s);
+    return;
+  }
+  VarLocation *loc = var_env->lookup(name);
+  x86_load_var(loc, s);
+  x86_convert(type, loc->raw, unboxed(type), s);
+}
@@ -0,0 +1,2042 @@
+
+//**************************************************************
+//
+// Code generator SKELETON
+//
+// Read the comments carefully. Make sure to
+//    initialize the base class tags in
+//       `CgenClassTable::CgenClassTable'
+//
+//    Add the label for the dispatch tables to
+//       `IntEntry::code_def'
+//       `StringEntry::code_def'
+//       `BoolConst::code_def'
+//
+//    Add code to emit everyting else that is needed
+//       in `CgenClassTable::code'
+//
+//
+// The files as provided will produce code to begin the code
+// segments, declare globals, and emit constants.  You must
+// fill in the rest.
+//
+//**************************************************************
+
+//Partes extraídas de: https://github.com/skyzluo/CS143-Compilers-Stanford
+
+#include <string.h>
+#include <sstream>
+#include "cgen.h"
+#include "ir.h"
+#include "fold.h"
+#include "cgen_gc.h"
+
+extern void emit_string_constant(ostream& str, char *s);
+extern int cgen_debug;
+
+//
+// Three symbols from the semantic analyzer (semant.cc) are used.
+// If e : No_type, then no code is generated for e.
+// Special code is generated for new SELF_TYPE.
+// The name "self" also generates code different from other references.
+//
+//////////////////////////////////////////////////////////////////////
+//
+// Symbols
+//
+// For convenience, a large number of symbols are predefined here.
+// These symbols include the primitive type and method names, as well
+// as fixed names used by the runtime system.
+//
+//////////////////////////////////////////////////////////////////////
+Symbol
+       arg,
+       arg2,
+       Bool,
+       concat,
+       cool_abort,
+       copy,
+       Int,
+       in_int,
+       in_string,
+       IO,
+       length,
+       Main,
+       main_meth,
+       No_class,
+       No_type,
+       Object,
+       out_int,
+       out_string,
+       prim_slot,
+       self,
+       SELF_TYPE,
+       Str,
+       str_field,
+       substr,
+       type_name,
+       val;
+//
+// Initializing the predefined symbols.
+//
+static void initialize_constants(void)
+{
+  arg         = idtable.add_string("arg");
+  arg2        = idtable.add_string("arg2");
+  Bool        = idtable.add_string("Bool");
+  concat      = idtable.add_string("concat");
+  cool_abort  = idtable.add_string("abort");
+  copy        = idtable.add_string("copy");
+  Int         = idtable.add_string("Int");
+  in_int      = idtable.add_string("in_int");
+  in_string   = idtable.add_string("in_string");
+  IO          = idtable.add_string("IO");
+  length      = idtable.add_string("length");
+  Main        = idtable.add_string("Main");
+  main_meth   = idtable.add_string("main");
+//   _no_class is a symbol that can't be the name of any
+//   user-defined class.
+  No_class    = idtable.add_string("_no_class");
+  No_type     = idtable.add_string("_no_type");
+  Object      = idtable.add_string("Object");
+  out_int     = idtable.add_string("out_int");
+  out_string  = idtable.add_string("out_string");
+  prim_slot   = idtable.add_string("_prim_slot");
+  self        = idtable.add_string("self");
+  SELF_TYPE   = idtable.add_string("SELF_TYPE");
+  Str         = idtable.add_string("String");
+  str_field   = idtable.add_string("_str_field");
+  substr      = idtable.add_string("substr");
+  type_name   = idtable.add_string("type_name");
+  val         = idtable.add_string("_val");
+}
+
+static const char *gc_init_names[] =
+  { "_NoGC_Init", "_GenGC_Init", "_ScnGC_Init" };
+static const char *gc_collect_names[] =
+  { "_NoGC_Collect", "_GenGC_Collect", "_ScnGC_Collect" };
+
+
+//  BoolConst is a class that implements code generation for operations
+//  on the two booleans, which are given global names here.
+BoolConst falsebool(FALSE);
+BoolConst truebool(TRUE);
+
+// Estado de la generación de código de las expresiones
+// ====================================================
+// code() sólo recibe el flujo de salida, así que la clase actual, las
+// variables visibles y el marco del método que se está generando viven
+// aquí (igual que classtable en semant.cc).  Lo comparten los dos
+// backends (ver cgen.h).
+CgenClassTableP codegen_classtable;
+CgenNodeP curr_class;
+SymbolTable<Symbol, VarLocation> *var_env;
+int next_local;            // siguiente casilla libre para un let o una rama
+int max_locals;            // casillas que necesita el marco del método actual
+static int label_count = 0;
+
+// Máquina de destino.  Las tablas, prototipos y constantes son iguales en
+// las dos; sólo cambian la directiva y el tamaño de las palabras.
+Target cgen_target = TARGET_MIPS;
+bool cgen_devirt = false;
+int inline_budget = 0;
+bool cgen_unbox = false;
+bool cgen_regalloc = false;
+int calls_emitted = 0;
+int temps_saved = 0;
+static int temp_depth[2];            // registros de temporales ocupados (caller, callee)
+static int temp_count[4];            // temporales generados, por TempKind
+int inlined_sites = 0;
+static int dispatch_sites = 0;       // con COOL_DEVIRT: dispatch generados
+static int direct_sites = 0;         // y cuántos son llamadas directas
+static const char *data_word = WORD;
+static const char *data_align = ALIGN;
+static int word_size = WORD_SIZE;
+
+//*********************************************************
+//
+// Define method for code generation
+//
+// This is the method called by the compiler driver
+// `cgtest.cc'. cgen takes an `ostream' to which the assembly will be
+// emmitted, and it passes this and the class list of the
+// code generator tree to the constructor for `CgenClassTable'.
+// That constructor performs all of the work of the code
+// generator.
+//
+//*********************************************************
+
+void program_class::cgen(ostream &os)
+{
+  // spim wants comments to start with '#'
+  os << "# start of generated code\n";
+
+  initialize_constants();
+  const char *target = getenv(TARGET_ENV);
+  if (target != NULL && strcmp(target, "x86-64") == 0) {
+    cgen_target = TARGET_X86_64;
+    data_word = X86_QUAD;
+    data_align = X86_ALIGN;
+    word_size = X86_WORD_SIZE;
+  }
+  cgen_devirt = getenv(DEVIRT_ENV) != NULL;
+  cgen_unbox = getenv(UNBOX_ENV) != NULL &&
+               (cgen_target == TARGET_X86_64 || cgen_Memmgr == GC_NOGC);
+  cgen_regalloc = getenv(REGALLOC_ENV) != NULL &&
+                  (cgen_target == TARGET_X86_64 || cgen_Memmgr == GC_NOGC);
+  if (getenv(INLINE_ENV) != NULL) {
+    inline_budget = atoi(getenv(INLINE_ENV));
+    if (inline_budget <= 0)
+      inline_budget = INLINE_SIZE;
+  }
+  new CgenClassTable(classes,os);
+  if (cgen_devirt)
+    cerr << "devirt: " << direct_sites << " of " << dispatch_sites
+         << " dispatch sites are direct calls ("
+         << (dispatch_sites ? 100 * direct_sites / dispatch_sites : 0) << "%)" << endl;
+  if (inline_budget > 0)
+    cerr << "inline: " << inlined_sites << " dispatch sites inlined" << endl;
+  if (cgen_regalloc)
+    cerr << "regalloc: " << temp_count[TEMP_CALLER] << " temporaries in caller-saved registers, "
+         << temp_count[TEMP_CALLEE] << " in callee-saved registers, "
+         << temp_count[TEMP_SPILL] << " spilled" << endl;
+
+  os << "\n# end of generated code\n";
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//  emit_* procedures
+//
+//  emit_X  writes code for operation "X" to the output stream.
+//  There is an emit_X for each opcode X, as well as emit_ functions
+//  for generating names according to the naming conventions (see emit.h)
+//  and calls to support functions defined in the trap handler.
+//
+//  Register names and addresses are passed as strings.  See `emit.h'
+//  for symbolic names you can use to refer to the strings.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+static void emit_load(const char *dest_reg, int offset, const char *source_reg, ostream& s)
+{
+  s << LW << dest_reg << " " << offset * WORD_SIZE << "(" << source_reg << ")"
+    << endl;
+}
+
+static void emit_store(const char *source_reg, int offset, const char *dest_reg, ostream& s)
+{
+  s << SW << source_reg << " " << offset * WORD_SIZE << "(" << dest_reg << ")"
+      << endl;
+}
+
+static void emit_load_imm(const char *dest_reg, int val, ostream& s)
+{ s << LI << dest_reg << " " << val << endl; }
+
+static void emit_load_address(const char *dest_reg, const char *address, ostream& s)
+{ s << LA << dest_reg << " " << address << endl; }
+
+static void emit_partial_load_address(const char *dest_reg, ostream& s)
+{ s << LA << dest_reg << " "; }
+
+static void emit_load_bool(const char *dest, const BoolConst& b, ostream& s)
+{
+  emit_partial_load_address(dest,s);
+  b.code_ref(s);
+  s << endl;
+}
+
+static void emit_load_string(const char *dest, StringEntry *str, ostream& s)
+{
+  emit_partial_load_address(dest,s);
+  str->code_ref(s);
+  s << endl;
+}
+
+static void emit_load_int(const char *dest, IntEntry *i, ostream& s)
+{
+  emit_partial_load_address(dest,s);
+  i->code_ref(s);
+  s << endl;
+}
+
+static void emit_move(const char *dest_reg, const char *source_reg, ostream& s)
+{ s << MOVE << dest_reg << " " << source_reg << endl; }
+
+static void emit_neg(const char *dest, const char *src1, ostream& s)
+{ s << NEG << dest << " " << src1 << endl; }
+
+static void emit_add(const char *dest, const char *src1, const char *src2, ostream& s)
+{ s << ADD << dest << " " << src1 << " " << src2 << endl; }
+
+static void emit_addu(const char *dest, const char *src1, const char *src2, ostream& s)
+{ s << ADDU << dest << " " << src1 << " " << src2 << endl; }
+
+static void emit_addiu(const char *dest, const char *src1, int imm, ostream& s)
+{ s << ADDIU << dest << " " << src1 << " " << imm << endl; }
+
+static void emit_div(const char *dest, const char *src1, const char *src2, ostream& s)
+{ s << DIV << dest << " " << src1 << " " << src2 << endl; }
+
+static void emit_mul(const char *dest, const char *src1, const char *src2, ostream& s)
+{ s << MUL << dest << " " << src1 << " " << src2 << endl; }
+
+static void emit_sub(const char *dest, const char *src1, const char *src2, ostream& s)
+{ s << SUB << dest << " " << src1 << " " << src2 << endl; }
+
+static void emit_sll(const char *dest, const char *src1, int num, ostream& s)
+{ s << SLL << dest << " " << src1 << " " << num << endl; }
+
+static void emit_jalr(const char *dest, ostream& s)
+{
+  calls_emitted++;
+  s << JALR << "\t" << dest << endl;
+}
+
+static void emit_jal(const char *address,ostream &s)
+{
+  calls_emitted++;
+  s << JAL << address << endl;
+}
+
+static void emit_return(ostream& s)
+{ s << RET << endl; }
+
+static void emit_gc_assign(ostream& s)
+{ s << JAL << "_GenGC_Assign" << endl; }
+
+static void emit_disptable_ref(Symbol sym, ostream& s)
+{  s << sym << DISPTAB_SUFFIX; }
+
+static void emit_init_ref(Symbol sym, ostream& s)
+{ s << sym << CLASSINIT_SUFFIX; }
+
+static void emit_label_ref(int l, ostream &s)
+{ s << "label" << l; }
+
+static void emit_protobj_ref(Symbol sym, ostream& s)
+{ s << sym << PROTOBJ_SUFFIX; }
+
+static void emit_method_ref(Symbol classname, Symbol methodname, ostream& s)
+{ s << classname << METHOD_SEP << methodname; }
+
+static void emit_label_def(int l, ostream &s)
+{
+  emit_label_ref(l,s);
+  s << ":" << endl;
+}
+
+static void emit_beqz(const char *source, int label, ostream &s)
+{
+  s << BEQZ << source << " ";
+  emit_label_ref(label,s);
+  s << endl;
+}
+
+static void emit_beq(const char *src1, const char *src2, int label, ostream &s)
+{
+  s << BEQ << src1 << " " << src2 << " ";
+  emit_label_ref(label,s);
+  s << endl;
+}
+
+static void emit_bne(const char *src1, const char *src2, int label, ostream &s)
+{
+  s << BNE << src1 << " " << src2 << " ";
+  emit_label_ref(label,s);
+  s << endl;
+}
+
+static void emit_bleq(const char *src1, const char *src2, int label, ostream &s)
+{
+  s << BLEQ << src1 << " " << src2 << " ";
+  emit_label_ref(label,s);
+  s << endl;
+}
+
+static void emit_blt(const char *src1, const char *src2, int label, ostream &s)
+{
+  s << BLT << src1 << " " << src2 << " ";
+  emit_label_ref(label,s);
+  s << endl;
+}
+
+static void emit_blti(const char *src1, int imm, int label, ostream &s)
+{
+  s << BLT << src1 << " " << imm << " ";
+  emit_label_ref(label,s);
+  s << endl;
+}
+
+static void emit_bgti(const char *src1, int imm, int label, ostream &s)
+{
+  s << BGT << src1 << " " << imm << " ";
+  emit_label_ref(label,s);
+  s << endl;
+}
+
+static void emit_branch(int l, ostream& s)
+{
+  s << BRANCH;
+  emit_label_ref(l,s);
+  s << endl;
+}
+
+//
+// Push a register on the stack. The stack grows towards smaller addresses.
+//
+static void emit_push(const char *reg, ostream& str)
+{
+  emit_store(reg,0,SP,str);
+  emit_addiu(SP,SP,-4,str);
+}
+
+// Saca el tope de la pila a reg
+static void emit_pop(const char *reg, ostream& str)
+{
+  emit_addiu(SP,SP,4,str);
+  emit_load(reg,0,SP,str);
+}
+
+//
+// Fetch the integer value in an Int object.
+// Emits code to fetch the integer value of the Integer object pointed
+// to by register source into the register dest
+//
+static void emit_fetch_int(const char *dest, const char *source, ostream& s)
+{ emit_load(dest, DEFAULT_OBJFIELDS, source, s); }
+
+//
+// Emits code to store the integer value contained in register source
+// into the Integer object pointed to by dest.
+//
+static void emit_store_int(const char *source, const char *dest, ostream& s)
+{ emit_store(source, DEFAULT_OBJFIELDS, dest, s); }
+
+
+static void emit_test_collector(ostream &s)
+{
+  emit_push(ACC, s);
+  emit_move(ACC, SP, s); // stack end
+  emit_move(A1, ZERO, s); // allocate nothing
+  s << JAL << gc_collect_names[cgen_Memmgr] << endl;
+  emit_addiu(SP,SP,4,s);
+  emit_load(ACC,0,SP,s);
+}
+
+static void emit_gc_check(const char *source, ostream &s)
+{
+  if (source != (const char *) A1) emit_move(A1, source, s);
+  s << JAL << "_gc_check" << endl;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// coding strings, ints, and booleans
+//
+// Cool has three kinds of constants: strings, ints, and booleans.
+// This section defines code generation for each type.
+//
+// All string constants are listed in the global "stringtable" and have
+// type StringEntry.  StringEntry methods are defined both for String
+// constant definitions and references.
+//
+// All integer constants are listed in the global "inttable" and have
+// type IntEntry.  IntEntry methods are defined for Int
+// constant definitions and references.
+//
+// Since there are only two Bool values, there is no need for a table.
+// The two booleans are represented by instances of the class BoolConst,
+// which defines the definition and reference methods for Bools.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+//
+// Strings
+//
+void StringEntry::code_ref(ostream& s)
+{
+  s << STRCONST_PREFIX << index;
+}
+
+//
+// Emit code for a constant String.
+// You should fill in the code naming the dispatch table.
+//
+
+void StringEntry::code_def(ostream& s, int stringclasstag)
+{
+  IntEntryP lensym = inttable.add_int(len);
+
+  // Add -1 eye catcher
+  s << data_word << "-1" << endl;
+
+  code_ref(s);  s  << LABEL                                             // label
+      << data_word << stringclasstag << endl                            // tag
+      << data_word << (DEFAULT_OBJFIELDS + STRING_SLOTS + (len+word_size)/word_size) << endl // size
+      << data_word;
+      emit_disptable_ref(Str, s);
+      s << endl;                                                   // dispatch table
+      s << data_word;  lensym->code_ref(s);  s << endl;            // string length
+  emit_string_constant(s,str);                                     // ascii string
+  s << data_align;                                                 // align to word
+}
+
+//
+// StrTable::code_string
+// Generate a string object definition for every string constant in the
+// stringtable.
+//
+void StrTable::code_string_table(ostream& s, int stringclasstag)
+{
+  for (List<StringEntry> *l = tbl; l; l = l->tl())
+    l->hd()->code_def(s,stringclasstag);
+}
+
+//
+// Ints
+//
+void IntEntry::code_ref(ostream &s)
+{
+  s << INTCONST_PREFIX << index;
+}
+
+//
+// Emit code for a constant Integer.
+// You should fill in the code naming the dispatch table.
+//
+
+void IntEntry::code_def(ostream &s, int intclasstag)
+{
+  // Add -1 eye catcher
+  s << data_word << "-1" << endl;
+
+  code_ref(s);  s << LABEL                                // label
+      << data_word << intclasstag << endl                      // class tag
+      << data_word << (DEFAULT_OBJFIELDS + INT_SLOTS) << endl  // object size
+      << data_word;
+      emit_disptable_ref(Int, s);
+      s << endl;                                               // dispatch table
+      s << data_word << str << endl;                           // integer value
+}
+
+
+//
+// IntTable::code_string_table
+// Generate an Int object definition for every Int constant in the
+// inttable.
+//
+void IntTable::code_string_table(ostream &s, int intclasstag)
+{
+  for (List<IntEntry> *l = tbl; l; l = l->tl())
+    l->hd()->code_def(s,intclasstag);
+}
+
+
+//
+// Bools
+//
+BoolConst::BoolConst(int i) : val(i) { assert(i == 0 || i == 1); }
+
+void BoolConst::code_ref(ostream& s) const
+{
+  s << BOOLCONST_PREFIX << val;
+}
+
+//
+// Emit code for a constant Bool.
+// You should fill in the code naming the dispatch table.
+//
+
+void BoolConst::code_def(ostream& s, int boolclasstag)
+{
+  // Add -1 eye catcher
+  s << data_word << "-1" << endl;
+
+  code_ref(s);  s << LABEL                                  // label
+      << data_word << boolclasstag << endl                       // class tag
+      << data_word << (DEFAULT_OBJFIELDS + BOOL_SLOTS) << endl   // object size
+      << data_word;
+      emit_disptable_ref(Bool, s);
+      s << endl;                                                 // dispatch table
+      s << data_word << val << endl;                             // value (0 or 1)
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//  CgenClassTable methods
+//
+//////////////////////////////////////////////////////////////////////////////
+
+//***************************************************
+//
+//  Emit code to start the .data segment and to
+//  declare the global names.
+//
+//***************************************************
+
+void CgenClassTable::code_global_data()
+{
+  Symbol main    = idtable.lookup_string(MAINNAME);
+  Symbol string  = idtable.lookup_string(STRINGNAME);
+  Symbol integer = idtable.lookup_string(INTNAME);
+  Symbol boolc   = idtable.lookup_string(BOOLNAME);
+
+  str << "\t.data\n" << data_align;
+  //
+  // The following global names must be defined first.
+  //
+  str << GLOBAL << CLASSNAMETAB << endl;
+  str << GLOBAL; emit_protobj_ref(main,str);    str << endl;
+  str << GLOBAL; emit_protobj_ref(integer,str); str << endl;
+  str << GLOBAL; emit_protobj_ref(string,str);  str << endl;
+  str << GLOBAL; falsebool.code_ref(str);  str << endl;
+  str << GLOBAL; truebool.code_ref(str);   str << endl;
+  str << GLOBAL << INTTAG << endl;
+  str << GLOBAL << BOOLTAG << endl;
+  str << GLOBAL << STRINGTAG << endl;
+
+  //
+  // We also need to know the tag of the Int, String, and Bool classes
+  // during code generation.
+  //
+  str << INTTAG << LABEL
+      << data_word << intclasstag << endl;
+  str << BOOLTAG << LABEL
+      << data_word << boolclasstag << endl;
+  str << STRINGTAG << LABEL
+      << data_word << stringclasstag << endl;
+}
+
+
+//***************************************************
+//
+//  Emit code to start the .text segment and to
+//  declare the global names.
+//
+//***************************************************
+
+void CgenClassTable::code_global_text()
+{
+  str << GLOBAL << HEAP_START << endl
+      << HEAP_START << LABEL
+      << WORD << 0 << endl
+      << "\t.text" << endl
+      << GLOBAL;
+  emit_init_ref(idtable.add_string("Main"), str);
+  str << endl << GLOBAL;
+  emit_init_ref(idtable.add_string("Int"),str);
+  str << endl << GLOBAL;
+  emit_init_ref(idtable.add_string("String"),str);
+  str << endl << GLOBAL;
+  emit_init_ref(idtable.add_string("Bool"),str);
+  str << endl << GLOBAL;
+  emit_method_ref(idtable.add_string("Main"), idtable.add_string("main"), str);
+  str << endl;
+}
+
+void CgenClassTable::code_bools(int boolclasstag)
+{
+  falsebool.code_def(str,boolclasstag);
+  truebool.code_def(str,boolclasstag);
+}
+
+void CgenClassTable::code_select_gc()
+{
+  //
+  // Generate GC choice constants (pointers to GC functions)
+  //
+  str << GLOBAL << "_MemMgr_INITIALIZER" << endl;
+  str << "_MemMgr_INITIALIZER:" << endl;
+  str << WORD << gc_init_names[cgen_Memmgr] << endl;
+  str << GLOBAL << "_MemMgr_COLLECTOR" << endl;
+  str << "_MemMgr_COLLECTOR:" << endl;
+  str << WORD << gc_collect_names[cgen_Memmgr] << endl;
+  str << GLOBAL << "_MemMgr_TEST" << endl;
+  str << "_MemMgr_TEST:" << endl;
+  str << WORD << (cgen_Memmgr_Test == GC_TEST) << endl;
+}
+
+
+//********************************************************
+//
+// Emit code to reserve space for and initialize all of
+// the constants.  Class names should have been added to
+// the string table (in the supplied code, is is done
+// during the construction of the inheritance graph), and
+// code for emitting string constants as a side effect adds
+// the string's length to the integer table.  The constants
+// are emmitted by running through the stringtable and inttable
+// and producing code for each entry.
+//
+//********************************************************
+
+void CgenClassTable::code_constants()
+{
+  //
+  // Add constants that are required by the code generator.
+  //
+  stringtable.add_string("");
+  inttable.add_string("0");
+
+  stringtable.code_string_table(str,stringclasstag);
+  inttable.code_string_table(str,intclasstag);
+  code_bools(boolclasstag);
+}
+
+
+CgenClassTable::CgenClassTable(Classes classes, ostream& s) : str(s)
+{
+   codegen_classtable = this;    // code() corre dentro del constructor
+   enterscope();
+   if (cgen_debug) cout << "Building CgenClassTable" << endl;
+   install_basic_classes();
+   install_classes(classes);
+   build_inheritance_tree();
+
+   // Los tags van en preorden del árbol de herencia, así que una clase y
+   // sus descendientes tienen los tags de tag a last_tag (ver typcase).
+   // nds queda en ese orden, que es el de las tablas indexadas por tag.
+   nds.clear();
+   number_classes(root());
+   stringclasstag = probe(Str)->tag;
+   intclasstag =    probe(Int)->tag;
+   boolclasstag =   probe(Bool)->tag;
+
+   build_layout(root());
+
+   code();
+   exitscope();
+}
+
+void CgenClassTable::install_basic_classes()
+{
+
+// The tree package uses these globals to annotate the classes built below.
+  //curr_lineno  = 0;
+  Symbol filename = stringtable.add_string("<basic class>");
+
+//
+// A few special class names are installed in the lookup table but not
+// the class list.  Thus, these classes exist, but are not part of the
+// inheritance hierarchy.
+// No_class serves as the parent of Object and the other special classes.
+// SELF_TYPE is the self class; it cannot be redefined or inherited.
+// prim_slot is a class known to the code generator.
+//
+  addid(No_class,
+	new CgenNode(class_(No_class,No_class,nil_Features(),filename),
+			    Basic,this));
+  addid(SELF_TYPE,
+	new CgenNode(class_(SELF_TYPE,No_class,nil_Features(),filename),
+			    Basic,this));
+  addid(prim_slot,
+	new CgenNode(class_(prim_slot,No_class,nil_Features(),filename),
+			    Basic,this));
+
+//
+// The Object class has no parent class. Its methods are
+//        cool_abort() : Object    aborts the program
+//        type_name() : Str        returns a string representation of class name
+//        copy() : SELF_TYPE       returns a copy of the object
+//
+// There is no need for method bodies in the basic classes---these
+// are already built in to the runtime system.
+//
+  install_class(
+   new CgenNode(
+    class_(Object,
+	   No_class,
+	   append_Features(
+           append_Features(
+           single_Features(method(cool_abort, nil_Formals(), Object, no_expr())),
+           single_Features(method(type_name, nil_Formals(), Str, no_expr()))),
+           single_Features(method(copy, nil_Formals(), SELF_TYPE, no_expr()))),
+	   filename),
+    Basic,this));
+
+//
+// The IO class inherits from Object. Its methods are
+//        out_string(Str) : SELF_TYPE          writes a string to the output
+//        out_int(Int) : SELF_TYPE               "    an int    "  "     "
+//        in_string() : Str                    reads a string from the input
+//        in_int() : Int                         "   an int     "  "     "
+//
+   install_class(
+    new CgenNode(
+     class_(IO,
+            Object,
+            append_Features(
+            append_Features(
+            append_Features(
+            single_Features(method(out_string, single_Formals(formal(arg, Str)),
+                        SELF_TYPE, no_expr())),
+            single_Features(method(out_int, single_Formals(formal(arg, Int)),
+                        SELF_TYPE, no_expr()))),
+            single_Features(method(in_string, nil_Formals(), Str, no_expr()))),
+            single_Features(method(in_int, nil_Formals(), Int, no_expr()))),
+	   filename),
+    Basic,this));
+
+//
+// The Int class has no methods and only a single attribute, the
+// "val" for the integer.
+//
+   install_class(
+    new CgenNode(
+     class_(Int,
+	    Object,
+            single_Features(attr(val, prim_slot, no_expr())),
+	    filename),
+     Basic,this));
+
+//
+// Bool also has only the "val" slot.
+//
+    install_class(
+     new CgenNode(
+      class_(Bool, Object, single_Features(attr(val, prim_slot, no_expr())),filename),
+      Basic,this));
+
+//
+// The class Str has a number of slots and operations:
+//       val                                  ???
+//       str_field                            the string itself
+//       length() : Int                       length of the string
+//       concat(arg: Str) : Str               string concatenation
+//       substr(arg: Int, arg2: Int): Str     substring
+//
+   install_class(
+    new CgenNode(
+      class_(Str,
+	     Object,
+             append_Features(
+             append_Features(
+             append_Features(
+             append_Features(
+             single_Features(attr(val, Int, no_expr())),
+            single_Features(attr(str_field, prim_slot, no_expr()))),
+            single_Features(method(length, nil_Formals(), Int, no_expr()))),
+            single_Features(method(concat,
+				   single_Formals(formal(arg, Str)),
+				   Str,
+				   no_expr()))),
+	    single_Features(method(substr,
+				   append_Formals(single_Formals(formal(arg, Int)),
+						  single_Formals(formal(arg2, Int))),
+				   Str,
+				   no_expr()))),
+	     filename),
+        Basic,this));
+
+}
+
+// CgenClassTable::install_class
+// CgenClassTable::install_classes
+//
+// install_classes enters a list of classes in the symbol table.
+//
+void CgenClassTable::install_class(CgenNodeP nd)
+{
+  Symbol name = nd->get_name();
+
+  if (probe(name))
+    {
+      return;
+    }
+
+  // The class name is legal, so add it to the list of classes
+  // and the symbol table.
+  nds.push_back(nd);
+  addid(name,nd);
+}
+
+void CgenClassTable::install_classes(Classes cs)
+{
+  for(int i = cs->first(); cs->more(i); i = cs->next(i))
+    install_class(new CgenNode(cs->nth(i),NotBasic,this));
+}
+
+//
+// CgenClassTable::build_inheritance_tree
+//
+void CgenClassTable::build_inheritance_tree()
+{
+  for (size_t i = 0; i < nds.size(); i++)
+      set_relations(nds[i]);
+}
+
+//
+// CgenClassTable::set_relations
+//
+// Takes a CgenNode and locates its, and its parent's, inheritance nodes
+// via the class table.  Parent and child pointers are added as appropriate.
+//
+void CgenClassTable::set_relations(CgenNodeP nd)
+{
+  if (nd->get_name() == Object)
+    return;
+  CgenNode *parent_node = probe(nd->get_parent());
+  nd->set_parentnd(parent_node);
+  parent_node->add_child(nd);
+}
+
+// Atributos y tabla de dispatch de nd y sus descendientes: cada clase
+// parte de lo que hereda y agrega lo suyo (ver CgenNode en cgen.h).
+void CgenClassTable::build_layout(CgenNodeP nd)
+{
+  CgenNodeP parent = nd->get_parentnd();
+  if (parent != NULL) {
+    nd->attributes = parent->attributes;
+    nd->attr_index = parent->attr_index;
+    nd->disp_table = parent->disp_table;
+    nd->method_index = parent->method_index;
+  }
+
+  Features features = nd->GetFeatures();
+  for (int i = features->first(); features->more(i); i = features->next(i)) {
+    Feature f = features->nth(i);
+    if (f->IsMethod()) {
+      Symbol name = f->GetName();
+      std::map<Symbol, int>::iterator it = nd->method_index.find(name);
+      if (it != nd->method_index.end()) {
+        nd->disp_table[it->second].second = nd->get_name();
+      } else {
+        nd->method_index[name] = nd->disp_table.size();
+        nd->disp_table.push_back(std::make_pair(name, nd->get_name()));
+      }
+    } else {
+      nd->attr_index[f->GetName()] = nd->attributes.size();
+      nd->attributes.push_back((attr_class *) f);
+    }
+  }
+
+  std::vector<CgenNodeP> &children = nd->get_children();
+  for (size_t i = 0; i < children.size(); i++)
+    build_layout(children[i]);
+}
+
+void CgenClassTable::number_classes(CgenNodeP nd)
+{
+  nd->tag = nds.size();
+  nds.push_back(nd);
+  std::vector<CgenNodeP> &children = nd->get_children();
+  for (size_t i = 0; i < children.size(); i++)
+    number_classes(children[i]);
+  nd->last_tag = nds.size() - 1;
+}
+
+void CgenNode::add_child(CgenNodeP n)
+{
+  children.push_back(n);
+}
+
+void CgenNode::set_parentnd(CgenNodeP p)
+{
+  assert(parentnd == NULL);
+  assert(p != NULL);
+  parentnd = p;
+}
+
+method_class *CgenNode::find_method(Symbol method)
+{
+  for (CgenNodeP c = this; c != NULL; c = c->get_parentnd()) {
+    Features features = c->GetFeatures();
+    for (int i = features->first(); features->more(i); i = features->next(i)) {
+      Feature f = features->nth(i);
+      if (f->IsMethod() && f->GetName() == method)
+        return (method_class *) f;
+    }
+  }
+  return NULL;
+}
+
+// Análisis de la jerarquía de clases: el programa está completo, así que
+// si ninguna subclase redefine el método, la implementación que se llama
+// es la misma para cualquier objeto de la clase.
+Symbol CgenNode::unique_impl(Symbol method)
+{
+  Symbol impl = method_impl(method);
+  for (size_t i = 0; i < children.size(); i++)
+    if (children[i]->unique_impl(method) != impl)
+      return NULL;
+  return impl;
+}
+
+// Los atributos heredados van primero, así que attributes[index] lo
+// declara el ancestor más alto que ya lo tiene
+CgenNodeP CgenNode::attr_owner(int index)
+{
+  CgenNodeP owner = this;
+  while (owner->parentnd != NULL && (int) owner->parentnd->attributes.size() > index)
+    owner = owner->parentnd;
+  return owner;
+}
+
+// Clase cuya implementación de method se puede llamar directamente en un
+// dispatch sobre nd, o NULL si hay que pasar por la tabla de dispatch
+Symbol direct_call_target(CgenNodeP nd, Symbol method, bool is_static)
+{
+  if (!cgen_devirt)
+    return NULL;
+  dispatch_sites++;
+  Symbol impl = is_static ? nd->method_impl(method) : nd->unique_impl(method);
+  if (impl != NULL)
+    direct_sites++;
+  return impl;
+}
+
+bool unboxed(Symbol type)
+{
+  return cgen_unbox && (type == Int || type == Bool);
+}
+
+// Los argumentos y el resultado de method van sin caja si el método se
+// declara por primera vez en una clase del programa: las redefiniciones
+// tienen la misma firma, así que todas las implementaciones coinciden.
+bool raw_signature(CgenNodeP nd, Symbol method)
+{
+  CgenNodeP decl = nd;
+  while (decl->get_parentnd() != NULL &&
+         decl->get_parentnd()->method_index.count(method))
+    decl = decl->get_parentnd();
+  return cgen_unbox && !decl->basic();
+}
+
+// Para cada tag gana la rama de la clase más cercana, que es la del
+// intervalo más chico que lo contiene; los tags seguidos con la misma
+// rama forman un tramo.  Hay a lo sumo dos tramos por rama y uno más.
+std::vector<CaseRange> case_ranges(Cases cases)
+{
+  int num_tags = codegen_classtable->nodes().size();
+  std::vector<int> winner(num_tags, -1);
+  std::vector<int> width(num_tags, num_tags);
+  for (int i = cases->first(); cases->more(i); i = cases->next(i)) {
+    CgenNodeP nd = codegen_classtable->lookup_class(((branch_class *) cases->nth(i))->GetTypeDecl());
+    for (int t = nd->tag; t <= nd->last_tag; t++)
+      if (nd->last_tag - nd->tag < width[t]) {
+        width[t] = nd->last_tag - nd->tag;
+        winner[t] = i;
+      }
+  }
+
+  std::vector<CaseRange> ranges;
+  for (int t = 0; t < num_tags; t++)
+    if (ranges.empty() || ranges.back().branch != winner[t]) {
+      CaseRange r = { t, winner[t] };
+      ranges.push_back(r);
+    }
+  return ranges;
+}
+
+CgenNodeP CgenClassTable::lookup_class(Symbol name)
+{
+  if (name == SELF_TYPE)
+    return curr_class;
+  return probe(name);
+}
+
+
+void CgenClassTable::code()
+{
+  // Las optimizaciones sobre el AST van antes de la IR y del código
+  if (getenv(FOLD_ENV) != NULL) {
+    if (cgen_debug) cout << "folding constants" << endl;
+    fold_program(this);
+  }
+
+  // La IR se arma del AST anotado antes de generar el código (ver ir.h)
+  if (getenv(IR_OUT_ENV) != NULL) {
+    if (cgen_debug) cout << "building IR" << endl;
+    ir_write(this, getenv(IR_OUT_ENV));
+  }
+
+  plan_inits();
+
+  if (cgen_debug) cout << "coding global data" << endl;
+  code_global_data();
+
+  if (cgen_target == TARGET_MIPS) {
+    if (cgen_debug) cout << "choosing gc" << endl;
+    code_select_gc();
+  }
+
+  if (cgen_debug) cout << "coding constants" << endl;
+  code_constants();
+
+  if (cgen_debug) cout << "coding class tables" << endl;
+  code_class_tables();
+  code_dispatch_tables();
+  code_prototypes();
+
+  if (cgen_target == TARGET_X86_64) {
+    code_x86();
+    return;
+  }
+
+  if (cgen_debug) cout << "coding global text" << endl;
+  code_global_text();
+
+  if (cgen_debug) cout << "coding init methods" << endl;
+  code_inits();
+
+  if (cgen_debug) cout << "coding methods" << endl;
+  code_methods();
+}
+
+
+CgenNodeP CgenClassTable::root()
+{
+   return probe(Object);
+}
+
+
+///////////////////////////////////////////////////////////////////////
+//
+// CgenNode methods
+//
+///////////////////////////////////////////////////////////////////////
+
+CgenNode::CgenNode(Class_ nd, Basicness bstatus, CgenClassTableP ct) :
+   class__class((const class__class &) *nd),
+   parentnd(NULL),
+   basic_status(bstatus),
+   tag(-1),
+   init_start(0)
+{
+   stringtable.add_string(name->get_string());          // Add class name to string table
+}
+
+
+//******************************************************************
+//
+//   Tablas de las clases
+//
+//   class_nameTab     nombre de cada clase, indexado por tag
+//   class_objTab      prototipo e inicialización de cada clase (new SELF_TYPE)
+//
+//*****************************************************************
+
+void CgenClassTable::code_class_tables()
+{
+  str << CLASSNAMETAB << LABEL;
+  for (size_t i = 0; i < nds.size(); i++) {
+    str << data_word;
+    stringtable.lookup_string(nds[i]->get_name()->get_string())->code_ref(str);
+    str << endl;
+  }
+
+  str << CLASSOBJTAB << LABEL;
+  for (size_t i = 0; i < nds.size(); i++) {
+    str << data_word; emit_protobj_ref(nds[i]->get_name(), str); str << endl;
+    str << data_word; emit_init_ref(nds[i]->get_name(), str); str << endl;
+  }
+}
+
+void CgenClassTable::code_dispatch_tables()
+{
+  for (size_t i = 0; i < nds.size(); i++) {
+    emit_disptable_ref(nds[i]->get_name(), str);
+    str << LABEL;
+    std::vector<std::pair<Symbol, Symbol> > &table = nds[i]->disp_table;
+    for (size_t j = 0; j < table.size(); j++) {
+      str << data_word;
+      emit_method_ref(table[j].second, table[j].first, str);
+      str << endl;
+    }
+  }
+}
+
+// Valor inicial de un atributo en el prototipo: Int, String y Bool
+// arrancan en 0, "" y false, y los demás en void.
+void code_default_value(Symbol type, ostream &s)
+{
+  if (type == Int)
+    inttable.lookup_string((char *) "0")->code_ref(s);
+  else if (type == Str)
+    stringtable.lookup_string((char *) "")->code_ref(s);
+  else if (type == Bool)
+    falsebool.code_ref(s);
+  else
+    s << EMPTYSLOT;
+}
+
+// Calcula init_start de cada clase.  Sólo se pasan al prototipo las
+// constantes del comienzo: una vez que corre código, éste podría leer o
+// cambiar los atributos que siguen antes de su inicialización.  Los Int
+// van a inttable ahora porque code_constants escribe la tabla antes que
+// los prototipos.
+void CgenClassTable::plan_inits()
+{
+  for (size_t i = 0; i < nds.size(); i++) {
+    CgenNodeP nd = nds[i];
+    nd->init_start = 0;
+    while (!nd->trivial_init()) {
+      Expression init = nd->attributes[nd->init_start]->GetInit();
+      FoldValue v;
+      if (!init->IsNoExpr()) {
+        if (!init->GetConstant(v))
+          break;
+        if (v.kind == FoldValue::INT)
+          inttable.add_int(v.value);
+      }
+      nd->init_start++;
+    }
+  }
+}
+
+// Palabra del prototipo para un atributo que se inicializa con la constante v
+static void code_constant_value(const FoldValue &v, bool raw, ostream &s)
+{
+  if (raw)
+    s << v.value;
+  else if (v.kind == FoldValue::INT)
+    inttable.add_int(v.value)->code_ref(s);
+  else if (v.kind == FoldValue::BOOL)
+    (v.value ? truebool : falsebool).code_ref(s);
+  else
+    ((StringEntryP) v.str)->code_ref(s);
+}
+
+void CgenClassTable::code_prototypes()
+{
+  for (size_t i = 0; i < nds.size(); i++) {
+    CgenNodeP nd = nds[i];
+    str << data_word << "-1" << endl;
+    emit_protobj_ref(nd->get_name(), str);
+    str << LABEL
+        << data_word << nd->tag << endl
+        << data_word << (DEFAULT_OBJFIELDS + nd->attributes.size()) << endl
+        << data_word;
+    emit_disptable_ref(nd->get_name(), str);
+    str << endl;
+    for (size_t j = 0; j < nd->attributes.size(); j++) {
+      str << data_word;
+      Symbol type = nd->attributes[j]->GetTypeDecl();
+      bool raw = !nd->basic() && unboxed(type);
+      FoldValue v;
+      if ((int) j < nd->init_start && nd->attributes[j]->GetInit()->GetConstant(v))
+        code_constant_value(v, raw, str);
+      else if (raw)
+        str << 0;
+      else
+        code_default_value(type, str);
+      str << endl;
+    }
+  }
+}
+
+//******************************************************************
+//
+//   Métodos e inicialización
+//
+//   Todos los métodos usan el mismo marco:
+//
+//      argumentos      apilados por quien llama, el primero más arriba
+//      $fp anterior
+//      $s0 anterior    (self de quien llama)
+//      $ra             <- $fp
+//      locales         let y ramas de case, $fp - 4, $fp - 8, ...
+//      $s1, $s2, ...   los que usen los temporales (COOL_REGALLOC)
+//                      <- $sp
+//
+//   Quien llama apila los argumentos y deja self en $a0; el método
+//   devuelve su valor en $a0 y saca los argumentos de la pila.  Los
+//   temporales de las expresiones se apilan debajo de los locales.
+//
+//*****************************************************************
+
+// Registros para los temporales (COOL_REGALLOC): los $t no se preservan en
+// las llamadas y los $s sí (trap.handler no los toca)
+static const char *caller_temps[] = { "$t4", "$t5", "$t6", "$t7", "$t8", "$t9" };
+static const char *callee_temps[] = { "$s1", "$s2", "$s3", "$s4", "$s5", "$s6", "$s7" };
+#define NUM_CALLER_TEMPS (int) (sizeof(caller_temps) / sizeof(caller_temps[0]))
+#define NUM_CALLEE_TEMPS (int) (sizeof(callee_temps) / sizeof(callee_temps[0]))
+
+// Escribe el método cuyo cuerpo ya está en body: el prólogo se escribe
+// después de generar el cuerpo porque hasta entonces no se sabe cuántas
+// casillas para locales necesita ni qué registros $s usa.  Esos se
+// guardan en el marco, después de los locales.
+static void emit_method(ostream &s, int num_args, int num_locals, int num_saved,
+                        const std::string &body)
+{
+  int frame = 3 + num_locals + num_saved;
+  emit_addiu(SP, SP, -frame * WORD_SIZE, s);
+  emit_store(FP, frame, SP, s);
+  emit_store(SELF, frame - 1, SP, s);
+  emit_store(RA, frame - 2, SP, s);
+  for (int i = 0; i < num_saved; i++)
+    emit_store(callee_temps[i], num_saved - i, SP, s);
+  emit_addiu(FP, SP, (frame - 2) * WORD_SIZE, s);
+  emit_move(SELF, ACC, s);
+
+  s << body;
+
+  for (int i = 0; i < num_saved; i++)
+    emit_load(callee_temps[i], num_saved - i, SP, s);
+  emit_load(FP, frame, SP, s);
+  emit_load(SELF, frame - 1, SP, s);
+  emit_load(RA, frame - 2, SP, s);
+  emit_addiu(SP, SP, (frame + num_args) * WORD_SIZE, s);
+  emit_return(s);
+}
+
+// Los atributos de la clase actual quedan visibles para los métodos y las
+// inicializaciones
+void enter_class(CgenNodeP nd)
+{
+  curr_class = nd;
+  var_env = new SymbolTable<Symbol, VarLocation>();
+  var_env->enterscope();
+  for (size_t i = 0; i < nd->attributes.size(); i++) {
+    VarLocation *loc = new VarLocation;
+    loc->kind = VarLocation::ATTR;
+    loc->offset = DEFAULT_OBJFIELDS + i;
+    loc->raw = !nd->basic() && unboxed(nd->attributes[i]->GetTypeDecl());
+    var_env->addid(nd->attributes[i]->GetName(), loc);
+  }
+  next_local = 0;
+  max_locals = 0;
+  temps_saved = 0;
+}
+
+static void emit_store_var(VarLocation *loc, ostream &s);
+static void emit_convert(Symbol type, bool from_raw, bool to_raw, ostream &s);
+
+// La inicialización de una clase evalúa también las de sus ancestros, en
+// el orden de attributes (de Object hacia abajo), desde init_start.  Cada
+// una se genera como en la clase que la declara, para que SELF_TYPE y el
+// archivo de los errores sean los mismos que si la llamara el padre.
+void CgenClassTable::code_inits()
+{
+  for (size_t i = 0; i < nds.size(); i++) {
+    CgenNodeP nd = nds[i];
+    emit_init_ref(nd->get_name(), str);
+    str << LABEL;
+    if (nd->trivial_init()) {
+      emit_return(str);       // $a0 ya es el objeto
+      continue;
+    }
+    enter_class(nd);
+
+    std::ostringstream body;
+    for (size_t j = nd->init_start; j < nd->attributes.size(); j++) {
+      Expression init = nd->attributes[j]->GetInit();
+      if (init->IsNoExpr())
+        continue;
+      curr_class = nd->attr_owner(j);
+      init->code(body);
+      VarLocation *loc = var_env->lookup(nd->attributes[j]->GetName());
+      emit_convert(init->get_type(), unboxed(init->get_type()), loc->raw, body);
+      emit_store_var(loc, body);
+    }
+    curr_class = nd;
+    emit_move(ACC, SELF, body);
+
+    emit_method(str, 0, max_locals, temps_saved, body.str());
+  }
+}
+
+void CgenClassTable::code_methods()
+{
+  for (size_t i = 0; i < nds.size(); i++) {
+    CgenNodeP nd = nds[i];
+    if (nd->basic())
+      continue;     // están en el runtime (trap.handler)
+    enter_class(nd);
+
+    Features features = nd->GetFeatures();
+    for (int j = features->first(); features->more(j); j = features->next(j)) {
+      Feature f = features->nth(j);
+      if (!f->IsMethod())
+        continue;
+      method_class *method = (method_class *) f;
+      Formals formals = method->GetFormals();
+      int num_args = formals->len();
+      bool raw = raw_signature(nd, method->GetName());
+
+      var_env->enterscope();
+      for (int k = formals->first(); formals->more(k); k = formals->next(k)) {
+        VarLocation *loc = new VarLocation;
+        loc->kind = VarLocation::ARG;
+        loc->offset = 2 + num_args - k;
+        loc->raw = raw && unboxed(formals->nth(k)->GetType());
+        var_env->addid(formals->nth(k)->GetName(), loc);
+      }
+      next_local = 0;
+      max_locals = 0;
+      temps_saved = 0;
+      std::ostringstream body;
+      Expression expr = method->GetExpr();
+      expr->code(body);
+      emit_convert(expr->get_type(), unboxed(expr->get_type()),
+                   raw && unboxed(method->GetType()), body);
+      var_env->exitscope();
+
+      emit_method_ref(nd->get_name(), method->GetName(), str);
+      str << LABEL;
+      emit_method(str, num_args, max_locals, temps_saved, body.str());
+    }
+  }
+}
+
+//******************************************************************
+//
+//   Fill in the following methods to produce code for the
+//   appropriate expression.  You may add or remove parameters
+//   as you wish, but if you do, remember to change the parameters
+//   of the declarations in `cool-tree.h'  Sample code for
+//   constant integers, strings, and booleans are provided.
+//
+//   Todas dejan el valor de la expresión en $a0.
+//
+//*****************************************************************
+
+int new_label()
+{
+  return label_count++;
+}
+
+// Reserva una casilla del marco, sin nombre
+VarLocation *new_slot()
+{
+  VarLocation *loc = new VarLocation;
+  loc->kind = VarLocation::LOCAL;
+  loc->offset = -(next_local + 1);
+  next_local++;
+  if (next_local > max_locals)
+    max_locals = next_local;
+  return loc;
+}
+
+// Reserva una casilla del marco para un let o una rama de case
+VarLocation *new_local(Symbol name)
+{
+  VarLocation *loc = new_slot();
+  var_env->enterscope();
+  var_env->addid(name, loc);
+  return loc;
+}
+
+void free_local()
+{
+  var_env->exitscope();
+  next_local--;
+}
+
+// Temporales (COOL_REGALLOC, ver cgen.h).  Se reserva un registro de cada
+// grupo antes de generar el segundo operando, para que los temporales de
+// adentro no los usen, y al terminar se elige según si hubo llamadas.
+Temp temp_reserve(int caller_regs, int callee_regs)
+{
+  Temp t;
+  t.kind = TEMP_STACK;
+  t.reg = -1;
+  t.spill = NULL;
+  t.calls = calls_emitted;
+  if (!cgen_regalloc)
+    return t;
+  t.caller = temp_depth[0] < caller_regs ? temp_depth[0]++ : -1;
+  t.callee = temp_depth[1] < callee_regs ? temp_depth[1]++ : -1;
+  if (t.callee < 0)
+    t.spill = new_slot();
+  return t;
+}
+
+// call: hay una llamada después del segundo operando y antes de usar el
+// temporal
+void temp_release(Temp &t, bool call)
+{
+  if (!cgen_regalloc)
+    return;
+  if (t.caller >= 0)
+    temp_depth[0]--;
+  if (t.callee >= 0)
+    temp_depth[1]--;
+  if (t.spill != NULL)
+    next_local--;
+
+  if (!call && calls_emitted == t.calls && t.caller >= 0) {
+    t.kind = TEMP_CALLER;
+    t.reg = t.caller;
+  } else if (t.callee >= 0) {
+    t.kind = TEMP_CALLEE;
+    t.reg = t.callee;
+    if (t.reg + 1 > temps_saved)
+      temps_saved = t.reg + 1;
+  } else {
+    t.kind = TEMP_SPILL;
+  }
+  temp_count[t.kind]++;
+}
+
+//******************************************************************
+//
+//   Inlining (COOL_INLINE, ver cgen.h)
+//
+//*****************************************************************
+
+static int inline_depth = 0;
+
+static int inline_size(Expression e)
+{
+  int size = 1;
+  for (int i = 0; i < e->NumChildren(); i++)
+    size += inline_size(e->Child(i));
+  return size;
+}
+
+// Método que se puede copiar en un dispatch sobre nd: se sabe cuál es
+// (como en COOL_DEVIRT), no es del runtime y cabe en el presupuesto
+method_class *inline_target(CgenNodeP nd, Symbol name, bool is_static, CgenNodeP *impl)
+{
+  if (inline_budget <= 0 || inline_depth >= INLINE_DEPTH)
+    return NULL;
+  Symbol impl_name = is_static ? nd->method_impl(name) : nd->unique_impl(name);
+  if (impl_name == NULL)
+    return NULL;
+  *impl = codegen_classtable->probe(impl_name);
+  if ((*impl)->basic())
+    return NULL;
+  method_class *method = (*impl)->find_method(name);
+  if (inline_size(method->GetExpr()) > inline_budget)
+    return NULL;
+  inlined_sites++;
+  return method;
+}
+
+// El cuerpo copiado se genera como el del método: en su clase, viendo
+// sus atributos (desde self, que ya es el receptor) y sus argumentos, que
+// están en las casillas args del marco de quien llama
+InlineFrame enter_inline(CgenNodeP impl, method_class *method, const std::vector<VarLocation *> &args)
+{
+  InlineFrame saved = { curr_class, var_env };
+  int next = next_local, max = max_locals, temps = temps_saved;
+  enter_class(impl);
+  next_local = next;
+  max_locals = max;
+  temps_saved = temps;
+
+  Formals formals = method->GetFormals();
+  var_env->enterscope();
+  for (int i = formals->first(); formals->more(i); i = formals->next(i))
+    var_env->addid(formals->nth(i)->GetName(), args[i]);
+  inline_depth++;
+  return saved;
+}
+
+void leave_inline(const InlineFrame &saved)
+{
+  curr_class = saved.cls;
+  var_env = saved.env;
+  inline_depth--;
+}
+
+static void emit_load_var(VarLocation *loc, ostream &s)
+{
+  emit_load(ACC, loc->offset, loc->kind == VarLocation::ATTR ? SELF : FP, s);
+}
+
+static void emit_store_var(VarLocation *loc, ostream &s)
+{
+  if (loc->kind != VarLocation::ATTR) {
+    emit_store(ACC, loc->offset, FP, s);
+    return;
+  }
+  emit_store(ACC, loc->offset, SELF, s);
+  if (cgen_Memmgr != GC_NOGC && !loc->raw) {
+    emit_addiu(A1, SELF, loc->offset * WORD_SIZE, s);
+    emit_gc_assign(s);
+  }
+}
+
+// Valores sin caja (COOL_UNBOX)
+// ============================
+// El valor de un Bool sin caja es 0 o 1; el de un Int, el entero.
+
+// Un Bool en dest: el número o la constante, según cómo vayan los Bool
+static void emit_bool_value(const char *dest, bool val, ostream &s)
+{
+  if (cgen_unbox)
+    emit_load_imm(dest, val, s);
+  else
+    emit_load_bool(dest, BoolConst(val), s);
+}
+
+// Salta a label si el Bool de reg es false
+static void emit_branch_false(const char *reg, int label, ostream &s)
+{
+  if (!cgen_unbox) {
+    emit_fetch_int(T1, reg, s);
+    reg = T1;
+  }
+  emit_beqz(reg, label, s);
+}
+
+// Pone en una caja el Int o Bool sin caja de $a0
+static void emit_box(Symbol type, ostream &s)
+{
+  if (type == Bool) {
+    int done = new_label();
+    emit_move(T1, ACC, s);
+    emit_load_bool(ACC, truebool, s);
+    emit_bne(T1, ZERO, done, s);
+    emit_load_bool(ACC, falsebool, s);
+    emit_label_def(done, s);
+    return;
+  }
+  emit_push(ACC, s);
+  emit_partial_load_address(ACC, s);
+  emit_protobj_ref(Int, s);
+  s << endl;
+  emit_jal("Object.copy", s);
+  emit_pop(T1, s);
+  emit_store_int(T1, ACC, s);
+}
+
+// Pasa el valor de tipo type que está en $a0 de una representación a otra
+static void emit_convert(Symbol type, bool from_raw, bool to_raw, ostream &s)
+{
+  if (from_raw && !to_raw)
+    emit_box(type, s);
+  else if (!from_raw && to_raw)
+    emit_fetch_int(ACC, ACC, s);
+}
+
+// Deja en $a0 el valor de e como lo quiere quien lo usa
+static void code_as(Expression e, bool raw, ostream &s)
+{
+  e->code(s);
+  emit_convert(e->get_type(), unboxed(e->get_type()), raw, s);
+}
+
+// Aborta con el archivo y la línea de e si $a0 es void
+static void emit_void_check(tree_node *e, const char *handler, ostream &s)
+{
+  int ok = new_label();
+  emit_bne(ACC, ZERO, ok, s);
+  emit_load_string(ACC, (StringEntryP) curr_class->get_filename(), s);
+  emit_load_imm(T1, e->get_line_number(), s);
+  emit_jal(handler, s);
+  emit_label_def(ok, s);
+}
+
+// Dispatch: apila los argumentos, evalúa el receptor y llama al método por
+// la tabla de dispatch del objeto (static_type == NULL) o por la de
+// static_type, o directamente si se sabe cuál es (COOL_DEVIRT).
+static void code_inline(Expression e, Expression expr, CgenNodeP impl, method_class *method,
+                        Expressions actual, ostream &s);
+
+static void code_dispatch(Expression e, Expression expr, Symbol static_type,
+                          Symbol name, Expressions actual, ostream &s)
+{
+  CgenNodeP nd = codegen_classtable->lookup_class(static_type ? static_type : expr->get_type());
+  CgenNodeP impl;
+  method_class *method = inline_target(nd, name, static_type != NULL, &impl);
+  if (method != NULL) {
+    code_inline(e, expr, impl, method, actual, s);
+    return;
+  }
+
+  method = nd->find_method(name);
+  bool raw = raw_signature(nd, name);
+  Formals formals = method->GetFormals();
+  for (int i = actual->first(); actual->more(i); i = actual->next(i)) {
+    code_as(actual->nth(i), raw && unboxed(formals->nth(i)->GetType()), s);
+    emit_push(ACC, s);
+  }
+  code_as(expr, false, s);
+  emit_void_check(e, "_dispatch_abort", s);
+
+  Symbol direct = direct_call_target(nd, name, static_type != NULL);
+  if (direct != NULL) {
+    calls_emitted++;
+    s << JAL;
+    emit_method_ref(direct, name, s);
+    s << endl;
+  } else {
+    if (static_type) {
+      emit_partial_load_address(T1, s);
+      emit_disptable_ref(static_type, s);
+      s << endl;
+    } else {
+      emit_load(T1, DISPTABLE_OFFSET, ACC, s);
+    }
+    emit_load(T1, nd->method_offset(name), T1, s);
+    emit_jalr(T1, s);
+  }
+  // Un método de SELF_TYPE sobre un Int o Bool devuelve la caja
+  emit_convert(e->get_type(), raw && unboxed(method->GetType()), unboxed(e->get_type()), s);
+}
+
+// Dispatch con el cuerpo del método en lugar de la llamada: los
+// argumentos pasan a casillas del marco (como si fueran un let), self
+// ($s0) se cambia por el receptor mientras corre el cuerpo y se recupera
+// al final
+static void code_inline(Expression e, Expression expr, CgenNodeP impl, method_class *method,
+                        Expressions actual, ostream &s)
+{
+  std::vector<VarLocation *> args;
+  Formals formals = method->GetFormals();
+  for (int i = actual->first(); actual->more(i); i = actual->next(i)) {
+    args.push_back(new_slot());
+    args.back()->raw = unboxed(formals->nth(i)->GetType());
+    code_as(actual->nth(i), args.back()->raw, s);
+    emit_store(ACC, args.back()->offset, FP, s);
+  }
+  code_as(expr, false, s);
+  emit_void_check(e, "_dispatch_abort", s);
+
+  VarLocation *saved_self = new_slot();
+  emit_store(SELF, saved_self->offset, FP, s);
+  emit_move(SELF, ACC, s);
+  InlineFrame frame = enter_inline(impl, method, args);
+  code_as(method->GetExpr(), unboxed(e->get_type()), s);
+  leave_inline(frame);
+  emit_load(SELF, saved_self->offset, FP, s);
+  next_local -= args.size() + 1;
+}
+
+// Si la variable guarda la caja, $a0 vuelve a quedar sin caja
+void assign_class::code(ostream &s) {
+  expr->code(s);
+  VarLocation *loc = var_env->lookup(name);
+  if (unboxed(expr->get_type()) && !loc->raw) {
+    emit_box(expr->get_type(), s);
+    emit_store_var(loc, s);
+    emit_fetch_int(ACC, ACC, s);
+    return;
+  }
+  emit_store_var(loc, s);
+}
+
+void static_dispatch_class::code(ostream &s) {
+  code_dispatch(this, expr, type_name, name, actual, s);
+}
+
+void dispatch_class::code(ostream &s) {
+  code_dispatch(this, expr, NULL, name, actual, s);
+}
+
+void cond_class::code(ostream &s) {
+  int false_label = new_label();
+  int end_label = new_label();
+  pred->code(s);
+  emit_branch_false(ACC, false_label, s);
+  code_as(then_exp, unboxed(type), s);
+  emit_branch(end_label, s);
+  emit_label_def(false_label, s);
+  code_as(else_exp, unboxed(type), s);
+  emit_label_def(end_label, s);
+}
+
+void loop_class::code(ostream &s) {
+  int loop_label = new_label();
+  int end_label = new_label();
+  emit_label_def(loop_label, s);
+  pred->code(s);
+  emit_branch_false(ACC, end_label, s);
+  body->code(s);
+  emit_branch(loop_label, s);
+  emit_label_def(end_label, s);
+  emit_move(ACC, ZERO, s);
+}
+
+// Busca el tramo de ranges[lo..hi) donde está el tag de $t2 partiendo a
+// la mitad, y salta a su rama
+static void emit_case_search(const std::vector<CaseRange> &ranges, int lo, int hi,
+                             const std::vector<int> &labels, int abort_label, ostream &s)
+{
+  if (hi - lo == 1) {
+    emit_branch(ranges[lo].branch < 0 ? abort_label : labels[ranges[lo].branch], s);
+    return;
+  }
+  int mid = (lo + hi) / 2;
+  int upper = new_label();
+  emit_bgti(T2, ranges[mid].first - 1, upper, s);
+  emit_case_search(ranges, lo, mid, labels, abort_label, s);
+  emit_label_def(upper, s);
+  emit_case_search(ranges, mid, hi, labels, abort_label, s);
+}
+
+// Se gana la rama de la clase más cercana al tipo del objeto.  Con los
+// tags en preorden eso se sabe en compilación para cada tag (case_ranges),
+// así que basta buscar el tramo del tag del objeto: O(log ramas)
+// comparaciones.
+void typcase_class::code(ostream &s) {
+  code_as(expr, false, s);
+  emit_void_check(this, "_case_abort2", s);
+
+  int end_label = new_label();
+  int abort_label = new_label();
+  std::vector<int> branch_labels;
+  for (int i = cases->first(); cases->more(i); i = cases->next(i))
+    branch_labels.push_back(new_label());
+
+  std::vector<CaseRange> ranges = case_ranges(cases);
+  emit_load(T2, TAG_OFFSET, ACC, s);
+  emit_case_search(ranges, 0, ranges.size(), branch_labels, abort_label, s);
+  emit_label_def(abort_label, s);
+  emit_jal("_case_abort", s);
+
+  for (int i = cases->first(); cases->more(i); i = cases->next(i)) {
+    branch_class *b = (branch_class *) cases->nth(i);
+    emit_label_def(branch_labels[i], s);
+    VarLocation *loc = new_local(b->GetName());
+    emit_store_var(loc, s);
+    code_as(b->GetExpr(), unboxed(type), s);
+    free_local();
+    emit_branch(end_label, s);
+  }
+  emit_label_def(end_label, s);
+}
+
+void block_class::code(ostream &s) {
+  for (int i = body->first(); body->more(i); i = body->next(i))
+    body->nth(i)->code(s);
+}
+
+void let_class::code(ostream &s) {
+  bool raw = unboxed(type_decl);
+  if (!init->IsNoExpr()) {
+    code_as(init, raw, s);
+  } else if (raw) {
+    emit_load_imm(ACC, 0, s);
+  } else if (type_decl == Int || type_decl == Str || type_decl == Bool) {
+    emit_partial_load_address(ACC, s);
+    code_default_value(type_decl, s);
+    s << endl;
+  } else {
+    emit_move(ACC, ZERO, s);
+  }
+  VarLocation *loc = new_local(identifier);
+  loc->raw = raw;
+  emit_store_var(loc, s);
+  body->code(s);
+  free_local();
+}
+
+// Evalúa e1 y después e2, con e1 en un temporal (ver Temp en cgen.h)
+// mientras tanto; quien llama lo saca con emit_temp_restore.  El código
+// de e2 se genera aparte porque dónde va el temporal depende de si e2
+// tiene llamadas.  boxed: los dos quedan en caja aunque su tipo se use
+// sin caja.  call: hay otra llamada antes de sacarlo.
+static Temp code_operands(Expression e1, Expression e2, bool boxed, bool call, ostream &s)
+{
+  code_as(e1, !boxed && unboxed(e1->get_type()), s);
+  Temp t = temp_reserve(NUM_CALLER_TEMPS, NUM_CALLEE_TEMPS);
+  std::ostringstream second;
+  code_as(e2, !boxed && unboxed(e2->get_type()), second);
+  temp_release(t, call);
+
+  switch (t.kind) {
+  case TEMP_STACK:  emit_push(ACC, s); break;
+  case TEMP_CALLER: emit_move(caller_temps[t.reg], ACC, s); break;
+  case TEMP_CALLEE: emit_move(callee_temps[t.reg], ACC, s); break;
+  case TEMP_SPILL:  emit_store(ACC, t.spill->offset, FP, s); break;
+  }
+  s << second.str();
+  return t;
+}
+
+static void emit_temp_restore(const Temp &t, const char *dest, ostream &s)
+{
+  switch (t.kind) {
+  case TEMP_STACK:  emit_pop(dest, s); break;
+  case TEMP_CALLER: emit_move(dest, caller_temps[t.reg], s); break;
+  case TEMP_CALLEE: emit_move(dest, callee_temps[t.reg], s); break;
+  case TEMP_SPILL:  emit_load(dest, t.spill->offset, FP, s); break;
+  }
+}
+
+// Aritmética: el primer operando queda en un temporal mientras se evalúa
+// el segundo, y el resultado va en una copia del segundo (los Int son
+// inmutables).  Sin caja no hay copia.
+static void code_arith(Expression e1, Expression e2, const char *op, ostream &s)
+{
+  Temp t = code_operands(e1, e2, false, !cgen_unbox, s);
+  if (cgen_unbox) {
+    emit_temp_restore(t, T1, s);
+    s << op << ACC << " " << T1 << " " << ACC << endl;
+    return;
+  }
+  emit_jal("Object.copy", s);
+  emit_temp_restore(t, T1, s);
+  emit_fetch_int(T1, T1, s);
+  emit_fetch_int(T2, ACC, s);
+  s << op << T1 << " " << T1 << " " << T2 << endl;
+  emit_store_int(T1, ACC, s);
+}
+
+void plus_class::code(ostream &s) {
+  code_arith(e1, e2, ADD, s);
+}
+
+void sub_class::code(ostream &s) {
+  code_arith(e1, e2, SUB, s);
+}
+
+void mul_class::code(ostream &s) {
+  code_arith(e1, e2, MUL, s);
+}
+
+void divide_class::code(ostream &s) {
+  code_arith(e1, e2, DIV, s);
+}
+
+void neg_class::code(ostream &s) {
+  e1->code(s);
+  if (cgen_unbox) {
+    emit_neg(ACC, ACC, s);
+    return;
+  }
+  emit_jal("Object.copy", s);
+  emit_fetch_int(T1, ACC, s);
+  emit_neg(T1, T1, s);
+  emit_store_int(T1, ACC, s);
+}
+
+// Comparaciones de enteros: $a0 queda en true y se cambia a false si no
+// se cumple la condición
+static void code_compare(Expression e1, Expression e2, bool strict, ostream &s)
+{
+  Temp t = code_operands(e1, e2, false, false, s);
+  emit_temp_restore(t, T1, s);
+  if (cgen_unbox) {
+    emit_move(T2, ACC, s);
+  } else {
+    emit_fetch_int(T1, T1, s);
+    emit_fetch_int(T2, ACC, s);
+  }
+  int done = new_label();
+  emit_bool_value(ACC, true, s);
+  if (strict)
+    emit_blt(T1, T2, done, s);
+  else
+    emit_bleq(T1, T2, done, s);
+  emit_bool_value(ACC, false, s);
+  emit_label_def(done, s);
+}
+
+void lt_class::code(ostream &s) {
+  code_compare(e1, e2, true, s);
+}
+
+// Los objetos iguales son iguales; si no, equality_test compara el valor
+// de los Int, String y Bool.  Los Int y Bool sin caja se comparan ahí
+// mismo (semant sólo deja compararlos con otros del mismo tipo).
+// Se comparan sin caja sólo si los dos tipos van sin caja: con COOL_FOLD
+// un operando de tipo Object puede haber quedado como una constante Int
+void eq_class::code(ostream &s) {
+  bool raw = unboxed(e1->get_type()) && unboxed(e2->get_type());
+  Temp t = code_operands(e1, e2, !raw, false, s);
+  emit_temp_restore(t, T1, s);
+  emit_move(T2, ACC, s);
+  int done = new_label();
+  emit_bool_value(ACC, true, s);
+  emit_beq(T1, T2, done, s);
+  if (raw) {
+    emit_bool_value(ACC, false, s);
+  } else {
+    emit_bool_value(A1, false, s);
+    emit_jal("equality_test", s);
+  }
+  emit_label_def(done, s);
+}
+
+void leq_class::code(ostream &s) {
+  code_compare(e1, e2, false, s);
+}
+
+void comp_class::code(ostream &s) {
+  e1->code(s);
+  emit_move(T2, ACC, s);
+  int done = new_label();
+  emit_bool_value(ACC, true, s);
+  emit_branch_false(T2, done, s);
+  emit_bool_value(ACC, false, s);
+  emit_label_def(done, s);
+}
+
+void int_const_class::code(ostream& s)
+{
+  //
+  // Need to be sure we have an IntEntry *, not an arbitrary Symbol
+  //
+  if (cgen_unbox)
+    emit_load_imm(ACC, atoi(token->get_string()), s);
+  else
+    emit_load_int(ACC,inttable.lookup_string(token->get_string()),s);
+}
+
+void string_const_class::code(ostream& s)
+{
+  emit_load_string(ACC,stringtable.lookup_string(token->get_string()),s);
+}
+
+void bool_const_class::code(ostream& s)
+{
+  emit_bool_value(ACC, val, s);
+}
+
+// new SELF_TYPE busca el prototipo y la inicialización de la clase de
+// self en class_objTab
+void new__class::code(ostream &s) {
+  if (unboxed(type_name)) {
+    emit_load_imm(ACC, 0, s);
+    return;
+  }
+  if (type_name != SELF_TYPE) {
+    emit_partial_load_address(ACC, s);
+    emit_protobj_ref(type_name, s);
+    s << endl;
+    emit_jal("Object.copy", s);
+    if (!codegen_classtable->lookup_class(type_name)->trivial_init()) {
+      calls_emitted++;
+      s << JAL;
+      emit_init_ref(type_name, s);
+      s << endl;
+    }
+    return;
+  }
+  emit_load_address(T1, CLASSOBJTAB, s);
+  emit_load(T2, TAG_OFFSET, SELF, s);
+  emit_sll(T2, T2, LOG_WORD_SIZE + 1, s);
+  emit_addu(T1, T1, T2, s);
+  emit_push(T1, s);
+  emit_load(ACC, 0, T1, s);
+  emit_jal("Object.copy", s);
+  emit_pop(T1, s);
+  emit_load(T1, 1, T1, s);
+  emit_jalr(T1, s);
+}
+
+void isvoid_class::code(ostream &s) {
+  e1->code(s);
+  if (unboxed(e1->get_type())) {
+    emit_bool_value(ACC, false, s);
+    return;
+  }
+  emit_move(T1, ACC, s);
+  int done = new_label();
+  emit_bool_value(ACC, true, s);
+  emit_beqz(T1, done, s);
+  emit_bool_value(ACC, false, s);
+  emit_label_def(done, s);
+}
+
+void no_expr_class::code(ostream &s) {
+  emit_move(ACC, ZERO, s);
+}
+
+void object_class::code(ostream &s) {
+  if (name == self) {
+    emit_move(ACC, SELF, s);
+    return;
+  }
+  VarLocation *loc = var_env->lookup(name);
+  emit_load_var(loc, s);
+  emit_convert(type, loc->raw, unboxed(type), s);
+}
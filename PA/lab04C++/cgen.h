@@ -0,0 +1,250 @@
+#include <assert.h>
+#include <stdio.h>
+#include <map>
+#include <vector>
+#include "cool-tree.h"
+#include "emit.h"     // después de cool-tree.h: su ALIGN taparía el de ASTArena
+#include "emit-x86.h"
+#include "symtab.h"
+
+enum Basicness     {Basic, NotBasic};
+#define TRUE 1
+#define FALSE 0
+
+class CgenClassTable;
+typedef CgenClassTable *CgenClassTableP;
+
+class CgenNode;
+typedef CgenNode *CgenNodeP;
+
+//Partes extraídas de: https://github.com/skyzluo/CS143-Compilers-Stanford
+
+class CgenClassTable : public SymbolTable<Symbol,CgenNode> {
+private:
+   std::vector<CgenNodeP> nds;   // clases en preorden del árbol de herencia (= tag)
+   ostream& str;
+   int stringclasstag;
+   int intclasstag;
+   int boolclasstag;
+
+
+// The following methods emit code for
+// constants and global declarations.
+
+   void code_global_data();
+   void code_global_text();
+   void code_bools(int);
+   void code_select_gc();
+   void code_constants();
+
+// Tablas por clase y código de cada clase
+
+   void plan_inits();
+   void code_class_tables();
+   void code_dispatch_tables();
+   void code_prototypes();
+   void code_inits();
+   void code_methods();
+
+// Código de x86-64 (cgen-x86.cc)
+
+   void code_x86();
+   void code_x86_global_text();
+   void code_x86_inits();
+   void code_x86_methods();
+
+// The following creates an inheritance graph from
+// a list of classes.  The graph is implemented as
+// a tree of `CgenNode', and class names are placed
+// in the base class symbol table.
+
+   void install_basic_classes();
+   void install_class(CgenNodeP nd);
+   void install_classes(Classes cs);
+   void build_inheritance_tree();
+   void set_relations(CgenNodeP nd);
+   void build_layout(CgenNodeP nd);
+   void number_classes(CgenNodeP nd);
+public:
+   CgenClassTable(Classes, ostream& str);
+   void code();
+   CgenNodeP root();
+   std::vector<CgenNodeP> &nodes() { return nds; }
+   CgenNodeP lookup_class(Symbol name);   // SELF_TYPE es la clase actual
+};
+
+
+class CgenNode : public class__class {
+private:
+   CgenNodeP parentnd;                        // Parent of class
+   std::vector<CgenNodeP> children;           // Children of class
+   Basicness basic_status;                    // `Basic' if class is basic
+                                              // `NotBasic' otherwise
+
+public:
+   int tag;                                   // índice en class_nameTab/class_objTab
+   int last_tag;                              // tag del último descendiente (preorden)
+
+   // Organización de los objetos: los atributos heredados van primero, en
+   // el orden en que se declaran desde Object hacia abajo, y la tabla de
+   // dispatch guarda para cada método la clase que lo implementa.  Un
+   // método redefinido conserva la posición que tenía en el padre.
+   std::vector<attr_class *> attributes;
+   std::map<Symbol, int> attr_index;          // atributo -> posición en attributes
+   std::vector<std::pair<Symbol, Symbol> > disp_table;   // (método, clase que lo define)
+   std::map<Symbol, int> method_index;        // método -> posición en disp_table
+
+   // Los atributos desde 0 hasta init_start - 1 no tienen inicialización o
+   // la tienen constante, y ese valor ya está en el prototipo; la rutina de
+   // inicialización (una sola por clase, sin llamar a la del padre) evalúa
+   // las de los siguientes.  Si son todos, new no la llama.
+   int init_start;
+
+   CgenNode(Class_ c,
+            Basicness bstatus,
+            CgenClassTableP class_table);
+
+   void add_child(CgenNodeP child);
+   std::vector<CgenNodeP> &get_children() { return children; }
+   void set_parentnd(CgenNodeP p);
+   CgenNodeP get_parentnd() { return parentnd; }
+   int basic() { return (basic_status == Basic); }
+
+   int attr_offset(Symbol attr) { return DEFAULT_OBJFIELDS + attr_index[attr]; }
+   int method_offset(Symbol method) { return method_index[method]; }
+   method_class *find_method(Symbol method);   // en esta clase o en un ancestro
+   Symbol method_impl(Symbol method) { return disp_table[method_offset(method)].second; }
+   Symbol unique_impl(Symbol method);          // NULL si alguna subclase lo redefine
+   CgenNodeP attr_owner(int index);            // clase que declara attributes[index]
+   bool trivial_init() { return init_start == (int) attributes.size(); }
+};
+
+class BoolConst
+{
+ private:
+  int val;
+ public:
+  BoolConst(int);
+  void code_def(ostream&, int boolclasstag);
+  void code_ref(ostream&) const;
+};
+
+// Dónde vive una variable del programa en el código generado: los
+// atributos se leen desde self ($s0) y los argumentos y variables locales
+// (let y ramas de case) desde el marco del método ($fp).  offset va en
+// palabras.  raw: la casilla guarda un Int o Bool sin caja (COOL_UNBOX).
+struct VarLocation {
+   enum Kind { ATTR, ARG, LOCAL } kind;
+   int offset;
+   bool raw;
+
+   VarLocation() : kind(LOCAL), offset(0), raw(false) {}
+};
+
+// Máquina para la que se genera código: MIPS para spim (por defecto) o
+// x86-64 System V con COOL_TARGET=x86-64, que se enlaza con cool-runtime.c
+#define TARGET_ENV "COOL_TARGET"
+
+enum Target { TARGET_MIPS, TARGET_X86_64 };
+extern Target cgen_target;
+
+// Rama de un case que gana para los tags desde first hasta el first del
+// tramo siguiente; -1 si ninguna (_case_abort)
+struct CaseRange {
+   int first;
+   int branch;
+};
+
+std::vector<CaseRange> case_ranges(Cases cases);
+
+// Con COOL_DEVIRT, un dispatch cuyo método no redefine ninguna subclase
+// del tipo estático del receptor (ni los dispatch estáticos) se genera
+// como una llamada directa a la implementación, después de revisar que el
+// receptor no sea void.  Al final se imprime en cerr cuántos fueron.
+#define DEVIRT_ENV "COOL_DEVIRT"
+
+extern bool cgen_devirt;
+Symbol direct_call_target(CgenNodeP nd, Symbol method, bool is_static);
+
+// Con COOL_INLINE=<n>, los dispatch que se resuelven como en COOL_DEVIRT
+// a un método del programa cuyo cuerpo tiene a lo sumo n nodos (INLINE_SIZE
+// si n no es un número) se generan con el cuerpo en lugar de la llamada,
+// hasta INLINE_DEPTH niveles de métodos copiados unos dentro de otros.
+#define INLINE_ENV   "COOL_INLINE"
+#define INLINE_SIZE  20
+#define INLINE_DEPTH 3
+
+extern int inline_budget;
+extern int inlined_sites;
+
+struct InlineFrame {
+   CgenNodeP cls;
+   SymbolTable<Symbol, VarLocation> *env;
+};
+
+method_class *inline_target(CgenNodeP nd, Symbol name, bool is_static, CgenNodeP *impl);
+InlineFrame enter_inline(CgenNodeP impl, method_class *method, const std::vector<VarLocation *> &args);
+void leave_inline(const InlineFrame &saved);
+
+// Con COOL_UNBOX, las expresiones cuyo tipo estático es Int o Bool dejan
+// el valor mismo (un entero, 0 o 1 para Bool) en $a0 en lugar de un
+// objeto, y así lo guardan los let, los atributos de las clases del
+// programa y los argumentos y resultados de sus métodos.  Se pone la caja
+// cuando el valor pasa a un lugar de otro tipo (Object, un receptor, el
+// objeto de un case) o a un método declarado en una clase básica, que
+// usa la convención del runtime (out_int, in_int, substr, length; también
+// las redefiniciones en el programa).  Con recolector (MIPS con -g) no se
+// usa: el recolector tomaría los enteros por punteros.
+#define UNBOX_ENV "COOL_UNBOX"
+
+extern bool cgen_unbox;
+bool unboxed(Symbol type);
+bool raw_signature(CgenNodeP nd, Symbol method);
+
+// Temporales de las expresiones.  La máquina de pila guarda el primer
+// operando de la aritmética, las comparaciones y el = mientras evalúa el
+// segundo; sin COOL_REGALLOC lo apila (TEMP_STACK).  Con COOL_REGALLOC
+// cada temporal va a un registro: los temporales viven en intervalos
+// anidados, así que el recorrido lineal asigna los registros como una
+// pila.  Si entre que se guarda y se usa no hay llamadas va a un
+// registro que no se preserva en las llamadas (TEMP_CALLER); si no, a
+// uno que se preserva (TEMP_CALLEE), y el método que lo usa lo guarda en
+// su marco al entrar y lo recupera al salir.  Cuando no quedan registros
+// va a una casilla del marco (TEMP_SPILL), que se libera y se reusa como
+// las de los let.  Con recolector (MIPS con -g) no se usa: el recolector
+// no ve los objetos que están en registros.
+#define REGALLOC_ENV "COOL_REGALLOC"
+
+enum TempKind { TEMP_STACK, TEMP_CALLER, TEMP_CALLEE, TEMP_SPILL };
+
+struct Temp {
+   TempKind kind;
+   int reg;                  // índice en su grupo de registros
+   int caller, callee;       // reservados mientras se genera el segundo operando, -1 si no hay
+   VarLocation *spill;
+   int calls;                // calls_emitted al reservarlo
+};
+
+extern bool cgen_regalloc;
+extern int calls_emitted;    // llamadas generadas hasta ahora
+extern int temps_saved;      // registros TEMP_CALLEE que usa el método actual
+
+Temp temp_reserve(int caller_regs, int callee_regs);
+void temp_release(Temp &t, bool call);
+
+// Estado compartido por los dos backends (ver cgen.cc)
+extern CgenClassTableP codegen_classtable;
+extern CgenNodeP curr_class;
+extern SymbolTable<Symbol, VarLocation> *var_env;
+extern int next_local;
+extern int max_locals;
+
+void enter_class(CgenNodeP nd);
+int new_label();
+VarLocation *new_slot();
+VarLocation *new_local(Symbol name);
+void free_local();
+void code_default_value(Symbol type, ostream &s);
+
+extern Symbol Int, Str, Bool, Object, SELF_TYPE, self, No_class;
+extern BoolConst falsebool, truebool;
@@ -0,0 +1,73 @@
+#!/bin/sh
+#  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+#  Compila cada COOLExamples/*.cl con nuestro generador de código, corre el
+#  resultado en spim y compara lo que imprime con lo que imprime el .s que
+#  viene con el ejemplo, o con su .out si no trae .s (la salida esperada,
+#  sin el encabezado de spim).
+#
+#      ./check-examples.sh              todos los ejemplos que tienen .s o .out
+#      ./check-examples.sh stack list   sólo esos
+#
+#  Variables de entorno:
+#      COOLC   compilador a usar (por defecto ./mycoolc, que pasa por ./cgen)
+#      SPIM    simulador (por defecto spim)
+#      TRAP    runtime de COOL para spim
+#      INPUT   entrada estándar de los programas que leen (por defecto 7)
+
+COOLC=${COOLC:-./mycoolc}
+SPIM=${SPIM:-spim}
+TRAP=${TRAP:-/usr/class/cs143/cool/lib/trap.handler}
+INPUT=${INPUT:-7}
+
+EXAMPLES=$(cd "$(dirname "$0")/../COOLExamples" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# Salida de spim sin su encabezado.  Los .s de referencia reportan todo
+# dispatch a void en la línea 1, así que el archivo y la línea de esos
+# errores no se comparan.
+run_spim() {
+    echo "$INPUT" | $SPIM -exception_file "$TRAP" -file "$1" 2>&1 |
+        sed -e '1,/^Loaded: /d' \
+            -e 's/^[^ ]*:[0-9]*: Dispatch to void\./<archivo>:<línea>: Dispatch to void./' \
+            -e 's/^[^ ]*:[0-9]*: Match on void in case statement\./<archivo>:<línea>: Match on void in case statement./'
+}
+
+if [ $# -eq 0 ]; then
+    set -- $(cd "$EXAMPLES" && ls *.s *.out | sed 's/\.[a-z]*$//' | sort -u)
+fi
+
+pass=0
+fail=0
+for name in "$@"; do
+    # los que usan A2I se compilan junto con atoi.cl, donde está definida
+    sources="$name.cl"
+    if [ "$name" != atoi ] && grep -q "A2I" "$EXAMPLES/$name.cl"; then
+        sources="$sources atoi.cl"
+    fi
+
+    if ! (cd "$EXAMPLES" && $COOLC $sources -o "$WORK/$name.s") > "$WORK/$name.log" 2>&1; then
+        echo "$name: no compila"
+        cat "$WORK/$name.log"
+        fail=$((fail + 1))
+        continue
+    fi
+
+    run_spim "$WORK/$name.s" > "$WORK/$name.out"
+    if [ -f "$EXAMPLES/$name.out" ]; then
+        cp "$EXAMPLES/$name.out" "$WORK/$name.expected"
+    else
+        run_spim "$EXAMPLES/$name.s" > "$WORK/$name.expected"
+    fi
+    if cmp -s "$WORK/$name.out" "$WORK/$name.expected"; then
+        echo "$name: ok"
+        pass=$((pass + 1))
+    else
+        echo "$name: distinto"
+        diff "$WORK/$name.expected" "$WORK/$name.out"
+        fail=$((fail + 1))
+    fi
+done
+
+echo "$pass ok, $fail con diferencias"
+[ $fail -eq 0 ]
@@ -0,0 +1,290 @@
+/*  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+ *  Runtime de COOL para el backend de x86-64 (cgen-x86.cc): hace lo mismo
+ *  que trap.handler en spim.  Los métodos de Object, IO y String, y las
+ *  rutinas que llama el código generado (equality_test, _dispatch_abort,
+ *  _case_abort y _case_abort2), son trampolines en ensamblador que pasan
+ *  de la convención de COOL (self en %rax, argumentos en la pila, el
+ *  llamado los saca) a la de C y llaman a las funciones de abajo.
+ *
+ *      gcc -O2 -o prog prog.s cool-runtime.c
+ *
+ *  La memoria se pide por bloques y no se libera nunca: no hay recolector.
+ */
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Organización de los objetos (palabras de 8 bytes), igual que en MIPS
+#define TAG_OFFSET      0
+#define SIZE_OFFSET     1
+#define DISP_OFFSET     2
+#define FIELDS_OFFSET   3     // valor de Int/Bool, longitud de String
+#define CHARS_OFFSET    4     // caracteres de String
+
+#define HEAP_CHUNK      (1 << 20)   // palabras por bloque
+
+typedef long word;
+
+// Definidos en el .s generado
+extern word class_nameTab[];
+extern word Int_protObj[];
+extern word String_protObj[];
+extern word _int_tag, _bool_tag, _string_tag;
+
+static word *heap_ptr, *heap_end;
+
+static word *cool_alloc(word words)
+{
+  if (heap_end - heap_ptr < words) {
+    word chunk = words > HEAP_CHUNK ? words : HEAP_CHUNK;
+    heap_ptr = malloc(chunk * sizeof(word));
+    if (heap_ptr == NULL) {
+      fflush(stdout);
+      fputs("Heap overflow\n", stderr);
+      exit(1);
+    }
+    heap_end = heap_ptr + chunk;
+  }
+  word *obj = heap_ptr;
+  heap_ptr += words;
+  return obj;
+}
+
+static int int_value(word *obj) { return *(int *) &obj[FIELDS_OFFSET]; }
+static int str_length(word *obj) { return int_value((word *) obj[FIELDS_OFFSET]); }
+static char *str_chars(word *obj) { return (char *) &obj[CHARS_OFFSET]; }
+
+word *cool_copy(word *obj)
+{
+  word *copy = cool_alloc(obj[SIZE_OFFSET]);
+  memcpy(copy, obj, obj[SIZE_OFFSET] * sizeof(word));
+  return copy;
+}
+
+static word *new_int(int value)
+{
+  word *obj = cool_copy(Int_protObj);
+  obj[FIELDS_OFFSET] = value;
+  return obj;
+}
+
+// Mismo tamaño que las constantes de cgen.cc: caben la cadena y su '\0'
+static word *new_string(const char *chars, int len)
+{
+  word size = CHARS_OFFSET + (len + sizeof(word)) / sizeof(word);
+  word *obj = cool_alloc(size);
+  memcpy(obj, String_protObj, CHARS_OFFSET * sizeof(word));
+  obj[SIZE_OFFSET] = size;
+  obj[FIELDS_OFFSET] = (word) new_int(len);
+  memcpy(str_chars(obj), chars, len);
+  str_chars(obj)[len] = '\0';
+  return obj;
+}
+
+static word *class_name(word *obj)
+{
+  return (word *) class_nameTab[obj[TAG_OFFSET]];
+}
+
+static void cool_exit(void)
+{
+  fflush(stdout);
+  exit(0);
+}
+
+void cool_abort(word *self)
+{
+  printf("Abort called from class %.*s\n",
+         str_length(class_name(self)), str_chars(class_name(self)));
+  cool_exit();
+}
+
+word *cool_type_name(word *self)
+{
+  return class_name(self);
+}
+
+word *cool_out_string(word *self, word *s)
+{
+  fwrite(str_chars(s), 1, str_length(s), stdout);
+  return self;
+}
+
+word *cool_out_int(word *self, word *i)
+{
+  printf("%d", int_value(i));
+  return self;
+}
+
+// Una línea sin el '\n'; si trae un '\0' se toma como la cadena vacía
+static int read_line(char **line)
+{
+  static char *buf;
+  static size_t cap;
+  ssize_t len = getline(&buf, &cap, stdin);
+  if (len < 0)
+    len = 0;
+  else if (len > 0 && buf[len - 1] == '\n')
+    len--;
+  if (memchr(buf, '\0', len) != NULL)
+    len = 0;
+  *line = buf;
+  return len;
+}
+
+word *cool_in_string(word *self)
+{
+  char *line;
+  int len = read_line(&line);
+  return new_string(line, len);
+}
+
+word *cool_in_int(word *self)
+{
+  char *line;
+  int len = read_line(&line);
+  line[len] = '\0';
+  return new_int((int) strtol(line, NULL, 10));
+}
+
+word *cool_length(word *self)
+{
+  return (word *) self[FIELDS_OFFSET];
+}
+
+word *cool_concat(word *self, word *s)
+{
+  int len1 = str_length(self), len2 = str_length(s);
+  char *chars = malloc(len1 + len2 + 1);
+  memcpy(chars, str_chars(self), len1);
+  memcpy(chars + len1, str_chars(s), len2);
+  word *result = new_string(chars, len1 + len2);
+  free(chars);
+  return result;
+}
+
+word *cool_substr(word *self, word *i, word *l)
+{
+  int start = int_value(i), len = int_value(l);
+  if (start < 0 || len < 0 || start + len > str_length(self)) {
+    printf("\nError: Index to substr is out of range\n");
+    cool_exit();
+  }
+  return new_string(str_chars(self) + start, len);
+}
+
+// Igualdad de dos objetos distintos: los Int, Bool y String se comparan
+// por valor
+word *cool_equality_test(word *a, word *b, word *t, word *f)
+{
+  if (a == NULL || b == NULL || a[TAG_OFFSET] != b[TAG_OFFSET])
+    return f;
+  if (a[TAG_OFFSET] == _int_tag || a[TAG_OFFSET] == _bool_tag)
+    return int_value(a) == int_value(b) ? t : f;
+  if (a[TAG_OFFSET] == _string_tag)
+    return str_length(a) == str_length(b) &&
+           memcmp(str_chars(a), str_chars(b), str_length(a)) == 0 ? t : f;
+  return f;
+}
+
+void cool_dispatch_abort(word *filename, word line)
+{
+  printf("%.*s:%ld: Dispatch to void.\n", str_length(filename), str_chars(filename), line);
+  cool_exit();
+}
+
+void cool_case_abort(word *obj)
+{
+  printf("No match in case statement for Class %.*s\n",
+         str_length(class_name(obj)), str_chars(class_name(obj)));
+  cool_exit();
+}
+
+void cool_case_abort2(word *filename, word line)
+{
+  printf("%.*s:%ld: Match on void in case statement.\n",
+         str_length(filename), str_chars(filename), line);
+  cool_exit();
+}
+
+// Trampolines: se alinea la pila a 16 bytes para C y se guarda %rbp, el
+// marco de COOL.  Con un argumento, está en 16(%rbp); con dos, el primero
+// en 24(%rbp) y el segundo en 16(%rbp).
+#define TRAMPOLINE(label, moves, fn, pop)   \
+  "\t.globl\t" label "\n"                   \
+  label ":\n"                               \
+  "\tpushq\t%rbp\n"                         \
+  "\tmovq\t%rsp, %rbp\n"                    \
+  "\tandq\t$-16, %rsp\n"                    \
+  moves                                     \
+  "\tcall\t" fn "\n"                        \
+  "\tmovq\t%rbp, %rsp\n"                    \
+  "\tpopq\t%rbp\n"                          \
+  "\tret\t" pop "\n"
+
+#define SELF_ARG    "\tmovq\t%rax, %rdi\n"
+#define ONE_ARG     SELF_ARG "\tmovq\t16(%rbp), %rsi\n"
+#define TWO_ARGS    SELF_ARG "\tmovq\t24(%rbp), %rsi\n\tmovq\t16(%rbp), %rdx\n"
+
+__asm__(
+  "\t.text\n"
+  TRAMPOLINE("Object.copy",      SELF_ARG, "cool_copy",       "$0")
+  TRAMPOLINE("Object.abort",     SELF_ARG, "cool_abort",      "$0")
+  TRAMPOLINE("Object.type_name", SELF_ARG, "cool_type_name",  "$0")
+  TRAMPOLINE("IO.out_string",    ONE_ARG,  "cool_out_string", "$8")
+  TRAMPOLINE("IO.out_int",       ONE_ARG,  "cool_out_int",    "$8")
+  TRAMPOLINE("IO.in_string",     SELF_ARG, "cool_in_string",  "$0")
+  TRAMPOLINE("IO.in_int",        SELF_ARG, "cool_in_int",     "$0")
+  TRAMPOLINE("String.length",    SELF_ARG, "cool_length",     "$0")
+  TRAMPOLINE("String.concat",    ONE_ARG,  "cool_concat",     "$8")
+  TRAMPOLINE("String.substr",    TWO_ARGS, "cool_substr",     "$16")
+  // %rcx y %rdx: objetos, %rax: true, %rsi: false
+  TRAMPOLINE("equality_test",
+             "\tmovq\t%rax, %r8\n\tmovq\t%rsi, %r9\n"
+             "\tmovq\t%rcx, %rdi\n\tmovq\t%rdx, %rsi\n"
+             "\tmovq\t%r8, %rdx\n\tmovq\t%r9, %rcx\n",
+             "cool_equality_test", "$0")
+  // %rax: nombre del archivo, %rcx: línea
+  TRAMPOLINE("_dispatch_abort",
+             "\tmovq\t%rax, %rdi\n\tmovq\t%rcx, %rsi\n", "cool_dispatch_abort", "$0")
+  TRAMPOLINE("_case_abort",      SELF_ARG, "cool_case_abort", "$0")
+  TRAMPOLINE("_case_abort2",
+             "\tmovq\t%rax, %rdi\n\tmovq\t%rcx, %rsi\n", "cool_case_abort2", "$0")
+
+  // cool_start(): crea el objeto Main, lo inicializa y llama a main
+  "\t.globl\tcool_start\n"
+  "cool_start:\n"
+  "\tpushq\t%rbp\n"
+  "\tpushq\t%rbx\n"
+  "\tsubq\t$8, %rsp\n"
+  "\tleaq\tMain_protObj(%rip), %rax\n"
+  "\tcall\tObject.copy\n"
+  "\tcall\tMain_init\n"
+  "\tcall\tMain.main\n"
+  "\taddq\t$8, %rsp\n"
+  "\tpopq\t%rbx\n"
+  "\tpopq\t%rbp\n"
+  "\tret\n"
+);
+
+void cool_start(void);
+
+// idivl con divisor cero (la división por -1 no usa idivl, ver
+// x86_idivl en cgen-x86.cc): lo que ya se imprimió no se pierde
+static void cool_division_by_zero(int sig)
+{
+  fflush(stdout);
+  static const char msg[] = "Exception: division by zero\n";
+  write(1, msg, sizeof(msg) - 1);
+  _exit(1);
+}
+
+int main(void)
+{
+  signal(SIGFPE, cool_division_by_zero);
+  cool_start();
+  printf("COOL program successfully executed\n");
+  return 0;
+}
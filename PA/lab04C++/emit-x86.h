@@ -0,0 +1,51 @@
+/*  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+ *  Nombres del backend de x86-64 (cgen-x86.cc), con los mismos papeles
+ *  que los de emit.h.  Las etiquetas (tablas, prototipos, métodos y
+ *  constantes) son las mismas que en MIPS.
+ */
+
+#define X86_WORD_SIZE   8
+#define X86_QUAD        "\t.quad\t"
+#define X86_ALIGN       "\t.p2align\t3\n"
+
+//
+// register names
+//
+#define X86_ACC  "%rax"		// Accumulator
+#define X86_A1   "%rsi"		// Second argument to runtime routines
+#define X86_SELF "%rbx"		// Ptr to self (callee saves, también en C)
+#define X86_T1   "%rcx"		// Temporary 1
+#define X86_T2   "%rdx"		// Temporary 2
+#define X86_T3   "%rdi"		// Temporary 3
+#define X86_SP   "%rsp"		// Stack pointer
+#define X86_FP   "%rbp"		// Frame pointer
+
+// Mitades de 32 bits, para el valor de los Int
+#define X86_T1_32 "%ecx"
+#define X86_T2_32 "%edx"
+#define X86_ACC_32 "%eax"
+#define X86_T3_32 "%edi"
+
+//
+// Opcodes
+//
+#define X86_MOV   "\tmovq\t"
+#define X86_MOVL  "\tmovl\t"
+#define X86_LEA   "\tleaq\t"
+#define X86_PUSH  "\tpushq\t"
+#define X86_POP   "\tpopq\t"
+#define X86_CALL  "\tcall\t"
+#define X86_RET   "\tret\t"
+#define X86_JMP   "\tjmp\t"
+#define X86_CMP   "\tcmpq\t"
+#define X86_CMPL  "\tcmpl\t"
+#define X86_TEST  "\ttestq\t"
+#define X86_ADD   "\taddq\t"
+#define X86_SUB   "\tsubq\t"
+#define X86_SHL   "\tshlq\t"
+#define X86_ADDL  "\taddl\t"
+#define X86_SUBL  "\tsubl\t"
+#define X86_IMULL "\timull\t"
+#define X86_IDIVL "\tidivl\t"
+#define X86_NEGL  "\tnegl\t"
+#define X86_CLTD  "\tcltd\n"
@@ -0,0 +1,454 @@
+/*  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+ *  Plegado y propagación de constantes (ver fold.h).
+ *
+ *  Cada Expression_class::fold devuelve la expresión que la reemplaza (ella
+ *  misma si no cambia) y deja en el FoldEnv el valor de las variables
+ *  después de evaluarla.  Las expresiones se recorren en el orden en que
+ *  se evalúan, el mismo del generador de código: en un dispatch primero
+ *  los argumentos y después el objeto.
+ */
+#include <limits.h>
+#include <string>
+#include "cgen.h"
+#include "fold.h"
+
+FoldValue *FoldEnv::Lookup(Symbol name)
+{
+  for (int i = vars.size() - 1; i >= 0; i--)
+    if (vars[i].name == name)
+      return &vars[i].value;
+  return NULL;
+}
+
+void FoldEnv::Push(Symbol name, const FoldValue &value)
+{
+  FoldVar v;
+  v.name = name;
+  v.value = value;
+  vars.push_back(v);
+}
+
+void FoldEnv::Forget(const std::set<Symbol> &names)
+{
+  for (size_t i = 0; i < vars.size(); i++)
+    if (names.count(vars[i].name))
+      vars[i].value = FoldValue();
+}
+
+void FoldEnv::Merge(const std::vector<std::vector<FoldVar> > &paths)
+{
+  vars = paths[0];
+  for (size_t k = 1; k < paths.size(); k++)
+    for (size_t i = 0; i < vars.size(); i++)
+      if (!(vars[i].value == paths[k][i].value))
+        vars[i].value = FoldValue();
+}
+
+// Variables que se asignan en algún punto de e (de cualquier ámbito: se
+// usa para olvidar valores, así que sobrar no es un error)
+static void fold_assigned(Expression e, std::set<Symbol> &names)
+{
+  assign_class *a = dynamic_cast<assign_class *>(e);
+  if (a != NULL)
+    names.insert(a->GetName());
+  for (int i = 0; i < e->NumChildren(); i++)
+    fold_assigned(e->Child(i), names);
+}
+
+static FoldValue fold_value(Expression e)
+{
+  FoldValue v;
+  e->GetConstant(v);
+  return v;
+}
+
+static FoldValue fold_int(int value)
+{
+  FoldValue v;
+  v.kind = FoldValue::INT;
+  v.value = value;
+  return v;
+}
+
+static FoldValue fold_bool(bool value)
+{
+  FoldValue v;
+  v.kind = FoldValue::BOOL;
+  v.value = value;
+  return v;
+}
+
+static FoldValue fold_string(const std::string &s)
+{
+  FoldValue v;
+  v.kind = FoldValue::STRING;
+  v.str = stringtable.add_string((char *) s.c_str());
+  return v;
+}
+
+// La constante v en lugar de from, con su número de línea
+static Expression fold_constant(const FoldValue &v, tree_node *from)
+{
+  Expression e;
+  if (v.kind == FoldValue::INT)
+    e = int_const(inttable.add_int(v.value))->set_type(Int);
+  else if (v.kind == FoldValue::BOOL)
+    e = bool_const(v.value)->set_type(Bool);
+  else
+    e = string_const(v.str)->set_type(Str);
+  e->set(from);
+  return e;
+}
+
+bool int_const_class::GetConstant(FoldValue &v) {
+  v = fold_int(atoi(token->get_string()));
+  return true;
+}
+
+bool bool_const_class::GetConstant(FoldValue &v) {
+  v = fold_bool(val);
+  return true;
+}
+
+bool string_const_class::GetConstant(FoldValue &v) {
+  v.kind = FoldValue::STRING;
+  v.str = token;
+  return true;
+}
+
+static Expressions fold_list(Expressions list, FoldEnv &env)
+{
+  Expressions result = nil_Expressions();
+  bool changed = false;
+  for (int i = list->first(); list->more(i); i = list->next(i)) {
+    Expression e = list->nth(i)->fold(env);
+    changed = changed || e != list->nth(i);
+    result = append_Expressions(result, single_Expressions(e));
+  }
+  return changed ? result : list;
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+//  Métodos y atributos
+//
+//////////////////////////////////////////////////////////////////////
+
+void method_class::fold(FoldEnv &env) {
+  env.vars.clear();
+  for (int i = formals->first(); formals->more(i); i = formals->next(i))
+    env.Push(formals->nth(i)->GetName(), FoldValue());
+  expr = expr->fold(env);
+}
+
+void attr_class::fold(FoldEnv &env) {
+  env.vars.clear();
+  if (!init->IsNoExpr())
+    init = init->fold(env);
+}
+
+void fold_program(CgenClassTableP classtable)
+{
+  FoldEnv env;
+  std::vector<CgenNodeP> &nds = classtable->nodes();
+  for (size_t i = 0; i < nds.size(); i++) {
+    if (nds[i]->basic())
+      continue;
+    Features features = nds[i]->GetFeatures();
+    for (int j = features->first(); features->more(j); j = features->next(j))
+      features->nth(j)->fold(env);
+  }
+  cerr << "fold: " << env.folded << " expressions folded, "
+       << env.propagated << " variable uses replaced, "
+       << env.branches << " constant branches removed, "
+       << env.removed << " dead lets and statements removed" << endl;
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+//  Expresiones
+//
+//////////////////////////////////////////////////////////////////////
+
+Expression assign_class::fold(FoldEnv &env) {
+  expr = expr->fold(env);
+  FoldValue *var = env.Lookup(name);
+  if (var != NULL)
+    *var = fold_value(expr);
+  return this;
+}
+
+// Los métodos de String no se pueden redefinir, así que con el objeto y
+// los argumentos constantes se conoce el resultado
+static Expression fold_string_method(Expression receiver, Symbol name, Expressions actual,
+                                     tree_node *from, FoldEnv &env)
+{
+  FoldValue self = fold_value(receiver);
+  if (self.kind != FoldValue::STRING)
+    return NULL;
+  std::vector<FoldValue> args;
+  for (int i = actual->first(); actual->more(i); i = actual->next(i)) {
+    args.push_back(fold_value(actual->nth(i)));
+    if (args.back().kind == FoldValue::NONE)
+      return NULL;
+  }
+
+  std::string s = self.str->get_string();
+  FoldValue result;
+  if (name == idtable.lookup_string((char *) "length") && args.empty()) {
+    result = fold_int(s.size());
+  } else if (name == idtable.lookup_string((char *) "concat") && args.size() == 1) {
+    result = fold_string(s + args[0].str->get_string());
+  } else if (name == idtable.lookup_string((char *) "substr") && args.size() == 2) {
+    long long start = args[0].value, len = args[1].value;
+    if (start < 0 || len < 0 || start + len > (long long) s.size())
+      return NULL;
+    result = fold_string(s.substr(start, len));
+  } else {
+    return NULL;
+  }
+  env.folded++;
+  return fold_constant(result, from);
+}
+
+Expression static_dispatch_class::fold(FoldEnv &env) {
+  actual = fold_list(actual, env);
+  expr = expr->fold(env);
+  return this;
+}
+
+Expression dispatch_class::fold(FoldEnv &env) {
+  actual = fold_list(actual, env);
+  expr = expr->fold(env);
+  Expression folded = fold_string_method(expr, name, actual, this, env);
+  return folded != NULL ? folded : this;
+}
+
+Expression cond_class::fold(FoldEnv &env) {
+  pred = pred->fold(env);
+  FoldValue p = fold_value(pred);
+  if (p.kind == FoldValue::BOOL) {
+    env.branches++;
+    return (p.value ? then_exp : else_exp)->fold(env);
+  }
+
+  std::vector<FoldVar> before = env.vars;
+  std::vector<std::vector<FoldVar> > paths;
+  then_exp = then_exp->fold(env);
+  paths.push_back(env.vars);
+  env.vars = before;
+  else_exp = else_exp->fold(env);
+  paths.push_back(env.vars);
+  env.Merge(paths);
+  return this;
+}
+
+// El predicado y el cuerpo se evalúan varias veces: lo que se asigna en
+// ellos deja de ser constante desde antes de entrar
+Expression loop_class::fold(FoldEnv &env) {
+  std::set<Symbol> assigned;
+  fold_assigned(pred, assigned);
+  fold_assigned(body, assigned);
+  env.Forget(assigned);
+
+  pred = pred->fold(env);
+  FoldValue p = fold_value(pred);
+  if (p.kind == FoldValue::BOOL && !p.value) {
+    env.branches++;
+    Expression e = no_expr()->set_type(Object);
+    e->set(this);
+    return e;
+  }
+  std::vector<FoldVar> after_pred = env.vars;
+  body = body->fold(env);
+  env.vars = after_pred;
+  return this;
+}
+
+void branch_class::fold(FoldEnv &env) {
+  env.Push(name, FoldValue());
+  expr = expr->fold(env);
+  env.Pop();
+}
+
+Expression typcase_class::fold(FoldEnv &env) {
+  expr = expr->fold(env);
+  std::vector<FoldVar> before = env.vars;
+  std::vector<std::vector<FoldVar> > paths;
+  for (int i = cases->first(); cases->more(i); i = cases->next(i)) {
+    env.vars = before;
+    ((branch_class *) cases->nth(i))->fold(env);
+    paths.push_back(env.vars);
+  }
+  env.Merge(paths);
+  return this;
+}
+
+// Las constantes que no son la última expresión no hacen nada
+Expression block_class::fold(FoldEnv &env) {
+  Expressions result = nil_Expressions();
+  int len = 0;
+  Expression last = NULL;
+  for (int i = body->first(); body->more(i); i = body->next(i)) {
+    Expression e = body->nth(i)->fold(env);
+    bool is_last = !body->more(body->next(i));
+    if (!is_last && (fold_value(e).kind != FoldValue::NONE || e->IsNoExpr())) {
+      env.removed++;
+      continue;
+    }
+    result = append_Expressions(result, single_Expressions(e));
+    last = e;
+    len++;
+  }
+  if (len == 1)
+    return last;
+  body = result;
+  return this;
+}
+
+Expression let_class::fold(FoldEnv &env) {
+  FoldValue value;
+  if (!init->IsNoExpr()) {
+    init = init->fold(env);
+    value = fold_value(init);
+  } else if (type_decl == Int) {
+    value = fold_int(0);
+  } else if (type_decl == Bool) {
+    value = fold_bool(false);
+  } else if (type_decl == Str) {
+    value = fold_string("");
+  }
+
+  // Si la variable es constante y no se asigna, todos sus usos se van a
+  // cambiar por el valor y el let sobra
+  std::set<Symbol> assigned;
+  fold_assigned(body, assigned);
+  bool dead = value.kind != FoldValue::NONE && !assigned.count(identifier);
+
+  env.Push(identifier, value);
+  body = body->fold(env);
+  env.Pop();
+  if (dead) {
+    env.removed++;
+    return body;
+  }
+  return this;
+}
+
+// Resultado de una operación de Int que no se desborda
+static bool fold_fits(long long v)
+{
+  return v >= INT_MIN && v <= INT_MAX;
+}
+
+static Expression fold_arith(Expression &e1, Expression &e2, char op, Expression self, FoldEnv &env)
+{
+  e1 = e1->fold(env);
+  e2 = e2->fold(env);
+  FoldValue a = fold_value(e1), b = fold_value(e2);
+  if (a.kind != FoldValue::INT || b.kind != FoldValue::INT)
+    return self;
+
+  long long x = a.value, y = b.value, r;
+  switch (op) {
+  case '+': r = x + y; break;
+  case '-': r = x - y; break;
+  case '*': r = x * y; break;
+  default:
+    if (y == 0)
+      return self;
+    r = x / y;
+    break;
+  }
+  if (!fold_fits(r))
+    return self;
+  env.folded++;
+  return fold_constant(fold_int(r), self);
+}
+
+Expression plus_class::fold(FoldEnv &env) {
+  return fold_arith(e1, e2, '+', this, env);
+}
+
+Expression sub_class::fold(FoldEnv &env) {
+  return fold_arith(e1, e2, '-', this, env);
+}
+
+Expression mul_class::fold(FoldEnv &env) {
+  return fold_arith(e1, e2, '*', this, env);
+}
+
+Expression divide_class::fold(FoldEnv &env) {
+  return fold_arith(e1, e2, '/', this, env);
+}
+
+Expression neg_class::fold(FoldEnv &env) {
+  e1 = e1->fold(env);
+  FoldValue a = fold_value(e1);
+  if (a.kind != FoldValue::INT || !fold_fits(-(long long) a.value))
+    return this;
+  env.folded++;
+  return fold_constant(fold_int(-a.value), this);
+}
+
+static Expression fold_compare(Expression &e1, Expression &e2, bool strict, Expression self, FoldEnv &env)
+{
+  e1 = e1->fold(env);
+  e2 = e2->fold(env);
+  FoldValue a = fold_value(e1), b = fold_value(e2);
+  if (a.kind != FoldValue::INT || b.kind != FoldValue::INT)
+    return self;
+  env.folded++;
+  return fold_constant(fold_bool(strict ? a.value < b.value : a.value <= b.value), self);
+}
+
+Expression lt_class::fold(FoldEnv &env) {
+  return fold_compare(e1, e2, true, this, env);
+}
+
+Expression leq_class::fold(FoldEnv &env) {
+  return fold_compare(e1, e2, false, this, env);
+}
+
+// Las constantes de String están una sola vez en stringtable, así que dos
+// String constantes son iguales si son la misma entrada
+Expression eq_class::fold(FoldEnv &env) {
+  e1 = e1->fold(env);
+  e2 = e2->fold(env);
+  FoldValue a = fold_value(e1), b = fold_value(e2);
+  if (a.kind == FoldValue::NONE || b.kind == FoldValue::NONE)
+    return this;
+  env.folded++;
+  return fold_constant(fold_bool(a == b), this);
+}
+
+Expression comp_class::fold(FoldEnv &env) {
+  e1 = e1->fold(env);
+  FoldValue a = fold_value(e1);
+  if (a.kind != FoldValue::BOOL)
+    return this;
+  env.folded++;
+  return fold_constant(fold_bool(!a.value), this);
+}
+
+Expression isvoid_class::fold(FoldEnv &env) {
+  e1 = e1->fold(env);
+  if (fold_value(e1).kind == FoldValue::NONE)
+    return this;
+  env.folded++;
+  return fold_constant(fold_bool(false), this);
+}
+
+Expression object_class::fold(FoldEnv &env) {
+  FoldValue *var = env.Lookup(name);
+  if (var == NULL || var->kind == FoldValue::NONE)
+    return this;
+  env.propagated++;
+  return fold_constant(*var, this);
+}
+
+Expression int_const_class::fold(FoldEnv &env) { return this; }
+Expression bool_const_class::fold(FoldEnv &env) { return this; }
+Expression string_const_class::fold(FoldEnv &env) { return this; }
+Expression new__class::fold(FoldEnv &env) { return this; }
+Expression no_expr_class::fold(FoldEnv &env) { return this; }
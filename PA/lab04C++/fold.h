@@ -0,0 +1,69 @@
+/*  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+ *  Plegado y propagación de constantes sobre el AST anotado, antes de
+ *  generar el código.
+ *
+ *  Con COOL_FOLD el generador recorre cada método y cada inicialización
+ *  de atributo y:
+ *    - calcula las operaciones de Int y Bool y las comparaciones entre
+ *      constantes, y concat, length y substr sobre constantes String;
+ *    - sigue el valor constante de las variables locales (let,
+ *      argumentos y ramas de case) a través de las asignaciones y cambia
+ *      sus usos por la constante;
+ *    - cambia un if con predicado constante por la rama que se toma y
+ *      quita los while cuyo predicado es false;
+ *    - quita los let cuya variable es constante y nunca se asigna, y las
+ *      constantes que no son la última expresión de un bloque.
+ *  Al terminar imprime en cerr cuántas expresiones cambió.
+ *
+ *  Las operaciones que fallarían en ejecución (división por cero,
+ *  desbordamiento, substr fuera de rango) se dejan como están.
+ */
+#ifndef FOLD_H
+#define FOLD_H
+
+#include <set>
+#include <vector>
+#include "cool-tree.h"
+
+#define FOLD_ENV "COOL_FOLD"
+
+class CgenClassTable;
+
+// Valor conocido de una expresión o de una variable
+struct FoldValue {
+   enum Kind { NONE, INT, BOOL, STRING } kind;
+   int value;        // INT y BOOL
+   Symbol str;       // STRING: la entrada de stringtable
+
+   FoldValue() : kind(NONE), value(0), str(NULL) {}
+   bool operator==(const FoldValue &o) const {
+      return kind == o.kind && value == o.value && str == o.str;
+   }
+};
+
+struct FoldVar {
+   Symbol name;
+   FoldValue value;
+};
+
+class FoldEnv {
+public:
+   std::vector<FoldVar> vars;     // variables locales visibles, la última es la más interna
+   int folded;                    // operaciones calculadas
+   int propagated;                // usos de variables cambiados por su valor
+   int branches;                  // if y while con predicado constante
+   int removed;                   // let y expresiones de bloque que sobraban
+
+   FoldEnv() : folded(0), propagated(0), branches(0), removed(0) {}
+   FoldValue *Lookup(Symbol name);
+   void Push(Symbol name, const FoldValue &value);
+   void Pop() { vars.pop_back(); }
+   void Forget(const std::set<Symbol> &names);
+   // Deja como constantes sólo las variables que valen lo mismo en todos
+   // los entornos (uno por cada camino que se junta)
+   void Merge(const std::vector<std::vector<FoldVar> > &paths);
+};
+
+void fold_program(CgenClassTable *classtable);
+
+#endif
@@ -0,0 +1,1072 @@
+/*  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+ *  Construcción, verificación e impresión de la IR (ver ir.h).
+ *
+ *  Como en COOL no hay break ni return, el flujo de control es
+ *  estructurado y la forma SSA se arma al bajar el árbol: se lleva el
+ *  registro actual de cada variable local y, al juntarse los caminos de
+ *  un if o un case, se pone una phi para las que llegan con registros
+ *  distintos.  En la cabeza de un loop no se sabe todavía qué cambia el
+ *  cuerpo, así que se pone una phi por variable y al terminar la función
+ *  se quitan las que resultan triviales (todas sus entradas son el mismo
+ *  valor o la misma phi).
+ */
+#include <fstream>
+#include <map>
+#include <set>
+#include "cgen.h"
+#include "ir.h"
+#include "utilities.h"
+
+//////////////////////////////////////////////////////////////////////
+//
+//  Construcción
+//
+//////////////////////////////////////////////////////////////////////
+
+static bool ir_defines_value(IROpcode op)
+{
+  return op != IR_SETATTR && op != IR_INIT && op != IR_VOIDCHECK && op < IR_BR;
+}
+
+IRBuilder::IRBuilder(IRFunction *f) : fn(f), cur(NULL), self(NULL)
+{
+  cur = NewBlock();
+}
+
+IRBlock *IRBuilder::NewBlock()
+{
+  IRBlock *b = new IRBlock(fn->blocks.size());
+  fn->blocks.push_back(b);
+  return b;
+}
+
+IRInstr *IRBuilder::Emit(IROpcode op, Symbol type)
+{
+  IRInstr *i = new IRInstr(op);
+  if (ir_defines_value(op))
+    i->id = fn->num_regs++;
+  i->type = type;
+  i->block = cur;
+  cur->instrs.push_back(i);
+  return i;
+}
+
+void IRBuilder::Branch(IRBlock *target)
+{
+  IRInstr *br = Emit(IR_BR, NULL);
+  br->blocks.push_back(target);
+  target->preds.push_back(cur);
+}
+
+void IRBuilder::CondBranch(IRInstr *cond, IRBlock *t, IRBlock *f)
+{
+  IRInstr *br = Emit(IR_CONDBR, NULL);
+  br->args.push_back(cond);
+  br->blocks.push_back(t);
+  br->blocks.push_back(f);
+  t->preds.push_back(cur);
+  f->preds.push_back(cur);
+}
+
+IRVar *IRBuilder::LookupVar(Symbol name)
+{
+  for (int i = vars.size() - 1; i >= 0; i--)
+    if (vars[i].name == name)
+      return &vars[i];
+  return NULL;
+}
+
+void IRBuilder::PushVar(Symbol name, Symbol type, IRInstr *value)
+{
+  IRVar v = { name, type, value };
+  vars.push_back(v);
+}
+
+// Una phi en join con los valores de values, o el valor mismo si todos
+// son iguales
+static IRInstr *ir_join_values(IRBuilder &b, IRBlock *join,
+                               const std::vector<IRInstr *> &values, Symbol type)
+{
+  bool same = true;
+  for (size_t i = 1; i < values.size(); i++)
+    same = same && values[i] == values[0];
+  if (same)
+    return values[0];
+  IRInstr *phi = b.Emit(IR_PHI, type);
+  phi->args = values;
+  phi->blocks = join->preds;
+  return phi;
+}
+
+IRInstr *IRBuilder::Merge(IRBlock *join, const std::vector<std::vector<IRVar> > &envs,
+                          const std::vector<IRInstr *> &results, Symbol type)
+{
+  SetBlock(join);
+  IRInstr *result = ir_join_values(*this, join, results, type);
+  for (size_t i = 0; i < vars.size(); i++) {
+    std::vector<IRInstr *> values;
+    for (size_t k = 0; k < envs.size(); k++)
+      values.push_back(envs[k][i].value);
+    vars[i].value = ir_join_values(*this, join, values, vars[i].type);
+  }
+  return result;
+}
+
+// Quita las phi triviales que dejan los loops y cambia sus usos por el
+// valor que representan
+static void ir_remove_trivial_phis(IRFunction *fn)
+{
+  std::map<IRInstr *, IRInstr *> replaced;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (size_t i = 0; i < fn->blocks.size(); i++) {
+      std::vector<IRInstr *> &instrs = fn->blocks[i]->instrs;
+      for (size_t j = 0; j < instrs.size(); j++) {
+        IRInstr *phi = instrs[j];
+        if (phi->op != IR_PHI)
+          continue;
+        IRInstr *same = NULL;
+        bool trivial = true;
+        for (size_t k = 0; k < phi->args.size(); k++) {
+          IRInstr *arg = phi->args[k];
+          while (replaced.count(arg))
+            arg = replaced[arg];
+          phi->args[k] = arg;
+          if (arg == phi || arg == same)
+            continue;
+          if (same != NULL)
+            trivial = false;
+          same = arg;
+        }
+        if (!trivial || same == NULL)
+          continue;
+        replaced[phi] = same;
+        instrs.erase(instrs.begin() + j);
+        j--;
+        changed = true;
+      }
+    }
+  }
+
+  for (size_t i = 0; i < fn->blocks.size(); i++) {
+    std::vector<IRInstr *> &instrs = fn->blocks[i]->instrs;
+    for (size_t j = 0; j < instrs.size(); j++)
+      for (size_t k = 0; k < instrs[j]->args.size(); k++)
+        while (replaced.count(instrs[j]->args[k]))
+          instrs[j]->args[k] = replaced[instrs[j]->args[k]];
+  }
+}
+
+// Ordena los bloques en orden inverso de postorden y numera bloques y
+// registros en ese orden, para que el texto se lea de arriba abajo
+static void ir_postorder(IRBlock *b, std::set<IRBlock *> &seen, std::vector<IRBlock *> &order)
+{
+  seen.insert(b);
+  IRInstr *term = b->Terminator();
+  if (term != NULL)
+    for (int i = term->blocks.size() - 1; i >= 0; i--)
+      if (!seen.count(term->blocks[i]))
+        ir_postorder(term->blocks[i], seen, order);
+  order.push_back(b);
+}
+
+static void ir_renumber(IRFunction *fn)
+{
+  std::set<IRBlock *> seen;
+  std::vector<IRBlock *> order;
+  ir_postorder(fn->blocks[0], seen, order);
+  std::vector<IRBlock *> blocks(order.rbegin(), order.rend());
+  for (size_t i = 0; i < fn->blocks.size(); i++)
+    if (!seen.count(fn->blocks[i]))
+      blocks.push_back(fn->blocks[i]);
+  fn->blocks = blocks;
+
+  fn->num_regs = 0;
+  for (size_t i = 0; i < fn->blocks.size(); i++) {
+    fn->blocks[i]->id = i;
+    std::vector<IRInstr *> &instrs = fn->blocks[i]->instrs;
+    for (size_t j = 0; j < instrs.size(); j++)
+      if (instrs[j]->id >= 0)
+        instrs[j]->id = fn->num_regs++;
+  }
+}
+
+static void ir_finish(IRFunction *fn)
+{
+  ir_remove_trivial_phis(fn);
+  ir_renumber(fn);
+}
+
+static IRInstr *ir_param(IRBuilder &b, Symbol type, int index)
+{
+  IRInstr *p = b.Emit(IR_PARAM, type);
+  p->value = index;
+  b.fn->params.push_back(p);
+  return p;
+}
+
+static void ir_return(IRBuilder &b, IRInstr *value)
+{
+  IRInstr *ret = b.Emit(IR_RET, NULL);
+  ret->args.push_back(value);
+}
+
+// Inicialización de la clase: la del padre y después los atributos
+// propios que tienen expresión (los demás ya vienen en el prototipo)
+static IRFunction *ir_build_init(CgenNodeP nd)
+{
+  IRFunction *fn = new IRFunction(nd, NULL, SELF_TYPE);
+  IRBuilder b(fn);
+  b.self = ir_param(b, SELF_TYPE, 0);
+
+  if (nd->get_parentnd() != NULL) {
+    IRInstr *init = b.Emit(IR_INIT, NULL);
+    init->args.push_back(b.self);
+    init->cls = nd->get_parentnd()->get_name();
+  }
+
+  Features features = nd->GetFeatures();
+  for (int i = features->first(); features->more(i); i = features->next(i)) {
+    Feature f = features->nth(i);
+    if (f->IsMethod())
+      continue;
+    Expression init = ((attr_class *) f)->GetInit();
+    if (init->IsNoExpr())
+      continue;
+    IRInstr *value = init->ir(b);
+    IRInstr *set = b.Emit(IR_SETATTR, NULL);
+    set->args.push_back(b.self);
+    set->args.push_back(value);
+    set->sym = f->GetName();
+  }
+  ir_return(b, b.self);
+  ir_finish(fn);
+  return fn;
+}
+
+static IRFunction *ir_build_method(CgenNodeP nd, method_class *method)
+{
+  IRFunction *fn = new IRFunction(nd, method->GetName(), method->GetType());
+  IRBuilder b(fn);
+  b.self = ir_param(b, SELF_TYPE, 0);
+
+  Formals formals = method->GetFormals();
+  for (int i = formals->first(); formals->more(i); i = formals->next(i)) {
+    Formal formal = formals->nth(i);
+    b.PushVar(formal->GetName(), formal->GetType(),
+              ir_param(b, formal->GetType(), i + 1));
+  }
+  ir_return(b, method->GetExpr()->ir(b));
+  ir_finish(fn);
+  return fn;
+}
+
+IRProgram *ir_build(CgenClassTableP classtable)
+{
+  IRProgram *program = new IRProgram();
+  std::vector<CgenNodeP> &nds = classtable->nodes();
+  for (size_t i = 0; i < nds.size(); i++) {
+    CgenNodeP nd = nds[i];
+    program->functions.push_back(ir_build_init(nd));
+    if (nd->basic())
+      continue;     // los métodos de las clases básicas son del runtime
+    Features features = nd->GetFeatures();
+    for (int j = features->first(); features->more(j); j = features->next(j))
+      if (features->nth(j)->IsMethod())
+        program->functions.push_back(ir_build_method(nd, (method_class *) features->nth(j)));
+  }
+  return program;
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+//  Expresiones
+//
+//////////////////////////////////////////////////////////////////////
+
+IRInstr *assign_class::ir(IRBuilder &b) {
+  IRInstr *value = expr->ir(b);
+  IRVar *var = b.LookupVar(name);
+  if (var != NULL) {
+    var->value = value;
+    return value;
+  }
+  IRInstr *set = b.Emit(IR_SETATTR, NULL);
+  set->args.push_back(b.self);
+  set->args.push_back(value);
+  set->sym = name;
+  return value;
+}
+
+static IRInstr *ir_dispatch(IRBuilder &b, tree_node *e, Expression expr, Symbol static_type,
+                            Symbol name, Expressions actual, Symbol type)
+{
+  std::vector<IRInstr *> args;
+  for (int i = actual->first(); actual->more(i); i = actual->next(i))
+    args.push_back(actual->nth(i)->ir(b));
+  IRInstr *receiver = expr->ir(b);
+
+  IRInstr *check = b.Emit(IR_VOIDCHECK, NULL);
+  check->args.push_back(receiver);
+  check->value = IR_VOID_DISPATCH;
+  check->line = e->get_line_number();
+
+  IRInstr *call = b.Emit(static_type ? IR_STATIC_DISPATCH : IR_DISPATCH, type);
+  call->args.push_back(receiver);
+  call->args.insert(call->args.end(), args.begin(), args.end());
+  call->sym = name;
+  call->cls = static_type;
+  call->line = e->get_line_number();
+  return call;
+}
+
+IRInstr *static_dispatch_class::ir(IRBuilder &b) {
+  return ir_dispatch(b, this, expr, type_name, name, actual, type);
+}
+
+IRInstr *dispatch_class::ir(IRBuilder &b) {
+  return ir_dispatch(b, this, expr, NULL, name, actual, type);
+}
+
+IRInstr *cond_class::ir(IRBuilder &b) {
+  IRBlock *then_block = b.NewBlock();
+  IRBlock *else_block = b.NewBlock();
+  IRBlock *join = b.NewBlock();
+  b.CondBranch(pred->ir(b), then_block, else_block);
+
+  std::vector<IRVar> before = b.vars;
+  std::vector<std::vector<IRVar> > envs;
+  std::vector<IRInstr *> results;
+
+  b.SetBlock(then_block);
+  results.push_back(then_exp->ir(b));
+  envs.push_back(b.vars);
+  b.Branch(join);
+
+  b.vars = before;
+  b.SetBlock(else_block);
+  results.push_back(else_exp->ir(b));
+  envs.push_back(b.vars);
+  b.Branch(join);
+
+  return b.Merge(join, envs, results, type);
+}
+
+IRInstr *loop_class::ir(IRBuilder &b) {
+  IRBlock *header = b.NewBlock();
+  IRBlock *body_block = b.NewBlock();
+  IRBlock *exit = b.NewBlock();
+  b.Branch(header);
+
+  b.SetBlock(header);
+  std::vector<IRInstr *> phis;
+  for (size_t i = 0; i < b.vars.size(); i++) {
+    IRInstr *phi = b.Emit(IR_PHI, b.vars[i].type);
+    phi->args.push_back(b.vars[i].value);
+    phi->blocks.push_back(header->preds[0]);
+    b.vars[i].value = phi;
+    phis.push_back(phi);
+  }
+  b.CondBranch(pred->ir(b), body_block, exit);
+  std::vector<IRVar> after_pred = b.vars;
+
+  b.SetBlock(body_block);
+  body->ir(b);
+  b.Branch(header);
+  for (size_t i = 0; i < phis.size(); i++) {
+    phis[i]->args.push_back(b.vars[i].value);
+    phis[i]->blocks.push_back(header->preds[1]);
+  }
+
+  b.vars = after_pred;
+  b.SetBlock(exit);
+  return b.Emit(IR_VOID, Object);
+}
+
+IRInstr *typcase_class::ir(IRBuilder &b) {
+  IRInstr *value = expr->ir(b);
+  IRInstr *check = b.Emit(IR_VOIDCHECK, NULL);
+  check->args.push_back(value);
+  check->value = IR_VOID_CASE;
+  check->line = get_line_number();
+
+  IRInstr *dispatch = b.Emit(IR_CASE, NULL);
+  dispatch->args.push_back(value);
+  dispatch->line = get_line_number();
+  for (int i = cases->first(); cases->more(i); i = cases->next(i)) {
+    IRBlock *target = b.NewBlock();
+    dispatch->types.push_back(((branch_class *) cases->nth(i))->GetTypeDecl());
+    dispatch->blocks.push_back(target);
+    target->preds.push_back(b.cur);
+  }
+  IRBlock *join = b.NewBlock();
+
+  std::vector<IRVar> before = b.vars;
+  std::vector<std::vector<IRVar> > envs;
+  std::vector<IRInstr *> results;
+  for (int i = cases->first(); cases->more(i); i = cases->next(i)) {
+    branch_class *branch = (branch_class *) cases->nth(i);
+    b.vars = before;
+    b.SetBlock(dispatch->blocks[i]);
+    IRInstr *cast = b.Emit(IR_CAST, branch->GetTypeDecl());
+    cast->args.push_back(value);
+    b.PushVar(branch->GetName(), branch->GetTypeDecl(), cast);
+    results.push_back(branch->GetExpr()->ir(b));
+    b.PopVar();
+    envs.push_back(b.vars);
+    b.Branch(join);
+  }
+  b.vars = before;
+  return b.Merge(join, envs, results, type);
+}
+
+IRInstr *block_class::ir(IRBuilder &b) {
+  IRInstr *value = NULL;
+  for (int i = body->first(); body->more(i); i = body->next(i))
+    value = body->nth(i)->ir(b);
+  return value;
+}
+
+// Valor inicial de una variable sin inicialización
+static IRInstr *ir_default_value(IRBuilder &b, Symbol type)
+{
+  IRInstr *value;
+  if (type == Int) {
+    value = b.Emit(IR_INT, Int);
+    value->sym = inttable.add_string((char *) "0");
+  } else if (type == Str) {
+    value = b.Emit(IR_STRING, Str);
+    value->sym = stringtable.add_string((char *) "");
+  } else if (type == Bool) {
+    value = b.Emit(IR_BOOL, Bool);
+  } else {
+    value = b.Emit(IR_VOID, type);
+  }
+  return value;
+}
+
+IRInstr *let_class::ir(IRBuilder &b) {
+  IRInstr *value = init->IsNoExpr() ? ir_default_value(b, type_decl) : init->ir(b);
+  b.PushVar(identifier, type_decl, value);
+  IRInstr *result = body->ir(b);
+  b.PopVar();
+  return result;
+}
+
+static IRInstr *ir_binary(IRBuilder &b, IROpcode op, Expression e1, Expression e2, Symbol type)
+{
+  IRInstr *left = e1->ir(b);
+  IRInstr *right = e2->ir(b);
+  IRInstr *i = b.Emit(op, type);
+  i->args.push_back(left);
+  i->args.push_back(right);
+  return i;
+}
+
+static IRInstr *ir_unary(IRBuilder &b, IROpcode op, Expression e1, Symbol type)
+{
+  IRInstr *arg = e1->ir(b);
+  IRInstr *i = b.Emit(op, type);
+  i->args.push_back(arg);
+  return i;
+}
+
+IRInstr *plus_class::ir(IRBuilder &b) {
+  return ir_binary(b, IR_ADD, e1, e2, Int);
+}
+
+IRInstr *sub_class::ir(IRBuilder &b) {
+  return ir_binary(b, IR_SUB, e1, e2, Int);
+}
+
+IRInstr *mul_class::ir(IRBuilder &b) {
+  return ir_binary(b, IR_MUL, e1, e2, Int);
+}
+
+IRInstr *divide_class::ir(IRBuilder &b) {
+  return ir_binary(b, IR_DIV, e1, e2, Int);
+}
+
+IRInstr *neg_class::ir(IRBuilder &b) {
+  return ir_unary(b, IR_NEG, e1, Int);
+}
+
+IRInstr *lt_class::ir(IRBuilder &b) {
+  return ir_binary(b, IR_LT, e1, e2, Bool);
+}
+
+IRInstr *eq_class::ir(IRBuilder &b) {
+  return ir_binary(b, IR_EQ, e1, e2, Bool);
+}
+
+IRInstr *leq_class::ir(IRBuilder &b) {
+  return ir_binary(b, IR_LE, e1, e2, Bool);
+}
+
+IRInstr *comp_class::ir(IRBuilder &b) {
+  return ir_unary(b, IR_NOT, e1, Bool);
+}
+
+IRInstr *int_const_class::ir(IRBuilder &b) {
+  IRInstr *i = b.Emit(IR_INT, Int);
+  i->sym = token;
+  return i;
+}
+
+IRInstr *string_const_class::ir(IRBuilder &b) {
+  IRInstr *i = b.Emit(IR_STRING, Str);
+  i->sym = token;
+  return i;
+}
+
+IRInstr *bool_const_class::ir(IRBuilder &b) {
+  IRInstr *i = b.Emit(IR_BOOL, Bool);
+  i->value = val;
+  return i;
+}
+
+IRInstr *new__class::ir(IRBuilder &b) {
+  return b.Emit(IR_NEW, type_name);
+}
+
+IRInstr *isvoid_class::ir(IRBuilder &b) {
+  return ir_unary(b, IR_ISVOID, e1, Bool);
+}
+
+IRInstr *no_expr_class::ir(IRBuilder &b) {
+  return b.Emit(IR_VOID, Object);
+}
+
+IRInstr *object_class::ir(IRBuilder &b) {
+  if (name == self)
+    return b.self;
+  IRVar *var = b.LookupVar(name);
+  if (var != NULL)
+    return var->value;
+  IRInstr *get = b.Emit(IR_GETATTR, type);
+  get->args.push_back(b.self);
+  get->sym = name;
+  return get;
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+//  Verificación
+//
+//  Revisa la forma de los bloques, que las phi correspondan a los
+//  predecesores, que cada registro se defina antes de usarse en todo
+//  camino (que su definición domine el uso) y los tipos de cada
+//  instrucción contra la jerarquía de clases.
+//
+//////////////////////////////////////////////////////////////////////
+
+class IRVerifier {
+  CgenClassTableP classtable;
+  IRFunction *fn;
+  ostream &err;
+  int errors;
+  std::map<IRBlock *, int> rpo;             // posición en orden inverso de postorden
+  std::map<IRBlock *, IRBlock *> idom;
+  std::map<IRInstr *, int> position;        // índice de cada instrucción en su bloque
+
+  ostream &Error(IRBlock *b);
+  CgenNodeP ClassOf(Symbol type);
+  bool Conforms(Symbol a, Symbol b);
+  bool Dominates(IRBlock *a, IRBlock *b);
+  void ComputeDominators();
+  void CheckBlock(IRBlock *b);
+  void CheckOperands(IRInstr *i);
+  void CheckTypes(IRInstr *i);
+  void CheckDispatch(IRInstr *i);
+public:
+  IRVerifier(CgenClassTableP ct, ostream &e) : classtable(ct), fn(NULL), err(e), errors(0) {}
+  int Verify(IRFunction *f);
+};
+
+static void ir_dump_name(IRFunction *fn, ostream &os)
+{
+  if (fn->name == NULL)
+    os << fn->cls->get_name() << CLASSINIT_SUFFIX;
+  else
+    os << fn->cls->get_name() << METHOD_SEP << fn->name;
+}
+
+ostream &IRVerifier::Error(IRBlock *b)
+{
+  errors++;
+  ir_dump_name(fn, err);
+  if (b != NULL)
+    err << " bb" << b->id;
+  return err << ": ";
+}
+
+CgenNodeP IRVerifier::ClassOf(Symbol type)
+{
+  if (type == SELF_TYPE)
+    return fn->cls;
+  return type == NULL ? NULL : classtable->probe(type);
+}
+
+bool IRVerifier::Conforms(Symbol a, Symbol b)
+{
+  if (a == b)
+    return true;
+  if (b == SELF_TYPE)
+    return false;
+  for (CgenNodeP c = ClassOf(a); c != NULL; c = c->get_parentnd())
+    if (c->get_name() == b)
+      return true;
+  return false;
+}
+
+bool IRVerifier::Dominates(IRBlock *a, IRBlock *b)
+{
+  while (b != a && idom[b] != b)
+    b = idom[b];
+  return a == b;
+}
+
+// Cooper, Harvey y Kennedy: se refina idom en orden inverso de postorden
+// hasta que no cambia
+void IRVerifier::ComputeDominators()
+{
+  std::set<IRBlock *> seen;
+  std::vector<IRBlock *> order;
+  ir_postorder(fn->blocks[0], seen, order);
+  rpo.clear();
+  idom.clear();
+  for (size_t i = 0; i < order.size(); i++)
+    rpo[order[order.size() - 1 - i]] = i;
+
+  IRBlock *entry = fn->blocks[0];
+  idom[entry] = entry;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (int i = order.size() - 2; i >= 0; i--) {
+      IRBlock *b = order[i];
+      IRBlock *new_idom = NULL;
+      for (size_t k = 0; k < b->preds.size(); k++) {
+        IRBlock *p = b->preds[k];
+        if (!idom.count(p))
+          continue;
+        if (new_idom == NULL) {
+          new_idom = p;
+          continue;
+        }
+        IRBlock *x = p, *y = new_idom;
+        while (x != y) {
+          while (rpo[x] > rpo[y]) x = idom[x];
+          while (rpo[y] > rpo[x]) y = idom[y];
+        }
+        new_idom = x;
+      }
+      if (new_idom != NULL && idom[b] != new_idom) {
+        idom[b] = new_idom;
+        changed = true;
+      }
+    }
+  }
+}
+
+void IRVerifier::CheckBlock(IRBlock *b)
+{
+  if (b->Terminator() == NULL) {
+    Error(b) << "does not end in a terminator" << endl;
+    return;
+  }
+  bool phis = true;
+  for (size_t i = 0; i < b->instrs.size(); i++) {
+    IRInstr *in = b->instrs[i];
+    if (in->block != b)
+      Error(b) << "instruction " << i << " belongs to another block" << endl;
+    if (in->IsTerminator() && i + 1 != b->instrs.size())
+      Error(b) << "terminator in the middle of the block" << endl;
+    if (in->op == IR_PHI) {
+      if (!phis)
+        Error(b) << "phi %" << in->id << " after other instructions" << endl;
+      if (in->blocks != b->preds)
+        Error(b) << "phi %" << in->id << " does not match the predecessors" << endl;
+      if (in->args.size() != in->blocks.size())
+        Error(b) << "phi %" << in->id << " has " << in->args.size() << " values for "
+                 << in->blocks.size() << " blocks" << endl;
+    } else {
+      phis = false;
+    }
+    if (in->op == IR_PARAM && b != fn->blocks[0])
+      Error(b) << "parameter %" << in->id << " outside the entry block" << endl;
+  }
+}
+
+// Cada operando es un registro de esta función y su definición domina el
+// uso (para una phi, el final del bloque del que viene el valor)
+void IRVerifier::CheckOperands(IRInstr *in)
+{
+  for (size_t k = 0; k < in->args.size(); k++) {
+    IRInstr *arg = in->args[k];
+    if (arg == NULL || !position.count(arg) || arg->id < 0) {
+      Error(in->block) << "operand " << k << " of an instruction is not a register of the function" << endl;
+      continue;
+    }
+    IRBlock *use = in->block;
+    if (in->op == IR_PHI) {
+      if (k >= in->blocks.size())
+        continue;
+      use = in->blocks[k];
+      if (!rpo.count(use))
+        continue;
+      if (!Dominates(arg->block, use))
+        Error(in->block) << "%" << arg->id << " does not reach phi %" << in->id
+                         << " from bb" << use->id << endl;
+      continue;
+    }
+    bool ok = arg->block == use ? position[arg] < position[in]
+                                : Dominates(arg->block, use);
+    if (!ok)
+      Error(use) << "%" << arg->id << " used before it is defined" << endl;
+  }
+}
+
+void IRVerifier::CheckDispatch(IRInstr *in)
+{
+  Symbol receiver = in->args[0]->type;
+  Symbol cls = receiver;
+  if (in->op == IR_STATIC_DISPATCH) {
+    if (!Conforms(receiver, in->cls))
+      Error(in->block) << receiver << " does not conform to " << in->cls << endl;
+    cls = in->cls;
+  }
+  CgenNodeP nd = ClassOf(cls);
+  method_class *method = nd == NULL ? NULL : nd->find_method(in->sym);
+  if (method == NULL) {
+    Error(in->block) << "class " << cls << " has no method " << in->sym << endl;
+    return;
+  }
+  Formals formals = method->GetFormals();
+  if ((int) in->args.size() - 1 != formals->len()) {
+    Error(in->block) << "method " << in->sym << " takes " << formals->len()
+                     << " arguments, got " << in->args.size() - 1 << endl;
+    return;
+  }
+  for (int k = formals->first(); formals->more(k); k = formals->next(k))
+    if (!Conforms(in->args[k + 1]->type, formals->nth(k)->GetType()))
+      Error(in->block) << "argument " << k + 1 << " of " << in->sym << " is "
+                       << in->args[k + 1]->type << ", not " << formals->nth(k)->GetType() << endl;
+  // Un registro puede tener un tipo más preciso que la variable de la que
+  // salió, así que el resultado sólo tiene que cubrir lo que devuelve el
+  // método
+  Symbol ret = method->GetType() == SELF_TYPE ? receiver : method->GetType();
+  if (!Conforms(ret, in->type))
+    Error(in->block) << "%" << in->id << " is " << in->type << " but "
+                     << in->sym << " returns " << ret << endl;
+}
+
+void IRVerifier::CheckTypes(IRInstr *in)
+{
+  if (in->id >= 0 && in->type != SELF_TYPE && ClassOf(in->type) == NULL) {
+    Error(in->block) << "%" << in->id << " has unknown type " << in->type << endl;
+    return;
+  }
+  switch (in->op) {
+  case IR_ADD: case IR_SUB: case IR_MUL: case IR_DIV: case IR_NEG:
+  case IR_LT: case IR_LE:
+    for (size_t k = 0; k < in->args.size(); k++)
+      if (in->args[k]->type != Int)
+        Error(in->block) << "operand %" << in->args[k]->id << " is not Int" << endl;
+    if (in->type != (in->op == IR_LT || in->op == IR_LE ? Bool : Int))
+      Error(in->block) << "%" << in->id << " has the wrong type" << endl;
+    break;
+  case IR_NOT: case IR_CONDBR:
+    if (in->args[0]->type != Bool)
+      Error(in->block) << "operand %" << in->args[0]->id << " is not Bool" << endl;
+    break;
+  case IR_EQ: case IR_ISVOID:
+    if (in->type != Bool)
+      Error(in->block) << "%" << in->id << " is not Bool" << endl;
+    break;
+  case IR_INT: case IR_STRING:
+    if (in->sym == NULL)
+      Error(in->block) << "constant %" << in->id << " has no value" << endl;
+    break;
+  case IR_GETATTR: case IR_SETATTR: {
+    CgenNodeP nd = ClassOf(in->args[0]->type);
+    if (nd == NULL || !nd->attr_index.count(in->sym)) {
+      Error(in->block) << in->args[0]->type << " has no attribute " << in->sym << endl;
+      break;
+    }
+    Symbol decl = nd->attributes[nd->attr_index[in->sym]]->GetTypeDecl();
+    if (in->op == IR_GETATTR && in->type != decl)
+      Error(in->block) << "%" << in->id << " is " << in->type << " but "
+                       << in->sym << " is " << decl << endl;
+    if (in->op == IR_SETATTR && !Conforms(in->args[1]->type, decl))
+      Error(in->block) << "assigning " << in->args[1]->type << " to "
+                       << in->sym << " : " << decl << endl;
+    break;
+  }
+  case IR_INIT:
+    if (ClassOf(in->cls) == NULL || !Conforms(in->args[0]->type, in->cls))
+      Error(in->block) << "bad init of class " << in->cls << endl;
+    break;
+  case IR_DISPATCH: case IR_STATIC_DISPATCH:
+    CheckDispatch(in);
+    break;
+  case IR_PHI:
+    for (size_t k = 0; k < in->args.size(); k++)
+      if (!Conforms(in->args[k]->type, in->type))
+        Error(in->block) << "phi %" << in->id << " : " << in->type << " gets "
+                         << in->args[k]->type << endl;
+    break;
+  case IR_CASE: {
+    std::set<Symbol> seen;
+    if (in->types.size() != in->blocks.size())
+      Error(in->block) << "case has " << in->types.size() << " types for "
+                       << in->blocks.size() << " blocks" << endl;
+    for (size_t k = 0; k < in->types.size(); k++) {
+      if (ClassOf(in->types[k]) == NULL || in->types[k] == SELF_TYPE)
+        Error(in->block) << "case on unknown type " << in->types[k] << endl;
+      if (!seen.insert(in->types[k]).second)
+        Error(in->block) << "case has two branches for " << in->types[k] << endl;
+    }
+    break;
+  }
+  case IR_RET:
+    if (!Conforms(in->args[0]->type, fn->ret_type))
+      Error(in->block) << "returns " << in->args[0]->type << ", not " << fn->ret_type << endl;
+    break;
+  default:
+    break;
+  }
+}
+
+int IRVerifier::Verify(IRFunction *f)
+{
+  fn = f;
+  position.clear();
+  int before = errors;
+  if (fn->blocks.empty()) {
+    Error(NULL) << "no blocks" << endl;
+    return errors - before;
+  }
+
+  // Los predecesores tienen que ser los que dicen los terminadores
+  std::map<IRBlock *, std::multiset<IRBlock *> > preds;
+  std::set<IRBlock *> blocks(fn->blocks.begin(), fn->blocks.end());
+  for (size_t i = 0; i < fn->blocks.size(); i++) {
+    IRBlock *b = fn->blocks[i];
+    CheckBlock(b);
+    IRInstr *term = b->Terminator();
+    for (size_t k = 0; term != NULL && k < term->blocks.size(); k++) {
+      if (!blocks.count(term->blocks[k]))
+        Error(b) << "jumps to a block of another function" << endl;
+      preds[term->blocks[k]].insert(b);
+    }
+    for (size_t j = 0; j < b->instrs.size(); j++)
+      position[b->instrs[j]] = j;
+  }
+  for (size_t i = 0; i < fn->blocks.size(); i++) {
+    IRBlock *b = fn->blocks[i];
+    if (preds[b] != std::multiset<IRBlock *>(b->preds.begin(), b->preds.end()))
+      Error(b) << "predecessor list does not match the terminators" << endl;
+  }
+  if (errors != before)
+    return errors - before;
+
+  ComputeDominators();
+  for (size_t i = 0; i < fn->blocks.size(); i++) {
+    IRBlock *b = fn->blocks[i];
+    if (!rpo.count(b)) {
+      Error(b) << "unreachable" << endl;
+      continue;
+    }
+    for (size_t j = 0; j < b->instrs.size(); j++)
+      CheckOperands(b->instrs[j]);
+  }
+  if (errors != before)
+    return errors - before;
+
+  for (size_t i = 0; i < fn->blocks.size(); i++)
+    for (size_t j = 0; j < fn->blocks[i]->instrs.size(); j++)
+      CheckTypes(fn->blocks[i]->instrs[j]);
+  return errors - before;
+}
+
+int ir_verify(CgenClassTableP classtable, IRProgram *program, ostream &err)
+{
+  IRVerifier verifier(classtable, err);
+  int errors = 0;
+  for (size_t i = 0; i < program->functions.size(); i++)
+    errors += verifier.Verify(program->functions[i]);
+  return errors;
+}
+
+//////////////////////////////////////////////////////////////////////
+//
+//  Impresión
+//
+//      method Main.main(%0 : SELF_TYPE) : Object {
+//      bb0:
+//        %1 : Int = int 5
+//        voidcheck.dispatch %0, line 4
+//        %2 : SELF_TYPE = dispatch %0.out_int(%1)
+//        ret %2
+//      }
+//
+//////////////////////////////////////////////////////////////////////
+
+static const char *ir_opcode_name(IROpcode op)
+{
+  switch (op) {
+  case IR_PARAM:           return "param";
+  case IR_INT:             return "int";
+  case IR_STRING:          return "string";
+  case IR_BOOL:            return "bool";
+  case IR_VOID:            return "void";
+  case IR_GETATTR:         return "getattr";
+  case IR_SETATTR:         return "setattr";
+  case IR_ADD:             return "add";
+  case IR_SUB:             return "sub";
+  case IR_MUL:             return "mul";
+  case IR_DIV:             return "div";
+  case IR_NEG:             return "neg";
+  case IR_LT:              return "lt";
+  case IR_LE:              return "le";
+  case IR_EQ:              return "eq";
+  case IR_NOT:             return "not";
+  case IR_ISVOID:          return "isvoid";
+  case IR_NEW:             return "new";
+  case IR_INIT:            return "init";
+  case IR_VOIDCHECK:       return "voidcheck";
+  case IR_DISPATCH:        return "dispatch";
+  case IR_STATIC_DISPATCH: return "call";
+  case IR_CAST:            return "cast";
+  case IR_PHI:             return "phi";
+  case IR_BR:              return "br";
+  case IR_CONDBR:          return "condbr";
+  case IR_CASE:            return "case";
+  case IR_RET:             return "ret";
+  }
+  return "?";
+}
+
+static void ir_dump_args(IRInstr *in, size_t from, ostream &os)
+{
+  for (size_t k = from; k < in->args.size(); k++)
+    os << (k > from ? ", " : "") << "%" << in->args[k]->id;
+}
+
+static void ir_dump_instr(IRInstr *in, ostream &os)
+{
+  os << "  ";
+  if (in->id >= 0)
+    os << "%" << in->id << " : " << in->type << " = ";
+  os << ir_opcode_name(in->op);
+
+  switch (in->op) {
+  case IR_PARAM:
+    os << " " << in->value;
+    break;
+  case IR_INT:
+    os << " " << in->sym;
+    break;
+  case IR_STRING:
+    os << " \"";
+    print_escaped_string(os, in->sym->get_string());
+    os << "\"";
+    break;
+  case IR_BOOL:
+    os << (in->value ? " true" : " false");
+    break;
+  case IR_GETATTR:
+    os << " %" << in->args[0]->id << "." << in->sym;
+    break;
+  case IR_SETATTR:
+    os << " %" << in->args[0]->id << "." << in->sym << ", %" << in->args[1]->id;
+    break;
+  case IR_NEW:
+    os << " " << in->type;
+    break;
+  case IR_INIT:
+    os << " " << in->cls << " %" << in->args[0]->id;
+    break;
+  case IR_VOIDCHECK:
+    os << (in->value == IR_VOID_CASE ? ".case" : ".dispatch")
+       << " %" << in->args[0]->id << ", line " << in->line;
+    break;
+  case IR_DISPATCH:
+    os << " %" << in->args[0]->id << "." << in->sym << "(";
+    ir_dump_args(in, 1, os);
+    os << ")";
+    break;
+  case IR_STATIC_DISPATCH:
+    os << " " << in->cls << "." << in->sym << "(";
+    ir_dump_args(in, 0, os);
+    os << ")";
+    break;
+  case IR_PHI:
+    for (size_t k = 0; k < in->args.size(); k++)
+      os << (k > 0 ? ", [" : " [") << "%" << in->args[k]->id << ", bb" << in->blocks[k]->id << "]";
+    break;
+  case IR_BR:
+    os << " bb" << in->blocks[0]->id;
+    break;
+  case IR_CONDBR:
+    os << " %" << in->args[0]->id << ", bb" << in->blocks[0]->id << ", bb" << in->blocks[1]->id;
+    break;
+  case IR_CASE:
+    os << " %" << in->args[0]->id << " [";
+    for (size_t k = 0; k < in->types.size(); k++)
+      os << (k > 0 ? ", " : "") << in->types[k] << ": bb" << in->blocks[k]->id;
+    os << "]";
+    break;
+  default:
+    if (!in->args.empty())
+      os << " ";
+    ir_dump_args(in, 0, os);
+    break;
+  }
+  os << endl;
+}
+
+void ir_dump(IRProgram *program, ostream &os)
+{
+  for (size_t i = 0; i < program->functions.size(); i++) {
+    IRFunction *fn = program->functions[i];
+    os << (fn->name == NULL ? "init " : "method ");
+    ir_dump_name(fn, os);
+    os << "(";
+    for (size_t k = 0; k < fn->params.size(); k++)
+      os << (k > 0 ? ", " : "") << "%" << fn->params[k]->id << " : " << fn->params[k]->type;
+    os << ") : " << fn->ret_type << " {" << endl;
+    for (size_t j = 0; j < fn->blocks.size(); j++) {
+      IRBlock *b = fn->blocks[j];
+      os << "bb" << b->id << ":";
+      if (!b->preds.empty()) {
+        os << "\t\t\t; preds";
+        for (size_t k = 0; k < b->preds.size(); k++)
+          os << " bb" << b->preds[k]->id;
+      }
+      os << endl;
+      for (size_t k = 0; k < b->instrs.size(); k++)
+        ir_dump_instr(b->instrs[k], os);
+    }
+    os << "}" << endl << endl;
+  }
+}
+
+// COOL_IR_OUT: construye, verifica y escribe la IR del programa
+void ir_write(CgenClassTableP classtable, const char *path)
+{
+  IRProgram *program = ir_build(classtable);
+  int errors = ir_verify(classtable, program, cerr);
+  if (errors > 0) {
+    cerr << errors << " errors in the IR" << endl;
+    exit(1);
+  }
+  std::ofstream out(path);
+  if (!out) {
+    cerr << "Could not open " << path << endl;
+    exit(1);
+  }
+  ir_dump(program, out);
+}
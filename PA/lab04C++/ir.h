@@ -0,0 +1,151 @@
+/*  Gabriel Santiago Delgado Lozano, Fabio Esteban Murcia Martínez
+ *  Representación intermedia de tres direcciones, tipada y en forma SSA,
+ *  entre el AST anotado por semant y los generadores de código.
+ *
+ *  Cada método (y cada inicialización de clase) es una IRFunction: una
+ *  lista de bloques básicos que terminan en un salto, un case o un ret.
+ *  Cada instrucción que produce un valor define un registro virtual
+ *  (%n) con el tipo estático que le dio semant; los registros se definen
+ *  una sola vez y los valores que se juntan al final de un if, un case o
+ *  en la cabeza de un loop pasan por phi.  Sólo las variables locales
+ *  (argumentos, let y ramas de case) están en SSA: los atributos se leen
+ *  y escriben en el objeto con getattr y setattr.
+ *
+ *  El dispatch, la creación de objetos, el case y la revisión de void son
+ *  instrucciones explícitas, de modo que un backend o una optimización
+ *  no tienen que reconstruirlos a partir del árbol.
+ *
+ *  Con COOL_IR_OUT=<archivo> el generador construye la IR de todo el
+ *  programa, la verifica y la escribe en ese archivo en forma de texto
+ *  antes de generar el código.
+ */
+#ifndef IR_H
+#define IR_H
+
+#include <vector>
+#include "cool-tree.h"
+
+#define IR_OUT_ENV "COOL_IR_OUT"
+
+class CgenClassTable;
+class CgenNode;
+
+enum IROpcode {
+   // valores
+   IR_PARAM,            // self o un argumento
+   IR_INT,              // constante (sym es la entrada de inttable)
+   IR_STRING,           // constante (sym es la entrada de stringtable)
+   IR_BOOL,             // constante (value)
+   IR_VOID,             // void del tipo dado
+   IR_GETATTR,          // args[0].sym
+   IR_SETATTR,          // args[0].sym <- args[1]; no define registro
+   IR_ADD, IR_SUB, IR_MUL, IR_DIV, IR_NEG,
+   IR_LT, IR_LE, IR_EQ, IR_NOT, IR_ISVOID,
+   IR_NEW,              // objeto nuevo de tipo type (puede ser SELF_TYPE)
+   IR_INIT,             // inicialización de la clase cls sobre args[0]
+   IR_VOIDCHECK,        // aborta si args[0] es void; value: IR_VOID_DISPATCH o IR_VOID_CASE
+   IR_DISPATCH,         // args[0].sym(args[1..]) por la tabla de dispatch
+   IR_STATIC_DISPATCH,  // cls.sym(args[0], args[1..])
+   IR_CAST,             // args[0] visto como type, en una rama de case
+   IR_PHI,              // args[i] si se llega desde blocks[i]
+
+   // terminadores
+   IR_BR,               // blocks[0]
+   IR_CONDBR,           // args[0] ? blocks[0] : blocks[1]
+   IR_CASE,             // a blocks[i] si args[0] hereda de types[i] (el más cercano)
+   IR_RET               // args[0]
+};
+
+enum { IR_VOID_DISPATCH, IR_VOID_CASE };
+
+class IRBlock;
+
+class IRInstr {
+public:
+   IROpcode op;
+   int id;                       // registro que define, -1 si no define nada
+   Symbol type;                  // tipo del registro
+   std::vector<IRInstr *> args;
+   std::vector<IRBlock *> blocks;
+   std::vector<Symbol> types;    // tipos de las ramas de un case
+   Symbol sym;                   // atributo, método o constante
+   Symbol cls;                   // clase de un dispatch estático o de init
+   int value;                    // bool, índice del parámetro o tipo de voidcheck
+   int line;
+   IRBlock *block;               // bloque que la contiene
+
+   IRInstr(IROpcode o) : op(o), id(-1), type(NULL), sym(NULL), cls(NULL),
+                         value(0), line(0), block(NULL) {}
+   bool IsTerminator() { return op >= IR_BR; }
+};
+
+class IRBlock {
+public:
+   int id;
+   std::vector<IRInstr *> instrs;
+   std::vector<IRBlock *> preds;   // en el orden de los operandos de las phi
+
+   IRBlock(int i) : id(i) {}
+   IRInstr *Terminator() {
+      return instrs.empty() || !instrs.back()->IsTerminator() ? NULL : instrs.back();
+   }
+};
+
+class IRFunction {
+public:
+   CgenNode *cls;
+   Symbol name;                    // NULL en la inicialización de la clase
+   Symbol ret_type;
+   std::vector<IRInstr *> params;  // self y los argumentos, en el bloque de entrada
+   std::vector<IRBlock *> blocks;  // el primero es la entrada
+   int num_regs;
+
+   IRFunction(CgenNode *c, Symbol n, Symbol t) : cls(c), name(n), ret_type(t), num_regs(0) {}
+};
+
+class IRProgram {
+public:
+   std::vector<IRFunction *> functions;
+};
+
+// Una variable local en SSA: su tipo declarado y el registro que tiene
+// su valor en el punto actual de la construcción
+struct IRVar {
+   Symbol name;
+   Symbol type;
+   IRInstr *value;
+};
+
+// Construcción de una función; las expresiones se bajan con
+// Expression_class::ir, que deja las instrucciones en el bloque actual y
+// devuelve el registro con el valor.
+class IRBuilder {
+public:
+   IRFunction *fn;
+   IRBlock *cur;
+   IRInstr *self;
+   std::vector<IRVar> vars;
+
+   IRBuilder(IRFunction *f);
+   IRBlock *NewBlock();
+   void SetBlock(IRBlock *b) { cur = b; }
+   IRInstr *Emit(IROpcode op, Symbol type);
+   void Branch(IRBlock *target);
+   void CondBranch(IRInstr *cond, IRBlock *t, IRBlock *f);
+
+   IRVar *LookupVar(Symbol name);
+   void PushVar(Symbol name, Symbol type, IRInstr *value);
+   void PopVar() { vars.pop_back(); }
+
+   // Junta en join los valores de las variables (y el del resultado, si
+   // hay) que llegan de cada predecesor, con phi donde hagan falta
+   IRInstr *Merge(IRBlock *join, const std::vector<std::vector<IRVar> > &envs,
+                  const std::vector<IRInstr *> &results, Symbol type);
+};
+
+IRProgram *ir_build(CgenClassTable *classtable);
+int ir_verify(CgenClassTable *classtable, IRProgram *program, ostream &err);
+void ir_dump(IRProgram *program, ostream &os);
+void ir_write(CgenClassTable *classtable, const char *path);
+
+#endif